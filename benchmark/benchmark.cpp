@@ -0,0 +1,938 @@
+/**
+ * @brief Benchmarks of the packed memory array, the graph implementations, the priority queues
+ * and the shortest path algorithms, on inputs generated from a fixed seed.
+ * Usage: ./benchmark.out [--output results.json] [--scale 16] [--samples 50] [--filter pma] [--label commit]
+ *
+ * Every benchmark is run samples + 1 times and the first run is dropped as a warm-up. The
+ * results are written as JSON with the median and the 99th percentile of the samples, in
+ * microseconds, so that they can be compared across commits. The checksum of a benchmark
+ * depends only on the inputs, so equal checksums mean that two results measured the same work.
+ *
+ * @author Panos Michail
+ *
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <boost/program_options.hpp>
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Structs/Graphs/forwardStarImpl.h>
+#include <Structs/Graphs/adjacencyListImpl.h>
+#include <Structs/Graphs/packedMemoryGraphImpl.h>
+#include <Structs/Arrays/packedMemoryArray.h>
+#include <Structs/Trees/priorityQueue.h>
+#include <Algorithms/basicGraphAlgorithms.h>
+#include <Algorithms/ShortestPath/dijkstra.h>
+#include <Algorithms/ShortestPath/bidirectionalDijkstra.h>
+#include <Algorithms/ShortestPath/aStarDijkstra.h>
+#include <Algorithms/ShortestPath/dagShortestPath.h>
+#include <Algorithms/ShortestPath/Multicriteria/multicriteriaDijkstra.h>
+#include <Algorithms/ShortestPath/Multicriteria/namoaStar.h>
+#include <Algorithms/ShortestPath/Multicriteria/parallelParetoSearch.h>
+#include <Utilities/graphGenerators.h>
+#include <Utilities/changeLog.h>
+#include <Utilities/parallel.h>
+#include <Utilities/timer.h>
+
+
+/* the node and edge data for the traversal and update benchmarks, kept small as in most applications */
+struct TraversalNode: DefaultGraphItem
+{
+    TraversalNode():marked(false)
+    {
+    }
+    bool marked;
+};
+
+struct TraversalEdge: DefaultGraphItem
+{
+    TraversalEdge():weight(0)
+    {
+    }
+    unsigned int weight;
+};
+
+/* the node and edge data with the fields of every shortest path algorithm */
+struct RoutingNode: DefaultGraphItem
+{
+    RoutingNode():marked(false),dist(0),distBack(0),timestamp(0),pqitem(0),pqitemBack(0),pred(0),succ(0),id(0),x(0),y(0),heuristicList(2)
+    {
+    }
+    bool marked;
+    unsigned int dist, distBack, timestamp, pqitem, pqitemBack;
+    void* pred;
+    void* succ;
+    unsigned int id;
+    int x, y;
+    std::vector<Label> labels;
+    CriteriaList heuristicList;
+};
+
+struct RoutingEdge: DefaultGraphItem
+{
+    RoutingEdge():weight(0),criteriaList(2)
+    {
+    }
+    unsigned int weight;
+    CriteriaList criteriaList;
+};
+
+typedef DynamicGraph< ForwardStarImpl, TraversalNode, TraversalEdge>          ForwardStarGraph;
+typedef DynamicGraph< AdjacencyListImpl, TraversalNode, TraversalEdge>        AdjacencyListGraph;
+typedef DynamicGraph< PackedMemoryGraphImpl, TraversalNode, TraversalEdge>    PackedMemoryGraph;
+typedef DynamicGraph< PackedMemoryGraphImpl, RoutingNode, RoutingEdge>        RoutingGraph;
+
+
+/* the sizes of the inputs are derived from the scale, the base 2 logarithm of the number of nodes */
+struct Settings
+{
+    unsigned int scale;
+    unsigned int numSamples;
+    unsigned int batchSize;
+    uint64_t seed;
+};
+
+
+/**
+ * @brief Collects the samples of every benchmark and writes their statistics
+ */
+class BenchmarkSuite
+{
+public:
+    BenchmarkSuite( const std::string& filter):m_filter(filter)
+    {
+    }
+
+    /**
+     * @brief Checks whether a benchmark, or a group of benchmarks given by a prefix of their names, should run
+     */
+    bool isSelected( const std::string& name) const
+    {
+        size_t length = std::min( name.size(), m_filter.size());
+        return name.compare( 0, length, m_filter, 0, length) == 0;
+    }
+
+    /**
+     * @brief Records the samples of a benchmark
+     *
+     * @param name The name of the benchmark, the same across commits
+     * @param input A description of the input
+     * @param operations The number of operations measured by every sample
+     * @param samples The times of the runs in microseconds, the first one being the warm-up
+     * @param checksum A value computed from the results of the runs
+     */
+    void add( const std::string& name, const std::string& input, unsigned int operations, const std::vector<double>& samples, uint64_t checksum)
+    {
+        Result result;
+        result.name = name;
+        result.input = input;
+        result.operations = operations;
+        result.samples.assign( samples.begin() + 1, samples.end());
+        std::sort( result.samples.begin(), result.samples.end());
+        result.checksum = checksum;
+        m_results.push_back( result);
+
+        std::cout << std::left << std::setw(52) << name << std::right
+                  << " median " << std::setw(12) << result.getMedian()
+                  << " us  p99 " << std::setw(12) << result.getPercentile( 0.99) << " us" << std::endl;
+    }
+
+    void writeJSON( std::ostream& out, const Settings& settings, const std::string& label) const
+    {
+        out << "{\n  \"label\": \"" << escape( label) << "\",\n"
+            << "  \"scale\": " << settings.scale << ",\n"
+            << "  \"samples\": " << settings.numSamples << ",\n"
+            << "  \"seed\": " << settings.seed << ",\n"
+            << "  \"threads\": " << getNumThreads() << ",\n"
+            << "  \"unit\": \"us\",\n"
+            << "  \"benchmarks\": [";
+        for( size_t i = 0; i < m_results.size(); ++i)
+        {
+            const Result& result = m_results[i];
+            out << ( i ? ",\n" : "\n")
+                << "    {\"name\": \"" << escape( result.name) << "\""
+                << ", \"input\": \"" << escape( result.input) << "\""
+                << ", \"operations\": " << result.operations
+                << ", \"median\": " << result.getMedian()
+                << ", \"p99\": " << result.getPercentile( 0.99)
+                << ", \"min\": " << result.samples.front()
+                << ", \"max\": " << result.samples.back()
+                << ", \"mean\": " << result.getMean()
+                << ", \"checksum\": " << result.checksum << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+
+    struct Result
+    {
+        std::string name;
+        std::string input;
+        unsigned int operations;
+        std::vector<double> samples;
+        uint64_t checksum;
+
+        double getMedian() const
+        {
+            size_t middle = samples.size() / 2;
+            if( samples.size() % 2) return samples[middle];
+            return ( samples[middle - 1] + samples[middle]) / 2;
+        }
+
+        /* the nearest rank percentile */
+        double getPercentile( double fraction) const
+        {
+            size_t rank = size_t( std::ceil( fraction * samples.size()));
+            return samples[ std::max<size_t>( rank, 1) - 1];
+        }
+
+        double getMean() const
+        {
+            double sum = 0;
+            for( size_t i = 0; i < samples.size(); ++i) sum += samples[i];
+            return sum / samples.size();
+        }
+    };
+
+    std::string m_filter;
+    std::vector<Result> m_results;
+
+    static std::string escape( const std::string& text)
+    {
+        std::string escaped;
+        for( size_t i = 0; i < text.size(); ++i)
+        {
+            if( ( text[i] == '"') || ( text[i] == '\\')) escaped += '\\';
+            escaped += text[i];
+        }
+        return escaped;
+    }
+};
+
+
+template<typename T>
+std::string toString( const T& value)
+{
+    std::stringstream stream;
+    stream << value;
+    return stream.str();
+}
+
+
+std::string describeGraph( const std::string& generator, unsigned int numNodes, unsigned int numEdges)
+{
+    return generator + ", " + toString( numNodes) + " nodes, " + toString( numEdges) + " edges";
+}
+
+
+/**
+ * @brief Sorted insertions and erasures of batches of random keys, and full scans of a packed memory array
+ */
+void benchmarkPackedMemoryArray( BenchmarkSuite& suite, const Settings& settings)
+{
+    typedef PackedMemoryArray<unsigned int> ArrayType;
+    typedef ArrayType::Iterator             Iterator;
+
+    if( !suite.isSelected( "pma")) return;
+
+    /* the array holds the even keys, the inserted keys are odd */
+    unsigned int numElements = 1u << ( settings.scale + 4);
+    std::vector<unsigned int> elements( numElements), keys( settings.batchSize);
+    for( unsigned int i = 0; i < numElements; ++i) elements[i] = 2 * i;
+    std::string input = toString( numElements) + " sorted elements";
+
+    ArrayType array;
+    RandomStream random( settings.seed, 1);
+    std::vector<double> samples;
+    Timer timer;
+
+    if( suite.isSelected( "pma/insert"))
+    {
+        uint64_t checksum = 0;
+        samples.clear();
+        for( unsigned int s = 0; s <= settings.numSamples; ++s)
+        {
+            array.assign( elements);
+            for( unsigned int k = 0; k < keys.size(); ++k) keys[k] = 2 * random.nextBelow( numElements) + 1;
+
+            timer.start();
+            for( unsigned int k = 0; k < keys.size(); ++k)
+            {
+                array.insert( array.lower_bound( keys[k]), keys[k]);
+            }
+            timer.stop();
+            samples.push_back( timer.getElapsedTimeInMicroSec());
+            checksum += array.size();
+        }
+        suite.add( "pma/insert", input, keys.size(), samples, checksum);
+    }
+
+    if( suite.isSelected( "pma/erase"))
+    {
+        uint64_t checksum = 0;
+        samples.clear();
+        for( unsigned int s = 0; s <= settings.numSamples; ++s)
+        {
+            array.assign( elements);
+            for( unsigned int k = 0; k < keys.size(); ++k) keys[k] = 2 * random.nextBelow( numElements);
+
+            timer.start();
+            for( unsigned int k = 0; k < keys.size(); ++k)
+            {
+                Iterator it = array.lower_bound( keys[k]);
+                if( it != array.end()) array.erase( it);
+            }
+            timer.stop();
+            samples.push_back( timer.getElapsedTimeInMicroSec());
+            checksum += array.size();
+        }
+        suite.add( "pma/erase", input, keys.size(), samples, checksum);
+    }
+
+    if( suite.isSelected( "pma/scan"))
+    {
+        uint64_t checksum = 0;
+        samples.clear();
+        array.assign( elements);
+        for( unsigned int s = 0; s <= settings.numSamples; ++s)
+        {
+            timer.start();
+            for( Iterator it = array.begin(), end = array.end(); it != end; ++it)
+            {
+                checksum += *it;
+            }
+            timer.stop();
+            samples.push_back( timer.getElapsedTimeInMicroSec());
+        }
+        suite.add( "pma/scan", input, numElements, samples, checksum);
+    }
+}
+
+
+/**
+ * @brief Insertions of batches of edges between random nodes of a graph, lookups of them and of absent edges, and their erasure
+ *
+ * The program exits if a lookup or the number of edges disagrees with the updates.
+ */
+template<class GraphType>
+void benchmarkGraphUpdates( BenchmarkSuite& suite, const std::string& implementation, const Settings& settings)
+{
+    typedef typename GraphType::NodeDescriptor   NodeDescriptor;
+    typedef typename GraphType::EdgeDescriptor   EdgeDescriptor;
+    typedef std::pair<NodeDescriptor,NodeDescriptor> NodePair;
+
+    std::string prefix = "updates/" + implementation;
+    if( !suite.isSelected( prefix)) return;
+
+    GraphType G;
+    unsigned int width = 1u << ( settings.scale / 2);
+    GridGenerator<GraphType> generator( width, width, settings.seed);
+    generator.generate( G);
+    const std::vector<NodeDescriptor>& ids = generator.getIds();
+    std::string input = describeGraph( "grid", G.getNumNodes(), G.getNumEdges());
+    unsigned int numEdges = G.getNumEdges();
+
+    RandomStream random( settings.seed, 2);
+    std::vector<NodePair> pairs;
+    std::set<NodePair> chosen;
+    std::vector<EdgeDescriptor> edges;
+    std::vector<double> insertSamples, lookupSamples, eraseSamples;
+    uint64_t checksum = 0;
+    unsigned int numFound = 0;
+    Timer timer;
+
+    for( unsigned int s = 0; s <= settings.numSamples; ++s)
+    {
+        pairs.clear();
+        chosen.clear();
+        while( pairs.size() < settings.batchSize)
+        {
+            NodePair pair( ids[ random.nextBelow( ids.size())], ids[ random.nextBelow( ids.size())]);
+            if( ( pair.first == pair.second) || G.hasEdge( pair.first, pair.second) || !chosen.insert( pair).second) continue;
+            pairs.push_back( pair);
+        }
+
+        edges.clear();
+        timer.start();
+        for( unsigned int k = 0; k < pairs.size(); ++k)
+        {
+            edges.push_back( G.insertEdge( pairs[k].first, pairs[k].second));
+        }
+        timer.stop();
+        insertSamples.push_back( timer.getElapsedTimeInMicroSec());
+        checksum += G.getNumEdges();
+
+        // Every inserted edge, and the reverse edge, which is mostly absent
+        numFound = 0;
+        timer.start();
+        for( unsigned int k = 0; k < pairs.size(); ++k)
+        {
+            numFound += G.hasEdge( pairs[k].first, pairs[k].second);
+            numFound += G.hasEdge( pairs[k].second, pairs[k].first);
+        }
+        timer.stop();
+        lookupSamples.push_back( timer.getElapsedTimeInMicroSec());
+        checksum += numFound;
+        bool isValid = ( numFound >= pairs.size()) && ( G.getNumEdges() == numEdges + pairs.size());
+
+        timer.start();
+        for( unsigned int k = 0; k < edges.size(); ++k)
+        {
+            G.eraseEdge( edges[k]);
+        }
+        timer.stop();
+        eraseSamples.push_back( timer.getElapsedTimeInMicroSec());
+        checksum += G.getNumEdges();
+
+        for( unsigned int k = 0; k < pairs.size(); ++k)
+        {
+            isValid = isValid && !G.hasEdge( pairs[k].first, pairs[k].second);
+        }
+        if( !isValid || ( G.getNumEdges() != numEdges) || !G.hasValidInEdges())
+        {
+            std::cerr << "The edges of " << implementation << " differ from the updates" << std::endl;
+            std::exit( EXIT_FAILURE);
+        }
+    }
+
+    if( suite.isSelected( prefix + "/insertEdge")) suite.add( prefix + "/insertEdge", input, settings.batchSize, insertSamples, checksum);
+    if( suite.isSelected( prefix + "/hasEdge")) suite.add( prefix + "/hasEdge", input, 2 * settings.batchSize, lookupSamples, checksum);
+    if( suite.isSelected( prefix + "/eraseEdge")) suite.add( prefix + "/eraseEdge", input, settings.batchSize, eraseSamples, checksum);
+}
+
+
+/**
+ * @brief Replays of a change log with edge changes and node erasures on a packed memory graph
+ *
+ * Half of the edge changes are between neighbours of the grid, so that edges that exist are
+ * added, erased and reweighted too. After every replay the graph is compared to the log applied
+ * to a map of its edges, and the program exits if they differ.
+ */
+void benchmarkChangeLog( BenchmarkSuite& suite, const Settings& settings)
+{
+    typedef PackedMemoryGraph::NodeDescriptor   NodeDescriptor;
+    typedef PackedMemoryGraph::NodeIterator     NodeIterator;
+    typedef PackedMemoryGraph::EdgeIterator     EdgeIterator;
+    typedef std::pair<unsigned int,unsigned int> Edge;
+    typedef std::map<Edge,unsigned int>         EdgeMap;
+
+    if( !suite.isSelected( "changelog/replay")) return;
+
+    unsigned int width = 1u << ( settings.scale / 2);
+    GridGenerator<PackedMemoryGraph> generator( width, width, settings.seed);
+    unsigned int numNodes = generator.getNumNodes();
+    std::string filename = "benchmark.log";
+
+    EdgeMap expected;
+    for( unsigned int i = 0; i < generator.getEdges().size(); ++i)
+    {
+        expected[ generator.getEdges()[i]] = generator.getWeights()[i];
+    }
+
+    RandomStream random( settings.seed, 3);
+    std::vector<bool> isNode( numNodes, true);
+    ChangeLogWriter log( filename);
+    for( unsigned int i = 0; i < settings.batchSize; ++i)
+    {
+        unsigned int type = random.nextBelow( 64);
+        unsigned int source = random.nextBelow( numNodes);
+        unsigned int target = random.nextBelow( 2) ? ( source + ( random.nextBelow( 2) ? 1 : width)) % numNodes : random.nextBelow( numNodes);
+        unsigned int weight = random.nextBelow( 1000) + 1;
+        Edge edge( source, target);
+        bool isValid = isNode[source] && isNode[target] && ( source != target);
+
+        if( type == 0)
+        {
+            log.eraseNode( source);
+            if( !isNode[source]) continue;
+            isNode[source] = false;
+            for( EdgeMap::iterator it = expected.begin(); it != expected.end(); )
+            {
+                if( ( it->first.first == source) || ( it->first.second == source)) expected.erase( it++);
+                else ++it;
+            }
+        }
+        else if( type < 32)
+        {
+            log.addEdge( source, target, weight);
+            if( isValid) expected[edge] = weight;
+        }
+        else if( type < 48)
+        {
+            log.eraseEdge( source, target);
+            expected.erase( edge);
+        }
+        else
+        {
+            log.setWeight( source, target, weight);
+            if( expected.count( edge)) expected[edge] = weight;
+        }
+    }
+    log.close();
+
+    std::vector<double> samples;
+    uint64_t checksum = 0;
+    Timer timer;
+
+    for( unsigned int s = 0; s <= settings.numSamples; ++s)
+    {
+        PackedMemoryGraph G;
+        generator.generate( G);
+        std::vector<NodeDescriptor> ids = generator.getIds();
+        ChangeLogApplier<PackedMemoryGraph> applier( G, ids);
+
+        timer.start();
+        applier.apply( filename, false);
+        timer.stop();
+        samples.push_back( timer.getElapsedTimeInMicroSec());
+
+        std::map<NodeDescriptor,unsigned int> idOf;
+        for( unsigned int i = 0; i < ids.size(); ++i)
+        {
+            if( ids[i]) idOf[ ids[i]] = i;
+        }
+        EdgeMap found;
+        for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( EdgeIterator e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                found[ Edge( idOf[ G.getNodeDescriptor(u)], idOf[ G.getNodeDescriptor( G.target(e))])] = e->weight;
+                checksum += e->weight;
+            }
+        }
+        if( ( found != expected) || !G.hasValidInEdges())
+        {
+            std::cerr << "The replay of the change log differs from the expected graph" << std::endl;
+            std::remove( filename.c_str());
+            std::exit( EXIT_FAILURE);
+        }
+    }
+    std::remove( filename.c_str());
+
+    suite.add( "changelog/replay", describeGraph( "grid", numNodes, expected.size()), settings.batchSize, samples, checksum);
+}
+
+
+/**
+ * @brief Scans of all the outgoing and incoming edges of a graph, and a BFS from its first node
+ */
+template<class GraphType>
+void benchmarkTraversal( BenchmarkSuite& suite, const std::string& prefix, GraphType& G, const std::string& input, const Settings& settings)
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+
+    NodeIterator u, lastNode;
+    EdgeIterator e, lastEdge;
+    InEdgeIterator k, lastInEdge;
+    std::vector<double> samples;
+    Timer timer;
+
+    if( suite.isSelected( prefix + "/outEdges"))
+    {
+        uint64_t checksum = 0;
+        samples.clear();
+        for( unsigned int s = 0; s <= settings.numSamples; ++s)
+        {
+            timer.start();
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+            {
+                for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+                {
+                    checksum += e->weight;
+                }
+            }
+            timer.stop();
+            samples.push_back( timer.getElapsedTimeInMicroSec());
+        }
+        suite.add( prefix + "/outEdges", input, G.getNumEdges(), samples, checksum);
+    }
+
+    if( suite.isSelected( prefix + "/inEdges"))
+    {
+        uint64_t checksum = 0;
+        samples.clear();
+        for( unsigned int s = 0; s <= settings.numSamples; ++s)
+        {
+            timer.start();
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+            {
+                for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+                {
+                    checksum += k->weight;
+                }
+            }
+            timer.stop();
+            samples.push_back( timer.getElapsedTimeInMicroSec());
+        }
+        suite.add( prefix + "/inEdges", input, G.getNumEdges(), samples, checksum);
+    }
+
+    if( suite.isSelected( prefix + "/bfs"))
+    {
+        uint64_t checksum = 0;
+        samples.clear();
+        for( unsigned int s = 0; s <= settings.numSamples; ++s)
+        {
+            NodeIterator root = G.beginNodes();
+            timer.start();
+            bfsCore( G, root);
+            timer.stop();
+            samples.push_back( timer.getElapsedTimeInMicroSec());
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u) checksum += u->marked;
+        }
+        suite.add( prefix + "/bfs", input, G.getNumNodes(), samples, checksum);
+    }
+}
+
+
+/**
+ * @brief Runs the traversal benchmarks on a road-like grid and on a skewed R-MAT graph
+ */
+template<class GraphType>
+void benchmarkTraversals( BenchmarkSuite& suite, const std::string& implementation, const Settings& settings)
+{
+    std::string prefix = "traversal/" + implementation;
+    if( !suite.isSelected( prefix)) return;
+
+    if( suite.isSelected( prefix + "/grid"))
+    {
+        GraphType G;
+        unsigned int width = 1u << ( settings.scale / 2);
+        GridGenerator<GraphType> generator( width, width, settings.seed);
+        generator.generate( G);
+        benchmarkTraversal( suite, prefix + "/grid", G, describeGraph( "grid", G.getNumNodes(), G.getNumEdges()), settings);
+    }
+
+    if( suite.isSelected( prefix + "/rmat"))
+    {
+        GraphType G;
+        RMatGenerator<GraphType> generator( settings.scale, 8, settings.seed);
+        generator.generate( G);
+        benchmarkTraversal( suite, prefix + "/rmat", G, describeGraph( "rmat", G.getNumNodes(), G.getNumEdges()), settings);
+    }
+}
+
+
+/**
+ * @brief Insertions of random keys, decreases of a quarter of them and extraction of all of them, with a storage scheme
+ */
+template<template <typename datatype> class StorageType>
+void benchmarkPriorityQueue( BenchmarkSuite& suite, const std::string& storage, const std::vector<unsigned int>& keys, const Settings& settings)
+{
+    typedef PriorityQueue< unsigned int, unsigned int, StorageType> PriorityQueueType;
+
+    std::string prefix = "priorityQueue/" + storage;
+    if( !suite.isSelected( prefix)) return;
+
+    PriorityQueueType pq;
+    std::vector<PQSizeType> items( keys.size());
+    std::vector<double> insertSamples, decreaseSamples, popSamples;
+    std::string input = toString( keys.size()) + " random keys";
+    uint64_t checksum = 0;
+    Timer timer;
+
+    for( unsigned int s = 0; s <= settings.numSamples; ++s)
+    {
+        timer.start();
+        for( unsigned int i = 0; i < keys.size(); ++i)
+        {
+            pq.insert( keys[i], i, &items[i]);
+        }
+        timer.stop();
+        insertSamples.push_back( timer.getElapsedTimeInMicroSec());
+
+        timer.start();
+        for( unsigned int i = 0; i < keys.size(); i += 4)
+        {
+            pq.decrease( keys[i] / 2, &items[i]);
+        }
+        timer.stop();
+        decreaseSamples.push_back( timer.getElapsedTimeInMicroSec());
+
+        timer.start();
+        while( !pq.empty())
+        {
+            checksum += pq.minKey();
+            pq.popMin();
+        }
+        timer.stop();
+        popSamples.push_back( timer.getElapsedTimeInMicroSec());
+    }
+
+    if( suite.isSelected( prefix + "/insert")) suite.add( prefix + "/insert", input, keys.size(), insertSamples, checksum);
+    if( suite.isSelected( prefix + "/decrease")) suite.add( prefix + "/decrease", input, ( keys.size() + 3) / 4, decreaseSamples, checksum);
+    if( suite.isSelected( prefix + "/popMin")) suite.add( prefix + "/popMin", input, keys.size(), popSamples, checksum);
+}
+
+
+void benchmarkPriorityQueues( BenchmarkSuite& suite, const Settings& settings)
+{
+    if( !suite.isSelected( "priorityQueue")) return;
+
+    std::vector<unsigned int> keys( 1u << settings.scale);
+    RandomStream random( settings.seed, 3);
+    for( unsigned int i = 0; i < keys.size(); ++i) keys[i] = random.nextBelow( 1u << 30);
+
+    benchmarkPriorityQueue<HeapStorage>( suite, "HeapStorage", keys, settings);
+    benchmarkPriorityQueue<VebStorage>( suite, "VebStorage", keys, settings);
+    benchmarkPriorityQueue<ExplicitHeapStorage>( suite, "ExplicitHeapStorage", keys, settings);
+    benchmarkPriorityQueue<ExplicitVebStorage>( suite, "ExplicitVebStorage", keys, settings);
+    benchmarkPriorityQueue<ExplicitPowerVebStorage>( suite, "ExplicitPowerVebStorage", keys, settings);
+}
+
+
+/**
+ * @brief Generates a grid with coordinates, node ids and a second random criterion on the edges
+ */
+void generateRoutingGraph( RoutingGraph& G, unsigned int width, const Settings& settings)
+{
+    typedef RoutingGraph::NodeIterator      NodeIterator;
+    typedef RoutingGraph::EdgeIterator      EdgeIterator;
+    typedef RoutingGraph::InEdgeIterator    InEdgeIterator;
+
+    GridGenerator<RoutingGraph> generator( width, width, settings.seed);
+    generator.generate( G);
+    generator.setCoordinates( G);
+    const std::vector<RoutingGraph::NodeDescriptor>& ids = generator.getIds();
+    for( unsigned int i = 0; i < ids.size(); ++i) G.getNodeIterator( ids[i])->id = i;
+
+    NodeIterator u, lastNode;
+    EdgeIterator e, lastEdge;
+    InEdgeIterator k, lastInEdge;
+    for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+    {
+        for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+        {
+            e->criteriaList[0] = e->weight;
+            e->criteriaList[1] = 1 + mixBits64( settings.seed ^ ( uint64_t( u->id) << 32 | G.target(e)->id)) % 100;
+        }
+        for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+        {
+            k->criteriaList[0] = k->weight;
+            k->criteriaList[1] = 1 + mixBits64( settings.seed ^ ( uint64_t( G.source(k)->id) << 32 | u->id)) % 100;
+        }
+    }
+}
+
+
+template<class GraphType>
+void chooseQueries( GraphType& G, unsigned int numQueries, uint64_t seed, std::vector< std::pair<typename GraphType::NodeIterator, typename GraphType::NodeIterator> >& queries)
+{
+    typedef typename GraphType::NodeIterator NodeIterator;
+
+    std::vector<NodeIterator> nodes;
+    for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u) nodes.push_back( u);
+
+    RandomStream random( seed, 4);
+    queries.clear();
+    for( unsigned int i = 0; i < numQueries; ++i)
+    {
+        queries.push_back( std::make_pair( nodes[ random.nextBelow( nodes.size())], nodes[ random.nextBelow( nodes.size())]));
+    }
+}
+
+
+/**
+ * @brief Runs one query per sample with a single criterion engine, constructed with the graph and the timestamp
+ */
+template<class EngineType, class GraphType>
+void benchmarkQueries( BenchmarkSuite& suite, const std::string& name, const std::string& input, GraphType& G, unsigned int* timestamp,
+                       const std::vector< std::pair<typename GraphType::NodeIterator, typename GraphType::NodeIterator> >& queries)
+{
+    if( !suite.isSelected( name)) return;
+
+    EngineType engine( G, timestamp);
+    std::vector<double> samples;
+    uint64_t checksum = 0;
+    Timer timer;
+
+    for( unsigned int i = 0; i < queries.size(); ++i)
+    {
+        timer.start();
+        unsigned int distance = engine.runQuery( queries[i].first, queries[i].second);
+        timer.stop();
+        samples.push_back( timer.getElapsedTimeInMicroSec());
+        checksum += distance;
+    }
+    suite.add( name, input, 1, samples, checksum);
+}
+
+
+/**
+ * @brief Runs one query per sample with a multicriteria engine. The computation of the heuristic is part of the query
+ */
+template<class EngineType, class GraphType>
+void benchmarkParetoQueries( BenchmarkSuite& suite, const std::string& name, const std::string& input, EngineType& engine,
+                             const std::vector< std::pair<typename GraphType::NodeIterator, typename GraphType::NodeIterator> >& queries)
+{
+    std::vector<double> samples;
+    uint64_t checksum = 0;
+    Timer timer;
+
+    for( unsigned int i = 0; i < queries.size(); ++i)
+    {
+        timer.start();
+        engine.init( queries[i].first, queries[i].second);
+        engine.runQuery( queries[i].first, queries[i].second);
+        timer.stop();
+        samples.push_back( timer.getElapsedTimeInMicroSec());
+        checksum += queries[i].second->labels.size();
+    }
+    suite.add( name, input, 1, samples, checksum);
+}
+
+
+/**
+ * @brief Random queries with every single criterion shortest path algorithm on a grid, and on the DAG of its edges towards higher ids
+ */
+void benchmarkShortestPaths( BenchmarkSuite& suite, const Settings& settings)
+{
+    typedef RoutingGraph::NodeIterator  NodeIterator;
+    typedef std::pair<NodeIterator,NodeIterator> Query;
+
+    if( !suite.isSelected( "shortestPath")) return;
+
+    RoutingGraph G;
+    generateRoutingGraph( G, 1u << ( settings.scale / 2), settings);
+    std::string input = describeGraph( "grid", G.getNumNodes(), G.getNumEdges());
+    std::vector<Query> queries;
+    chooseQueries( G, settings.numSamples + 1, settings.seed, queries);
+    unsigned int timestamp = 0;
+
+    benchmarkQueries< Dijkstra<RoutingGraph> >( suite, "shortestPath/Dijkstra", input, G, &timestamp, queries);
+    benchmarkQueries< BackwardDijkstra<RoutingGraph> >( suite, "shortestPath/BackwardDijkstra", input, G, &timestamp, queries);
+    benchmarkQueries< BidirectionalDijkstra<RoutingGraph> >( suite, "shortestPath/BidirectionalDijkstra", input, G, &timestamp, queries);
+    benchmarkQueries< AStarDijkstra<RoutingGraph> >( suite, "shortestPath/AStarDijkstra", input, G, &timestamp, queries);
+
+    if( suite.isSelected( "shortestPath/DagShortestPath"))
+    {
+        /* the edges towards higher ids, that is rightwards and downwards, form a DAG */
+        std::vector< std::pair<unsigned int,unsigned int> > edges;
+        std::vector<RoutingEdge> edgeData;
+        std::vector<RoutingGraph::NodeDescriptor> ids;
+        for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( RoutingGraph::EdgeIterator e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                if( u->id > G.target(e)->id) continue;
+                edges.push_back( std::make_pair( u->id, G.target(e)->id));
+                edgeData.push_back( *e);
+            }
+        }
+        RoutingGraph D;
+        D.buildFromEdgeList( G.getNumNodes(), edges, edgeData, ids);
+
+        /* the same queries, with the source of every query first in the topological order */
+        std::vector<Query> dagQueries;
+        for( unsigned int i = 0; i < queries.size(); ++i)
+        {
+            unsigned int first = std::min( queries[i].first->id, queries[i].second->id);
+            unsigned int second = std::max( queries[i].first->id, queries[i].second->id);
+            dagQueries.push_back( std::make_pair( D.getNodeIterator( ids[first]), D.getNodeIterator( ids[second])));
+        }
+        unsigned int dagTimestamp = 0;
+        benchmarkQueries< DagShortestPath<RoutingGraph> >( suite, "shortestPath/DagShortestPath", describeGraph( "grid DAG", D.getNumNodes(), D.getNumEdges()), D, &dagTimestamp, dagQueries);
+    }
+}
+
+
+/**
+ * @brief Random bicriteria queries with NAMOA* and the other multicriteria algorithms on a small grid
+ */
+void benchmarkMulticriteria( BenchmarkSuite& suite, const Settings& settings)
+{
+    typedef RoutingGraph::NodeIterator  NodeIterator;
+    typedef std::pair<NodeIterator,NodeIterator> Query;
+
+    if( !suite.isSelected( "multicriteria")) return;
+
+    RoutingGraph G;
+    unsigned int width = 1u << ( std::max( settings.scale / 2, 6u) - 3);
+    generateRoutingGraph( G, width, settings);
+    std::string input = describeGraph( "grid, 2 criteria", G.getNumNodes(), G.getNumEdges());
+    std::vector<Query> queries;
+    chooseQueries( G, settings.numSamples + 1, settings.seed, queries);
+    unsigned int timestamp = 0;
+
+    if( suite.isSelected( "multicriteria/NamoaStarDijkstra/BlindHeuristic"))
+    {
+        NamoaStarDijkstra<RoutingGraph, BlindHeuristic> engine( G, 2, &timestamp);
+        benchmarkParetoQueries<NamoaStarDijkstra<RoutingGraph, BlindHeuristic>, RoutingGraph>( suite, "multicriteria/NamoaStarDijkstra/BlindHeuristic", input, engine, queries);
+    }
+    if( suite.isSelected( "multicriteria/NamoaStarDijkstra/TCHeuristic"))
+    {
+        NamoaStarDijkstra<RoutingGraph, TCHeuristic> engine( G, 2, &timestamp);
+        benchmarkParetoQueries<NamoaStarDijkstra<RoutingGraph, TCHeuristic>, RoutingGraph>( suite, "multicriteria/NamoaStarDijkstra/TCHeuristic", input, engine, queries);
+    }
+    if( suite.isSelected( "multicriteria/MulticriteriaDijkstra"))
+    {
+        MulticriteriaDijkstra<RoutingGraph> engine( G, 2, &timestamp);
+        benchmarkParetoQueries<MulticriteriaDijkstra<RoutingGraph>, RoutingGraph>( suite, "multicriteria/MulticriteriaDijkstra", input, engine, queries);
+    }
+    if( suite.isSelected( "multicriteria/ParallelParetoSearch"))
+    {
+        ParallelParetoSearch<RoutingGraph, TCHeuristic> engine( G, 2);
+        benchmarkParetoQueries<ParallelParetoSearch<RoutingGraph, TCHeuristic>, RoutingGraph>( suite, "multicriteria/ParallelParetoSearch", input, engine, queries);
+    }
+}
+
+
+int main( int argc, char* argv[])
+{
+    Settings settings;
+    std::string output, filter, label;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("output,o", po::value<std::string>(&output)->default_value("benchmark.json"), "the file to write the results to")
+        ("scale,s", po::value<unsigned int>(&settings.scale)->default_value(16), "the base 2 logarithm of the number of nodes of the graphs")
+        ("samples,n", po::value<unsigned int>(&settings.numSamples)->default_value(50), "the number of samples of every benchmark")
+        ("batch,b", po::value<unsigned int>(&settings.batchSize)->default_value(1024), "the number of updates measured by one sample")
+        ("seed", po::value<uint64_t>(&settings.seed)->default_value(1), "the seed of the generated inputs")
+        ("filter,f", po::value<std::string>(&filter)->default_value(""), "run only the benchmarks whose names start with this prefix")
+        ("label,l", po::value<std::string>(&label)->default_value(""), "a label for the results, such as the current commit")
+    ;
+
+    po::variables_map vm;
+    po::store( po::parse_command_line( argc, argv, desc), vm);
+    po::notify( vm);
+
+    if( vm.count("help") || ( settings.numSamples == 0) || ( settings.batchSize == 0) || ( settings.scale < 4) || ( settings.scale > 26))
+    {
+        std::cout << desc << std::endl;
+        return vm.count("help") ? 0 : 1;
+    }
+
+    BenchmarkSuite suite( filter);
+    benchmarkPackedMemoryArray( suite, settings);
+    benchmarkGraphUpdates<ForwardStarGraph>( suite, "ForwardStarImpl", settings);
+    benchmarkGraphUpdates<AdjacencyListGraph>( suite, "AdjacencyListImpl", settings);
+    benchmarkGraphUpdates<PackedMemoryGraph>( suite, "PackedMemoryGraphImpl", settings);
+    benchmarkChangeLog( suite, settings);
+    benchmarkTraversals<ForwardStarGraph>( suite, "ForwardStarImpl", settings);
+    benchmarkTraversals<AdjacencyListGraph>( suite, "AdjacencyListImpl", settings);
+    benchmarkTraversals<PackedMemoryGraph>( suite, "PackedMemoryGraphImpl", settings);
+    benchmarkPriorityQueues( suite, settings);
+    benchmarkShortestPaths( suite, settings);
+    benchmarkMulticriteria( suite, settings);
+
+    std::ofstream out( output.c_str());
+    suite.writeJSON( out, settings, label);
+    std::cout << "Results written to " << output << std::endl;
+    return 0;
+}
@@ -4,11 +4,21 @@
 #include <Structs/Trees/priorityQueue.h>
 #include <Utilities/geographic.h>
 #include <Algorithms/basicGraphAlgorithms.h>
+#include <Algorithms/graphPartitioning.h>
+#include <Algorithms/ShortestPath/Multicriteria/queryStats.h>
+#include <bitset>
 
-template<class GraphType>
+template<class GraphType, template <typename graphType> class PartitionerType>
 class MulticriteriaArc;
 
-template<class GraphType, template <typename graphType> class HeuristicType>
+/**
+ * @brief NAMOA* search pruned with multicriteria arc flags
+ *
+ * Edges need a field flags with one bit per cell, e.g. std::bitset<128>, and nodes a field cell
+ * that is written by the partitioner. The StatsType policy collects per-query statistics, see
+ * NoQueryStats and MulticriteriaQueryStats.
+ */
+template<class GraphType, template <typename graphType> class HeuristicType, template <typename graphType> class PartitionerType = GridPartitioner, class StatsType = NoQueryStats>
 class NamoaStarArc
 {
 public:
@@ -25,8 +35,9 @@ public:
      *
      * @param graph The graph to run the algorithm on
      * @param timestamp An address containing a timestamp. A timestamp must be given in order to check whether a node is visited or not
+     * @param numCells The number of cells of the partition
      */
-    NamoaStarArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):G(graph),m_numCriteria(numCriteria),m_timestamp(timestamp),m_heuristicEngine(graph),m_arcDijkstra(graph, numCriteria, timestamp)
+    NamoaStarArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp, unsigned int numCells = 16):G(graph),m_numCriteria(numCriteria),m_timestamp(timestamp),m_heuristicEngine(graph),m_arcDijkstra(graph, numCriteria, timestamp, numCells)
     {
     }
     
@@ -37,7 +48,9 @@ public:
 		{
 		    u->labels.clear();
 		}
+        m_stats.startHeuristic();
         m_heuristicEngine.init(s,t);
+        m_stats.stopHeuristic();
 		pq.clear();
 	}
 
@@ -53,6 +66,7 @@ public:
 
         m_generatedLabels = 1;
 		assert( hasFeasiblePotentials(t));
+        m_stats.startSearch();
 		++(*m_timestamp);
 		
 
@@ -60,7 +74,7 @@ public:
 		s->labels.push_back(Label( CriteriaList(m_numCriteria), 0, pqitem));
 		pq.insert( CriteriaList(m_numCriteria) + s->heuristicList, s, pqitem);
 
-        unsigned int mask = m_arcDijkstra.getPartition().getOnMask( m_arcDijkstra.getPartition().getCell( t->x, t->y));
+        unsigned int targetCell = t->cell;
 
 		while( !pq.empty())
 		{
@@ -77,7 +91,11 @@ public:
 			
 			moveToClosed( g_u, u);
 
-			if ( isDominatedByNodeLabels( t, minCriteria)) continue;
+			if ( isDominatedByNodeLabels( t, minCriteria))
+            {
+                m_stats.prunedByTarget();
+                continue;
+            }
 
 		    //std::cout << "extracting " << u->id << " with label ";
 		    //label.print(std::cout, G);
@@ -85,7 +103,7 @@ public:
 
 		  	for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
 		    {
-                if( ! (e->flags & mask)) continue;
+                if( !e->flags.test( targetCell)) continue;
 
 				v = G.target(e);
 				
@@ -102,25 +120,45 @@ public:
 				{
 					v->labels.push_back( Label( g_v, u->getDescriptor(), 0) );
                     ++m_generatedLabels;
+                    m_stats.observeLabels( v->labels.size());
 				}
 				else	
 				{
-					if( isDominatedByNodeLabels( v, g_v)) continue;
+					if( isDominatedByNodeLabels( v, g_v))
+                    {
+                        m_stats.prunedByNode();
+                        continue;
+                    }
 					eraseDominatedLabels( G, v, g_v);
-					if( isDominatedByNodeLabels(t, heuristicCost)) continue;
+					if( isDominatedByNodeLabels(t, heuristicCost))
+                    {
+                        m_stats.prunedByTarget();
+                        continue;
+                    }
 					unsigned int* pqitem = new unsigned int();
 					v->labels.push_back( Label( g_v, u->getDescriptor(), pqitem) );
 				    ++m_generatedLabels;
 					pq.insert( heuristicCost, v, pqitem);
+                    m_stats.observeLabels( v->labels.size());
+                    m_stats.observeQueue( pq.size());
 				}
 		    }
 		}
+        m_stats.stopSearch( m_generatedLabels, t->labels.size());
     }
 
     const unsigned int& getGeneratedLabels()
     {
         return m_generatedLabels;
     }
+
+    /**
+     * @brief Returns the statistics policy, which holds the record of the last query
+     */
+    StatsType& getStats()
+    {
+        return m_stats;
+    }
     
     /**
      * @brief Runs a shortest path query between a source node s and a target node t
@@ -141,7 +179,8 @@ private:
 	unsigned int m_numCriteria;
 	unsigned int* m_timestamp;
     HeuristicType<GraphType> m_heuristicEngine;
-    MulticriteriaArc<GraphType> m_arcDijkstra;
+    MulticriteriaArc<GraphType, PartitionerType> m_arcDijkstra;
+    StatsType m_stats;
 
 	bool distanceExistsInNode( const NodeIterator& v, const CriteriaList& g_v)
 	{
@@ -251,7 +290,14 @@ private:
 
 
 
-template<class GraphType>
+/**
+ * @brief Multicriteria Dijkstra pruned with arc flags
+ *
+ * The graph is split into cells by the partitioner, which writes the cell of every node into the
+ * field cell. Edges need a field flags with at least as many bits as cells, e.g. std::bitset<128>.
+ * A flag is set if the edge lies on a Pareto optimal path towards the corresponding cell.
+ */
+template<class GraphType, template <typename graphType> class PartitionerType = GridPartitioner>
 class MulticriteriaArc
 {
 public:
@@ -264,126 +310,49 @@ public:
 	typedef PriorityQueue< Label, NodeIterator, HeapStorage> PriorityQueueType;
 	typedef typename PriorityQueueType::PQItem PQItem;   
 	
-    class Partition
-    {
-    public:
-        
-        Partition()
-        {
-        }
-        
-	    Partition( unsigned int xmin, unsigned int xmax, unsigned int ymin, unsigned int ymax, unsigned int div, unsigned int l = 1):
-	                        m_xmin(xmin),
-	                        m_xmax(xmax + 1),
-	                        m_ymin(ymin),
-	                        m_ymax(ymax + 1),
-	                        m_div(div),
-	                        m_numLevels(l)
-	    {    
-        }
-
-        unsigned int getCell( unsigned int x, unsigned int y, unsigned int l = 0)
-	    {   
-	        unsigned int column = getOffsetX(x, l) / getStepXofLevel(l);
-		    unsigned int row = getOffsetY(y, l) / getStepYofLevel(l);
-		    return row*m_div + column;
-        }
-    
-        unsigned int getMaxLevel () const
-        {
-            return getNumLevels() - 1;
-        }
-    
-        unsigned int getNumCells ( const unsigned int& l = 0) const
-        {
-            return m_div * m_div;
-        }
-    
-        unsigned int getNumLevels () const
-        {
-            return m_numLevels;
-        }
-	
-	    unsigned int getOffsetX ( const unsigned int& x, unsigned int l)
-        {
-            if ( l == getMaxLevel())
-                return x-m_xmin;
-            else
-                return (x-m_xmin)%getStepXofLevel(l+1);
-        }
-    
-        unsigned int getOffsetY ( unsigned int y, unsigned int l)
-        {
-            if ( l == getMaxLevel())
-                return y-m_ymin;
-            else
-                return (y-m_ymin)%getStepYofLevel(l+1);
-        }
-    
-        unsigned int getOnMask( unsigned int index)
-	    {
-	        return 1 << index;
-	    }
-	
-	    unsigned int getOffMask( unsigned int index)
-	    {
-            return ~getOnMask( index);
-        }
-	
-	    unsigned int getStepXofLevel(unsigned int l)
-        {
-            //std::cout << "Step X at level " << l << " is " << (m_xmax-m_xmin)/pow( (double)m_div, (double)m_numLevels-l) << std::endl;
-            return (m_xmax-m_xmin)/pow( (double)m_div, (double)m_numLevels-l);
-        }
-    
-        unsigned int getStepYofLevel(unsigned int l)
-        {
-            //std::cout << "Step Y at level " << l << " is " << (m_ymax-m_ymin)/pow( (double)m_div, (double)m_numLevels-l) << std::endl;
-            return (m_ymax-m_ymin)/pow( (double)m_div, (double)m_numLevels-l);
-        }
-        
-        void reset( unsigned int xmin, unsigned int xmax, unsigned int ymin, unsigned int ymax, unsigned int div, unsigned int l = 1)
-        {
-            m_xmin = xmin;
-            m_xmax = xmax + 1;
-            m_ymin = ymin;
-            m_ymax = ymax + 1;
-            m_div = div;
-            m_numLevels = l;
-        }
-	
-    private:
-        unsigned int m_xmin, m_xmax, m_ymin, m_ymax, m_div, m_numLevels;
-    };
-
-
-    MulticriteriaArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp):
+    /**
+     * @brief Constructor. Partitions the graph and computes the arc flags
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param timestamp An address containing a timestamp
+     * @param numCells The number of cells of the partition
+     */
+    MulticriteriaArc( GraphType& graph, unsigned int numCriteria, unsigned int* timestamp, unsigned int numCells = 16):
                     G(graph),
                     m_numCriteria(numCriteria),
-                    m_timestamp(timestamp)
+                    m_timestamp(timestamp),
+                    m_partitioner(graph, numCells)
     {
         partition();
         preprocess();
     }
 
-    void getBoundaryNodes( std::vector<NodeIterator>& boundary, const unsigned int& cell)
+    void getBoundaryNodes( std::vector< std::vector<NodeIterator> >& boundaries)
     {
         NodeIterator u, lastNode;
-        boundary.clear();
-        unsigned int sum = 0;
+        boundaries.assign( m_numCells, std::vector<NodeIterator>());
+        std::vector<unsigned int> sizes( m_numCells, 0);
         for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
         {
-            if( m_partition.getCell( u->x, u->y) != cell) continue;
-            sum++;
-            if( isBoundaryNodeInCell( u, cell)) boundary.push_back(u);
+            ++sizes[u->cell];
+            if( isBoundaryNode( u)) boundaries[u->cell].push_back(u);
+        }
+        for( unsigned int c = 0; c < m_numCells; ++c)
+        {
+            std::cout << "\tCell " << c << " has " << sizes[c] << " nodes and " << boundaries[c].size() << " boundary nodes\n";
         }
-        std::cout << "\thas " << sum << " nodes\n";
     }
 
-    Partition& getPartition()
+    PartitionerType<GraphType>& getPartitioner()
     {
-        return m_partition;
-    } 
+        return m_partitioner;
+    }
+
+    unsigned int getNumCells() const
+    {
+        return m_numCells;
+    }
 
     const unsigned int& getGeneratedLabels()
     {
@@ -400,17 +369,18 @@ public:
 		pq.clear();
 	}   
 
-    bool isBoundaryNodeInCell( typename GraphType::NodeIterator& u, const unsigned int& cell)
+    bool isBoundaryNode( const NodeIterator& u)
 	{
-		std::vector<NodeDescriptor> neighbors = getNeighbors( G, u);
-		for( unsigned int i = 0; i < neighbors.size(); ++i)
-		{
-            NodeIterator v = G.getNodeIterator( neighbors[i]);
-            //std::cout << "(" << v->x << "," << v->y << ") (" << u->x << "," << u->y << ")\n";
-            //assert( m_partition.getCell( v->x, v->y) == cell);
-			if ( m_partition.getCell( v->x, v->y) != cell )
-				return true;
-     	}
+        EdgeIterator e, lastEdge;
+        InEdgeIterator k, lastInEdge;
+        for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+        {
+            if( G.target(e)->cell != u->cell) return true;
+        }
+        for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+        {
+            if( G.source(k)->cell != u->cell) return true;
+        }
         return false;
 	}
 
@@ -425,7 +395,6 @@ public:
 		    u->labels.clear();
 		}
 		PriorityQueueType queue;
-        unsigned int onMask = m_partition.getOnMask( cell);
 
 		bool isDominated;
 
@@ -449,7 +418,7 @@ public:
 		        isDominated = false;
 		        v = G.source(k);
 
-                if( m_partition.getCell( v->x, v->y) == cell ) continue;
+                if( v->cell == cell ) continue;
 
 		        Label newLabel( label.getCriteriaList() + k->criteriaList, u->getDescriptor(), label.getPredecessor() );
 
@@ -491,8 +460,8 @@ public:
 		    {   
                 e = G.getEdgeIterator( G.getNodeDescriptor(u), (NodeDescriptor)it->getPredecessor());
                 k = G.getInEdgeIterator( e);
-                e->flags |= onMask;
-                k->flags |= onMask;
+                e->flags.set( cell);
+                k->flags.set( cell);
             }
             u->labels.clear();
         }
@@ -504,11 +473,11 @@ public:
             for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
 		    {
                 v = G.target(e);
-                if( m_partition.getCell( v->x, v->y) == cell )
+                if( v->cell == cell )
                 {
                     k = G.getInEdgeIterator( e);
-                    e->flags |= onMask;
-                    k->flags |= onMask;
+                    e->flags.set( cell);
+                    k->flags.set( cell);
                 }
             }
 		}
@@ -517,26 +486,7 @@ public:
 
     void partition()
     {
-        std::cout << "Partitioning graph...\n";
-        unsigned int xmax = 0, xmin = std::numeric_limits<unsigned int>::max(), ymax = 0, ymin = std::numeric_limits<unsigned int>::max();
-        NodeIterator u, v, last;
-        EdgeIterator e, lastEdge;
-        InEdgeIterator k;
-        for ( u = G.beginNodes(), last = G.endNodes(); u != last; ++u)
-        {
-            //for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
-            //{
-            //    k = G.getInEdgeIterator(e);
-                //e->flags &= 0;
-                //k->flags &= 0;
-            //}
-            if ( u->x > xmax) xmax = u->x;
-            if ( u->x < xmin) xmin = u->x;
-            if ( u->y > ymax) ymax = u->y;
-            if ( u->y < ymin) ymin = u->y;
-        }
-        m_partition.reset( xmin, xmax, ymin, ymax, 4);
-        
+        m_numCells = m_partitioner.run();
     }
 
 
@@ -545,13 +495,22 @@ public:
         NodeIterator u, v, lastNode;
         EdgeIterator e, lastEdge;
         std::cout << "Preprocessing Arc Flags...\n";
-        for( unsigned int c = 0; c < m_partition.getNumCells(); ++c)
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                assert( m_numCells <= e->flags.size());
+                e->flags.reset();
+                G.getInEdgeIterator(e)->flags.reset();
+            }
+        }
+
+        std::vector< std::vector< NodeIterator> > boundaries;
+        getBoundaryNodes( boundaries);
+        for( unsigned int c = 0; c < m_numCells; ++c)
         {
             std::cout << "Cell: " << c << "\n";
-            std::vector< NodeIterator> boundary;
-            getBoundaryNodes( boundary, c);
-            std::cout << "\thas " << boundary.size() << " boundary nodes\n";
-            openFlagsLeadingTo( boundary, c);
+            openFlagsLeadingTo( boundaries[c], c);
         }
 
         std::ofstream out("arc-flags");
@@ -571,7 +530,7 @@ public:
 		NodeIterator u,v,lastNode;
 		EdgeIterator e,lastEdge;
 
-        unsigned int mask = m_partition.getOnMask( m_partition.getCell( t->x, t->y));
+        unsigned int targetCell = t->cell;
 
 		bool isDominated;
 
@@ -586,7 +545,7 @@ public:
 
 		    for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
 		    {
-                if( ! (e->flags & mask)) continue;
+                if( !e->flags.test( targetCell)) continue;
 
 		        isDominated = false;
 		        v = G.target(e);
@@ -628,7 +587,8 @@ private:
     unsigned int m_generatedLabels;
 	unsigned int m_numCriteria;
 	unsigned int* m_timestamp;
-    Partition m_partition;
+    PartitionerType<GraphType> m_partitioner;
+    unsigned int m_numCells;
 };
 
 
@@ -2,6 +2,11 @@
 #define MULTICRITERIADIJKSTRA_H
 
 #include <Structs/Trees/priorityQueue.h>
+#include <Algorithms/ShortestPath/Multicriteria/queryStats.h>
+#include <climits>
+#include <cmath>
+#include <limits>
+
 class CriteriaList
 {
 public:
@@ -78,6 +83,11 @@ public:
         return other.dominates(*this);
     }
 
+    unsigned int size() const
+    {
+        return m_criteria.size();
+    }
+
     WeightType& operator [] ( unsigned int pos)
     {
         assert ( pos < m_criteria.size());
@@ -86,6 +96,12 @@ public:
         return *it;
     }
 
+    const WeightType& operator [] ( unsigned int pos) const
+    {
+        assert ( pos < m_criteria.size());
+        return m_criteria[pos];
+    }
+
     bool operator < (const CriteriaList& other) const
     {
         assert( m_criteria.size() == other.m_criteria.size());
@@ -289,7 +305,157 @@ private:
     extra_info m_data;
 };
 
-template<class GraphType>
+/**
+ * @brief Settings and bookkeeping of an approximate Pareto query
+ *
+ * Each criterion is split into a logarithmic grid with base 1 + epsilon, where zero has a cell of
+ * its own below all others, so two values in the same cell differ by less than a factor 1 + epsilon.
+ * A label is pruned when a label of the target lies in the same or a lower grid cell on every
+ * criterion, i.e. when the target label epsilon-dominates the label. The label budget caps the
+ * number of labels generated by a query, which stops as soon as it is exhausted.
+ *
+ * Every pruned label and, after an early stop, every label left in the queue is covered by some
+ * target label. The achieved factor is the largest ratio between a covering target label and the
+ * label it covers, over all criteria. Every Pareto optimal path is approximated by a returned
+ * path within this factor, which is at most 1 + epsilon unless the budget was exhausted.
+ *
+ * With the default values the query is exact.
+ */
+class ParetoApproximation
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param epsilon The precision of the approximation. Zero for exact dominance
+     * @param labelBudget The maximum number of labels a query may generate
+     */
+    ParetoApproximation( double epsilon = 0, unsigned int labelBudget = UINT_MAX):
+                                    m_epsilon( epsilon > 0 ? epsilon : 0),
+                                    m_logBase( std::log( 1 + m_epsilon)),
+                                    m_labelBudget( labelBudget),
+                                    m_achievedFactor(1)
+    {
+    }
+
+    bool isExact() const
+    {
+        return m_epsilon == 0 && m_labelBudget == UINT_MAX;
+    }
+
+    double getEpsilon() const
+    {
+        return m_epsilon;
+    }
+
+    unsigned int getLabelBudget() const
+    {
+        return m_labelBudget;
+    }
+
+    double getAchievedFactor() const
+    {
+        return m_achievedFactor;
+    }
+
+    void reset()
+    {
+        m_achievedFactor = 1;
+    }
+
+    /**
+     * @brief Checks if a label makes another one redundant
+     *
+     * @param covering The criteria of the covering label
+     * @param covered The criteria of the label that may be pruned
+     * @return True if the covering label epsilon-dominates the other one
+     */
+    bool covers( const CriteriaList& covering, const CriteriaList& covered) const
+    {
+        if( m_epsilon == 0) return covering.dominates( covered);
+        for( unsigned int i = 0; i < covering.size(); ++i)
+        {
+            if( getCell( covering[i]) > getCell( covered[i])) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the largest ratio of a criterion of the covering label to the same criterion of the covered one
+     */
+    static double getRatio( const CriteriaList& covering, const CriteriaList& covered)
+    {
+        double ratio = 1;
+        for( unsigned int i = 0; i < covering.size(); ++i)
+        {
+            if( covering[i] <= covered[i]) continue;
+            if( covered[i] == 0) return std::numeric_limits<double>::infinity();
+            ratio = std::max( ratio, (double)covering[i] / covered[i]);
+        }
+        return ratio;
+    }
+
+    /**
+     * @brief Records that a label was pruned, or left unexplored, with the given covering ratio
+     */
+    void recordCover( double ratio)
+    {
+        if( ratio > m_achievedFactor) m_achievedFactor = ratio;
+    }
+
+private:
+    double m_epsilon, m_logBase;
+    unsigned int m_labelBudget;
+    double m_achievedFactor;
+
+    unsigned int getCell( CriteriaList::WeightType weight) const
+    {
+        if( weight == 0) return 0;
+        return 1 + (unsigned int)( std::log( (double)weight) / m_logBase);
+    }
+};
+
+/**
+ * @brief Checks if a label is covered by a label of a node, and records the ratio if it is
+ *
+ * @return True if some label of the node covers the criteria
+ */
+template<class NodeIterator>
+bool isCoveredByNodeLabels( ParetoApproximation& approximation, const NodeIterator& t, const CriteriaList& criteria)
+{
+    double best = std::numeric_limits<double>::infinity();
+    for ( std::vector<Label>::iterator it = t->labels.begin(); it != t->labels.end(); ++it)
+    {
+        if ( approximation.covers( it->getCriteriaList(), criteria))
+        {
+            best = std::min( best, ParetoApproximation::getRatio( it->getCriteriaList(), criteria));
+        }
+    }
+    if( best == std::numeric_limits<double>::infinity()) return false;
+    approximation.recordCover( best);
+    return true;
+}
+
+/**
+ * @brief Records the ratio by which the best label of a node covers a label left unexplored
+ */
+template<class NodeIterator>
+void recordUnexplored( ParetoApproximation& approximation, const NodeIterator& t, const CriteriaList& criteria)
+{
+    double best = std::numeric_limits<double>::infinity();
+    for ( std::vector<Label>::iterator it = t->labels.begin(); it != t->labels.end(); ++it)
+    {
+        best = std::min( best, ParetoApproximation::getRatio( it->getCriteriaList(), criteria));
+    }
+    approximation.recordCover( best);
+}
+
+/**
+ * @brief Multicriteria label correcting search from a source node
+ *
+ * The StatsType policy collects per-query statistics, see NoQueryStats and MulticriteriaQueryStats.
+ */
+template<class GraphType, class StatsType = NoQueryStats>
 class MulticriteriaDijkstra
 {
 public:
@@ -323,26 +489,44 @@ public:
 	}
 
     /**
-     * @brief Builds a shortest path tree routed on a source node
+     * @brief Computes the Pareto optimal labels of all nodes, or approximates the ones of a target node
      *
      * @param s The source node
+     * @param t The target node. It is only used by approximate queries
+     * @param approximation The approximation settings. Exact by default
      */
-    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t, const ParetoApproximation& approximation = ParetoApproximation())
     {
 		node u,v,lastNode;
 		edge e,lastEdge;
 
 		bool isDominated;
+        m_approximation = approximation;
+        m_approximation.reset();
+        bool isExact = m_approximation.isExact();
 
         m_generatedLabels = 1;
+        m_stats.startSearch();
 		pq.insert( Label( CriteriaList(m_numCriteria), 0, 0), s);
 
 		while( !pq.empty())
 		{
+            if( m_generatedLabels >= m_approximation.getLabelBudget())
+            {
+                stopEarly(t);
+                break;
+            }
+
 		    Label label = pq.min().key;
 		    u = pq.minItem();
 		    pq.popMin();
 
+            if( !isExact && isCoveredByNodeLabels( m_approximation, t, label.getCriteriaList()))
+            {
+                m_stats.prunedByTarget();
+                continue;
+            }
+
 		    //std::cout << "extracting " << u->id << " with label ";
 		    //label.print(std::cout, G);
 		    //std::cout << std::endl; 
@@ -361,13 +545,23 @@ public:
 		                break;
 		            }
 		        }
-		        if ( isDominated )  continue;
+		        if ( isDominated )
+                {
+                    m_stats.prunedByNode();
+                    continue;
+                }
+                if ( !isExact && isCoveredByNodeLabels( m_approximation, t, newLabel.getCriteriaList()))
+                {
+                    m_stats.prunedByTarget();
+                    continue;
+                }
 
 		        //std::cout << "push into queue " << v->id << " with label ";
 		        //newLabel.print(std::cout, G);
 		        //std::cout << std::endl;
                 ++m_generatedLabels;
 		        pq.insert( newLabel, v);
+                m_stats.observeQueue( pq.size());
 
 		        std::vector<Label>::iterator it = v->labels.begin();
 		        while ( it != v->labels.end() )
@@ -387,14 +581,32 @@ public:
 		        //std::cout << std::endl;
 
 		        v->labels.push_back( newLabel );
+                m_stats.observeLabels( v->labels.size());
 		    }
 		}
+        m_stats.stopSearch( m_generatedLabels, ( t != G.endNodes()) ? t->labels.size() : 0);
     }
 
     const unsigned int& getGeneratedLabels()
     {
         return m_generatedLabels;
     }
+
+    /**
+     * @brief Returns the approximation factor achieved by the last query
+     */
+    double getAchievedFactor() const
+    {
+        return m_approximation.getAchievedFactor();
+    }
+
+    /**
+     * @brief Returns the statistics policy, which holds the record of the last query
+     */
+    StatsType& getStats()
+    {
+        return m_stats;
+    }
     
     /**
      * @brief Runs a shortest path query between a source node s and a target node t
@@ -414,6 +626,17 @@ private:
     unsigned int m_generatedLabels;
 	unsigned int m_numCriteria;
     unsigned int* m_timestamp;
+    ParetoApproximation m_approximation;
+    StatsType m_stats;
+
+    void stopEarly( const node& t)
+    {
+        while( !pq.empty())
+        {
+            recordUnexplored( m_approximation, t, pq.minKey().getCriteriaList());
+            pq.popMin();
+        }
+    }
 };
 
 
@@ -4,6 +4,8 @@
 #include <Structs/Trees/priorityQueue.h>
 #include <Utilities/geographic.h>
 #include <Algorithms/ShortestPath/dijkstra.h>
+#include <Algorithms/ShortestPath/Multicriteria/targetTreeCache.h>
+#include <Algorithms/ShortestPath/Multicriteria/queryStats.h>
 
 template<class GraphType>
 class GreatCircleHeuristic
@@ -72,255 +74,145 @@ private:
 };
 
 
+/**
+ * @brief Sets the heuristic of every node but the target to unreachable, for graphs without edges
+ */
+template<class GraphType>
+void setUnreachable( GraphType& G, const typename GraphType::NodeIterator& t)
+{
+    typename GraphType::NodeIterator u, lastNode;
+    for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+    {
+        for( unsigned int c = 0; c < u->heuristicList.size(); ++c)
+        {
+            u->heuristicList[c] = ( u == t) ? 0 : TargetTreeCache<GraphType>::EMPTY;
+        }
+    }
+}
+
+
+/**
+ * @brief Heuristic with the exact distance of every node to the target for each criterion
+ *
+ * The backward trees are kept in a cache keyed by target, so queries towards a target that
+ * was seen recently do not rebuild them.
+ */
 template<class GraphType>
 class TCHeuristic
 {
 public:
     
     typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
 	typedef typename GraphType::EdgeIterator    EdgeIterator;
 	typedef typename GraphType::InEdgeIterator  InEdgeIterator;
-	typedef PriorityQueue< unsigned int, NodeIterator, HeapStorage>   PriorityQueueType;
+	typedef TargetTreeCache<GraphType>          CacheType;
 	
-    TCHeuristic( GraphType& graph):G(graph)
+    TCHeuristic( GraphType& graph, unsigned int cacheCapacity = 8):G(graph),m_cache(graph, cacheCapacity)
     {
-        m_timestamp = new unsigned int();
-        *m_timestamp = 0;
     } 
-    
-    ~TCHeuristic()
-    {
-        delete m_timestamp;
-    }
 
     void init( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
     {
-        NodeIterator u,v,lastNode;
-        *m_timestamp = 1;
-        unsigned int EMPTY_HEURISTIC = std::numeric_limits<unsigned int>::max();
-        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        const typename CacheType::Trees& trees = m_cache.getTrees(t);
+        const std::vector<NodeDescriptor>& nodes = m_cache.getNodes();
+        unsigned int numCriteria = m_cache.getNumCriteria();
+
+        if( numCriteria == 0)
+        {
+            setUnreachable( G, t);
+            return;
+        }
+
+        for( unsigned int i = 0; i < nodes.size(); ++i)
 		{
-			u->heuristicList[0] = EMPTY_HEURISTIC;
-			u->heuristicList[1] = EMPTY_HEURISTIC;	
-            u->timestamp = 0;
+            NodeIterator u = G.getNodeIterator( nodes[i]);
+            for( unsigned int c = 0; c < numCriteria; ++c)
+            {
+			    u->heuristicList[c] = trees.distance[c][i];
+            }
 		}
-        buildTree(t,0);
-        *m_timestamp = 2;
-        buildTree(t,1);
     }
 
-    void buildTree( const typename GraphType::NodeIterator& t, unsigned int criterionIndex)
+    CacheType& getCache()
     {
-        NodeIterator u,v,lastNode;
-        InEdgeIterator k,lastInEdge;
-        
-        pq.clear();
-        ++(*m_timestamp);
-        t->heuristicList[criterionIndex] = 0;
-        t->timestamp = (*m_timestamp);
-        t->succ = G.nilNodeDescriptor();;
-
-        pq.insert( t->heuristicList[criterionIndex], t, &(t->pqitem));
-
-        while( !pq.empty())
-        {
-            u = pq.minItem();
-            pq.popMin();
-            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
-            {
-                v = G.source(k);
-
-                if( v->timestamp < (*m_timestamp))
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList[criterionIndex] = u->heuristicList[criterionIndex] + k->criteriaList[criterionIndex];
-                    v->timestamp = (*m_timestamp);
-                    pq.insert( v->heuristicList[criterionIndex], v, &(v->pqitem));
-                }
-                else if( v->heuristicList[criterionIndex] > u->heuristicList[criterionIndex] + k->criteriaList[criterionIndex] )
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList[criterionIndex] = u->heuristicList[criterionIndex] + k->criteriaList[criterionIndex];
-                    pq.decrease( v->heuristicList[criterionIndex], &(v->pqitem));
-                }
-            }
-        }
-    }    
+        return m_cache;
+    }
     
 private:
     GraphType& G;
-    PriorityQueueType pq;
-    PriorityQueueType secondary_pq;
-    unsigned int* m_timestamp;
+    CacheType m_cache;
 };
 
 
 
+/**
+ * @brief Heuristic with the exact distance of every node to the target for each of two criteria,
+ * restricted to the nodes that can lie on a Pareto optimal path
+ *
+ * The bound for each criterion is its value on the shortest path from the source with respect to
+ * the other criterion. Nodes whose distance exceeds a bound get an empty heuristic. The backward
+ * trees are cached per target, so only the bounds depend on the source.
+ */
 template<class GraphType>
 class BoundedTCHeuristic
 {
 public:
     
     typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
 	typedef typename GraphType::EdgeIterator    EdgeIterator;
 	typedef typename GraphType::InEdgeIterator  InEdgeIterator;
-	typedef PriorityQueue< unsigned int, NodeIterator, HeapStorage>   PriorityQueueType;
+	typedef TargetTreeCache<GraphType>          CacheType;
 	
-    BoundedTCHeuristic( GraphType& graph):G(graph)
+    BoundedTCHeuristic( GraphType& graph, unsigned int cacheCapacity = 8):G(graph),m_cache(graph, cacheCapacity)
     {
-        m_timestamp = new unsigned int();
-        *m_timestamp = 0;
     } 
-    
-    ~BoundedTCHeuristic()
-    {
-        delete m_timestamp;
-    }
-     
-    
-    void buildTree( const typename GraphType::NodeIterator& t, unsigned int bound)
-    {
-        NodeIterator u,v,lastNode;
-        InEdgeIterator k,lastInEdge;
-        
-        secondary_pq.clear();
-        t->heuristicList[1] = 0;
-        t->marked = true;
-        t->succ = G.nilNodeDescriptor();;
-        t->dist = 0;
-        secondary_pq.insert( t->heuristicList[1], t, &(t->secondary_pqitem));
-
-        while( !secondary_pq.empty())
-        {
-            if( secondary_pq.minKey() > bound) break;
-            u = secondary_pq.minItem();
-            secondary_pq.popMin();
-            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
-            {
-                v = G.source(k);
-
-                if( !v->marked)
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList[1] = u->heuristicList[1] + k->criteriaList[1];
-                    v->dist = u->dist + k->criteriaList[0];
-                    v->marked = true;
-                    secondary_pq.insert( v->heuristicList[1], v, &(v->secondary_pqitem));
-                }
-                else if( v->heuristicList[1] > u->heuristicList[1] + k->criteriaList[1] )
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList[1] = u->heuristicList[1] + k->criteriaList[1];
-                    v->dist = u->dist + k->criteriaList[0];
-                    secondary_pq.decrease( v->heuristicList[1], &(v->secondary_pqitem));
-                }
-            }
-        }
-    }    
 
-    void buildSingleTree( const typename GraphType::NodeIterator& t, unsigned int criterionIndex, unsigned int bound)
+    void init( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
     {
-        NodeIterator u,v,lastNode;
-        InEdgeIterator k,lastInEdge;
-        
-        while( !pq.empty())
-        {
-            if( pq.minKey() > bound) break;
-            u = pq.minItem();
-            pq.popMin();
-            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
-            {
-                v = G.source(k);
+        const typename CacheType::Trees& trees = m_cache.getTrees(t);
+        const std::vector<NodeDescriptor>& nodes = m_cache.getNodes();
+        unsigned int source = m_cache.getIndex(s);
 
-                if( v->timestamp < (*m_timestamp))
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList[criterionIndex] = u->heuristicList[criterionIndex] + k->criteriaList[criterionIndex];
-                    v->timestamp = (*m_timestamp);
-                    pq.insert( v->heuristicList[criterionIndex], v, &(v->pqitem));
-                }
-                else if( v->heuristicList[criterionIndex] > u->heuristicList[criterionIndex] + k->criteriaList[criterionIndex] )
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList[criterionIndex] = u->heuristicList[criterionIndex] + k->criteriaList[criterionIndex];
-                    pq.decrease( v->heuristicList[criterionIndex], &(v->pqitem));
-                }
-            }
+        if( m_cache.getNumCriteria() == 0)
+        {
+            setUnreachable( G, t);
+            return;
         }
-    }   
 
-    void init( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
-    {
-        NodeIterator u,v,lastNode;
-        *m_timestamp = 1;
-        unsigned int EMPTY_HEURISTIC = std::numeric_limits<unsigned int>::max();
-        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        assert( m_cache.getNumCriteria() == 2);
+        unsigned int bound0 = trees.secondary[1][source];
+        unsigned int bound1 = trees.secondary[0][source];
+
+        for( unsigned int i = 0; i < nodes.size(); ++i)
 		{
-			u->heuristicList[0] = EMPTY_HEURISTIC;
-			u->heuristicList[1] = EMPTY_HEURISTIC;	
-            u->timestamp = 0;
-            u->marked = false;
+            NodeIterator u = G.getNodeIterator( nodes[i]);
+            unsigned int h0 = trees.distance[0][i];
+            unsigned int h1 = trees.distance[1][i];
+			u->heuristicList[0] = ( h0 <= bound0) ? h0 : CacheType::EMPTY;
+			u->heuristicList[1] = ( h1 <= bound1) ? h1 : CacheType::EMPTY;
 		}
-
-        runQuery( s, t, 0);
-        unsigned int bound1 = s->heuristicList[1];
-
-        buildTree(t,bound1);
-
-        unsigned int bound0 = s->dist;
-        buildSingleTree(t,0,bound0);
-        
     }
 
-    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t, unsigned int criterionIndex)
+    CacheType& getCache()
     {
-        NodeIterator u,v,lastNode;
-        InEdgeIterator k,lastInEdge;
-        
-        pq.clear();
-        ++(*m_timestamp);
-        t->heuristicList[criterionIndex] = 0;
-        t->timestamp = (*m_timestamp);
-        t->succ = G.nilNodeDescriptor();;
-
-        pq.insert( t->heuristicList[criterionIndex], t, &(t->pqitem));
-
-        while( !pq.empty())
-        {
-            u = pq.minItem();
-            if( u == s) break;
-
-            pq.popMin();
-            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
-            {
-                v = G.source(k);
-
-                if( v->timestamp < (*m_timestamp))
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList = u->heuristicList + k->criteriaList;
-                    v->timestamp = (*m_timestamp);
-                    pq.insert( v->heuristicList[criterionIndex], v, &(v->pqitem));
-                }
-                else if( v->heuristicList[criterionIndex] > u->heuristicList[criterionIndex] + k->criteriaList[criterionIndex] )
-                {
-                    v->succ = u->getDescriptor();
-                    v->heuristicList = u->heuristicList + k->criteriaList;
-                    pq.decrease( v->heuristicList[criterionIndex], &(v->pqitem));
-                }
-            }
-        }
-    } 
+        return m_cache;
+    }
     
 private:
     GraphType& G;
-    PriorityQueueType pq;
-    PriorityQueueType secondary_pq;
-    unsigned int* m_timestamp;
+    CacheType m_cache;
 };
 
 
-template<class GraphType, template <typename graphType> class HeuristicType>
+/**
+ * @brief NAMOA* multicriteria search towards a target node
+ *
+ * The StatsType policy collects per-query statistics. NoQueryStats collects nothing and adds no
+ * overhead, MulticriteriaQueryStats records a query record that can be exported as CSV or JSON.
+ */
+template<class GraphType, template <typename graphType> class HeuristicType, class StatsType = NoQueryStats>
 class NamoaStarDijkstra
 {
 public:
@@ -349,24 +241,31 @@ public:
 		{
 		    u->labels.clear();
 		}
+        m_stats.startHeuristic();
         m_heuristicEngine.init(s,t);
+        m_stats.stopHeuristic();
 		pq.clear();
 	}
 
     /**
-     * @brief Builds a shortest path tree routed on a source node
+     * @brief Computes the Pareto optimal labels of a target node
      *
      * @param s The source node
+     * @param t The target node
+     * @param approximation The approximation settings. Exact by default
      */
-    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t)
+    void runQuery( const typename GraphType::NodeIterator& s, const typename GraphType::NodeIterator& t, const ParetoApproximation& approximation = ParetoApproximation())
     {
 		NodeIterator u,v,lastNode;
 		EdgeIterator e,lastEdge;
 
         m_generatedLabels = 1;
 		assert( hasFeasiblePotentials(t));
+        m_stats.startSearch();
 		++(*m_timestamp);
-		
+        m_approximation = approximation;
+        m_approximation.reset();
+        bool isExact = m_approximation.isExact();
 
 		unsigned int* pqitem = new unsigned int();
 		s->labels.push_back(Label( CriteriaList(m_numCriteria), 0, pqitem));
@@ -374,6 +273,12 @@ public:
 
 		while( !pq.empty())
 		{
+            if( m_generatedLabels >= m_approximation.getLabelBudget())
+            {
+                stopEarly(t);
+                break;
+            }
+
 		    CriteriaList minCriteria = pq.min().key;
 		    u = pq.minItem();
 		    pq.popMin();
@@ -387,7 +292,11 @@ public:
 			
 			moveToClosed( g_u, u);
 
-			if ( isDominatedByNodeLabels( t, minCriteria)) continue;
+			if ( isDominatedByNodeLabels( t, minCriteria) || ( !isExact && u != t && isCoveredByNodeLabels( m_approximation, t, minCriteria)))
+            {
+                m_stats.prunedByTarget();
+                continue;
+            }
 
 		    //std::cout << "extracting " << u->id << " with label ";
 		    //label.print(std::cout, G);
@@ -410,25 +319,53 @@ public:
 				{
 					v->labels.push_back( Label( g_v, u->getDescriptor(), 0) );
                     ++m_generatedLabels;
+                    m_stats.observeLabels( v->labels.size());
 				}
 				else	
 				{
-					if( isDominatedByNodeLabels( v, g_v)) continue;
+					if( isDominatedByNodeLabels( v, g_v))
+                    {
+                        m_stats.prunedByNode();
+                        continue;
+                    }
 					eraseDominatedLabels( G, v, g_v);
-					if( isDominatedByNodeLabels(t, heuristicCost)) continue;
+					if( isDominatedByNodeLabels(t, heuristicCost) || ( !isExact && isCoveredByNodeLabels( m_approximation, t, heuristicCost)))
+                    {
+                        m_stats.prunedByTarget();
+                        continue;
+                    }
 					unsigned int* pqitem = new unsigned int();
 					v->labels.push_back( Label( g_v, u->getDescriptor(), pqitem) );
 				    ++m_generatedLabels;
 					pq.insert( heuristicCost, v, pqitem);
+                    m_stats.observeLabels( v->labels.size());
+                    m_stats.observeQueue( pq.size());
 				}
 		    }
 		}
+        m_stats.stopSearch( m_generatedLabels, t->labels.size());
     }
 
     const unsigned int& getGeneratedLabels()
     {
         return m_generatedLabels;
     }
+
+    /**
+     * @brief Returns the approximation factor achieved by the last query
+     */
+    double getAchievedFactor() const
+    {
+        return m_approximation.getAchievedFactor();
+    }
+
+    /**
+     * @brief Returns the statistics policy, which holds the record of the last query
+     */
+    StatsType& getStats()
+    {
+        return m_stats;
+    }
     
     /**
      * @brief Runs a shortest path query between a source node s and a target node t
@@ -449,6 +386,20 @@ private:
 	unsigned int m_numCriteria;
 	unsigned int* m_timestamp;
     HeuristicType<GraphType> m_heuristicEngine;
+    ParetoApproximation m_approximation;
+    StatsType m_stats;
+
+    void stopEarly( const NodeIterator& t)
+    {
+        while( !pq.empty())
+        {
+            CriteriaList minCriteria = pq.min().key;
+            NodeIterator u = pq.minItem();
+            pq.popMin();
+            moveToClosed( minCriteria - u->heuristicList, u);
+            recordUnexplored( m_approximation, t, minCriteria);
+        }
+    }
 
 	bool distanceExistsInNode( const NodeIterator& v, const CriteriaList& g_v)
 	{
@@ -0,0 +1,331 @@
+#ifndef PARALLELPARETOSEARCH_H
+#define PARALLELPARETOSEARCH_H
+
+#include <Algorithms/ShortestPath/Multicriteria/multicriteriaDijkstra.h>
+#include <Algorithms/ShortestPath/Multicriteria/namoaStar.h>
+#include <Utilities/parallel.h>
+#include <algorithm>
+
+/**
+ * @brief Multicriteria label setting search that expands batches of labels in parallel
+ *
+ * The labels in the queue whose keys are Pareto minimal among all keys in the queue can not be
+ * dominated by any label that is still to be found, so they can be expanded concurrently.
+ * Each round pops such a batch from the lexicographically ordered queue, expands it with one
+ * label buffer per thread and merges the buffers back into the label sets of the nodes with a
+ * dominance filter, in parallel over the target nodes.
+ *
+ * With a consistent heuristic and a target node it computes the same Pareto set as
+ * NamoaStarDijkstra. With BlindHeuristic and G.endNodes() as target it computes the Pareto sets
+ * of all nodes, like MulticriteriaDijkstra. Nodes need the fields labels and heuristicList.
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType, template <typename graphType> class HeuristicType = BlindHeuristic>
+class ParallelParetoSearch
+{
+public:
+	typedef typename GraphType::NodeIterator    NodeIterator;
+	typedef typename GraphType::NodeDescriptor  NodeDescriptor;
+	typedef typename GraphType::EdgeIterator    EdgeIterator;
+	typedef typename GraphType::SizeType        SizeType;
+
+	typedef PriorityQueue< CriteriaList, NodeIterator, HeapStorage> PriorityQueueType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on
+     * @param numCriteria The number of criteria
+     * @param maxBatchSize The maximum number of labels expanded in one round
+     */
+    ParallelParetoSearch( GraphType& graph, unsigned int numCriteria, unsigned int maxBatchSize = 1024):
+                                    G(graph),
+                                    m_numCriteria(numCriteria),
+                                    m_maxBatchSize(maxBatchSize),
+                                    m_heuristicEngine(graph)
+    {
+    }
+
+	void init( const NodeIterator& s, const NodeIterator& t)
+	{
+		NodeIterator u, lastNode;
+		for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+		{
+		    u->labels.clear();
+		}
+        m_heuristicEngine.init(s,t);
+		pq.clear();
+	}
+
+    /**
+     * @brief Computes the Pareto optimal labels of a target node, or of all nodes
+     *
+     * @param s The source node
+     * @param t The target node, or G.endNodes() for the labels of all nodes
+     */
+    void runQuery( const NodeIterator& s, const NodeIterator& t)
+    {
+        m_target = t;
+        m_hasTarget = ( t != G.endNodes());
+        m_generatedLabels = 1;
+        m_rounds = 0;
+
+        unsigned int numThreads = getNumThreads();
+        m_buffers.assign( numThreads, std::vector<Candidate>());
+        m_survivors.assign( numThreads, std::vector<Candidate>());
+
+        m_deferred.clear();
+        m_deferredHead = 0;
+
+        s->labels.push_back( Label( CriteriaList(m_numCriteria), 0, 0));
+        pq.insert( CriteriaList(m_numCriteria) + s->heuristicList, s);
+
+        std::vector<Candidate> batch;
+        std::vector<Candidate> candidates;
+        while( !pq.empty() || m_deferredHead < m_deferred.size())
+        {
+            extractBatch( batch);
+            if( batch.empty()) continue;
+            ++m_rounds;
+
+            #pragma omp parallel for schedule(dynamic, 16)
+            for( long i = 0; i < (long)batch.size(); ++i)
+            {
+                expand( batch[i], m_buffers[getThreadIndex()]);
+            }
+
+            candidates.clear();
+            for( unsigned int i = 0; i < numThreads; ++i)
+            {
+                candidates.insert( candidates.end(), m_buffers[i].begin(), m_buffers[i].end());
+                m_buffers[i].clear();
+            }
+            merge( candidates);
+        }
+    }
+
+    const unsigned int& getGeneratedLabels()
+    {
+        return m_generatedLabels;
+    }
+
+    /**
+     * @brief Returns the number of rounds of the last query. Each round expands one batch of labels
+     */
+    unsigned int getNumRounds() const
+    {
+        return m_rounds;
+    }
+
+private:
+
+    typedef std::pair< CriteriaList, NodeIterator> QueueEntry;
+
+    enum { MAX_CONSECUTIVE_DEFERRED = 64 };
+
+    struct Candidate
+    {
+        Candidate( const NodeIterator& node, const CriteriaList& distance, const CriteriaList& key, const NodeDescriptor& predecessor):
+                                    v(node),g(distance),f(key),pred(predecessor)
+        {
+        }
+
+        bool operator < ( const Candidate& other) const
+        {
+            if( &(*v) != &(*other.v)) return &(*v) < &(*other.v);
+            return g < other.g;
+        }
+
+        NodeIterator v;
+        CriteriaList g, f;
+        NodeDescriptor pred;
+    };
+
+    GraphType& G;
+    PriorityQueueType pq;
+    unsigned int m_numCriteria, m_maxBatchSize, m_generatedLabels, m_rounds;
+    HeuristicType<GraphType> m_heuristicEngine;
+    NodeIterator m_target;
+    bool m_hasTarget;
+    std::vector< std::vector<Candidate> > m_buffers, m_survivors;
+    std::vector<QueueEntry> m_deferred;
+    unsigned int m_deferredHead;
+
+    /**
+     * @brief Pops the labels whose keys are not dominated by the key of any other label in the queue
+     *
+     * The labels come from the queue and from a lexicographically sorted list of labels deferred by
+     * earlier rounds, whichever is smaller. Labels that are dominated by a label of the batch are
+     * deferred again, which keeps them out of the heap. Labels that are no longer in the label set
+     * of their node, labels of the target and labels that are dominated by a label of the target
+     * are dropped. The scan stops once many consecutive labels have been deferred.
+     */
+    void extractBatch( std::vector<Candidate>& batch)
+    {
+        std::vector<QueueEntry> deferred;
+        batch.clear();
+        unsigned int consecutive = 0;
+        CriteriaList::WeightType minSecond = std::numeric_limits<CriteriaList::WeightType>::max();
+
+        while( batch.size() < m_maxBatchSize && consecutive < MAX_CONSECUTIVE_DEFERRED)
+        {
+            bool fromQueue;
+            if( m_deferredHead < m_deferred.size())
+            {
+                fromQueue = !pq.empty() && pq.minKey() < m_deferred[m_deferredHead].first;
+            }
+            else if( !pq.empty())
+            {
+                fromQueue = true;
+            }
+            else break;
+
+            QueueEntry entry;
+            if( fromQueue)
+            {
+                entry = QueueEntry( pq.minKey(), pq.minItem());
+                pq.popMin();
+            }
+            else
+            {
+                entry = m_deferred[m_deferredHead++];
+            }
+            const CriteriaList& f = entry.first;
+            NodeIterator u = entry.second;
+
+            CriteriaList g = f - u->heuristicList;
+            if( !hasLabel( u, g)) continue;
+            // The labels of the target are final and need no expansion
+            if( m_hasTarget && ( u == m_target || isDominatedByNodeLabels( m_target, f))) continue;
+
+            // The keys come out in lexicographic order, so with two criteria a key is dominated by an
+            // earlier one exactly when its second criterion is not smaller than all earlier ones
+            bool isDominated = false;
+            if( m_numCriteria == 2)
+            {
+                isDominated = ( minSecond <= f[1]);
+            }
+            else
+            {
+                for( unsigned int i = 0; i < batch.size(); ++i)
+                {
+                    if( batch[i].f.dominates(f))
+                    {
+                        isDominated = true;
+                        break;
+                    }
+                }
+            }
+
+            if( isDominated)
+            {
+                deferred.push_back( entry);
+                ++consecutive;
+                continue;
+            }
+            consecutive = 0;
+            if( m_numCriteria == 2) minSecond = f[1];
+            batch.push_back( Candidate( u, g, f, u->getDescriptor()));
+        }
+
+        // Everything deferred now precedes the labels that were not scanned
+        deferred.insert( deferred.end(), m_deferred.begin() + m_deferredHead, m_deferred.end());
+        m_deferred.swap( deferred);
+        m_deferredHead = 0;
+    }
+
+    void expand( const Candidate& label, std::vector<Candidate>& buffer)
+    {
+        EdgeIterator e, lastEdge;
+        NodeIterator u = label.v;
+        for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+        {
+            NodeIterator v = G.target(e);
+            CriteriaList g_v = label.g + e->criteriaList;
+            if( isDominatedByNodeLabels( v, g_v)) continue;
+            CriteriaList f_v = g_v + v->heuristicList;
+            if( m_hasTarget && isDominatedByNodeLabels( m_target, f_v)) continue;
+            buffer.push_back( Candidate( v, g_v, f_v, u->getDescriptor()));
+        }
+    }
+
+    /**
+     * @brief Inserts the candidates that survive the dominance filter into the label sets and the queue
+     *
+     * The candidates are grouped by node and every group is handled by a single thread.
+     */
+    void merge( std::vector<Candidate>& candidates)
+    {
+        if( candidates.empty()) return;
+        std::sort( candidates.begin(), candidates.end());
+
+        std::vector<unsigned int> groups;
+        for( unsigned int i = 0; i < candidates.size(); ++i)
+        {
+            if( i == 0 || candidates[i].v != candidates[i-1].v) groups.push_back(i);
+        }
+        groups.push_back( candidates.size());
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for( long i = 0; i < (long)groups.size() - 1; ++i)
+        {
+            std::vector<Candidate>& survivors = m_survivors[getThreadIndex()];
+            for( unsigned int j = groups[i]; j < groups[i+1]; ++j)
+            {
+                const Candidate& candidate = candidates[j];
+                NodeIterator v = candidate.v;
+                if( isDominatedByNodeLabels( v, candidate.g)) continue;
+
+                std::vector<Label>::iterator it = v->labels.begin();
+                while ( it != v->labels.end() )
+                {
+                    if ( it->getCriteriaList().isDominatedBy( candidate.g) )
+                    {
+                        it = v->labels.erase( it );
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+                v->labels.push_back( Label( candidate.g, candidate.pred, 0));
+                survivors.push_back( candidate);
+            }
+        }
+
+        for( unsigned int i = 0; i < m_survivors.size(); ++i)
+        {
+            for( unsigned int j = 0; j < m_survivors[i].size(); ++j)
+            {
+                pq.insert( m_survivors[i][j].f, m_survivors[i][j].v);
+            }
+            m_generatedLabels += m_survivors[i].size();
+            m_survivors[i].clear();
+        }
+    }
+
+    bool hasLabel( const NodeIterator& u, const CriteriaList& g)
+    {
+		for ( std::vector<Label>::iterator it = u->labels.begin(); it != u->labels.end(); ++it)
+		{
+			if ( it->getCriteriaList() == g) return true;
+		}
+		return false;
+    }
+
+	bool isDominatedByNodeLabels( const NodeIterator& v, const CriteriaList& g_v)
+	{
+		for ( std::vector<Label>::iterator it = v->labels.begin(); it != v->labels.end(); ++it)
+		{
+			if ( it->getCriteriaList().dominates(g_v) )
+		    {
+				return true;
+		    }
+		}
+		return false;
+	}
+};
+
+#endif //PARALLELPARETOSEARCH_H
@@ -0,0 +1,181 @@
+#ifndef QUERYSTATS_H
+#define QUERYSTATS_H
+
+#include <Utilities/timer.h>
+#include <algorithm>
+#include <ostream>
+
+/**
+ * @brief Statistics policy that collects nothing
+ *
+ * Every hook is an empty inline function, so a search instantiated with this policy compiles
+ * to the same code as a search without instrumentation.
+ */
+class NoQueryStats
+{
+public:
+    void startHeuristic() {}
+    void stopHeuristic() {}
+    void startSearch() {}
+    void stopSearch( unsigned int generatedLabels, unsigned int targetLabels) {}
+    void prunedByNode() {}
+    void prunedByTarget() {}
+    void observeLabels( unsigned int numLabels) {}
+    void observeQueue( unsigned int queueSize) {}
+};
+
+
+/**
+ * @brief Statistics policy that records one record per multicriteria query
+ *
+ * The record of the last query can be written as a CSV line or as a JSON object, so that
+ * pathological queries can be found in the logs. Times are in milliseconds.
+ *
+ * @author Panos Michail
+ *
+ */
+class MulticriteriaQueryStats
+{
+public:
+
+    struct Record
+    {
+        Record():query(0),generatedLabels(0),targetLabels(0),prunedByNode(0),prunedByTarget(0),maxLabelsPerNode(0),maxQueueSize(0),heuristicTime(0),searchTime(0)
+        {
+        }
+
+        unsigned int query;
+        unsigned int generatedLabels;
+        unsigned int targetLabels;
+        unsigned int prunedByNode;
+        unsigned int prunedByTarget;
+        unsigned int maxLabelsPerNode;
+        unsigned int maxQueueSize;
+        double heuristicTime;
+        double searchTime;
+    };
+
+    MulticriteriaQueryStats():m_numQueries(0)
+    {
+    }
+
+    /**
+     * @brief Starts a new record and the timer of the heuristic construction
+     */
+    void startHeuristic()
+    {
+        m_record = Record();
+        m_record.query = m_numQueries;
+        m_timer.start();
+    }
+
+    void stopHeuristic()
+    {
+        m_timer.stop();
+        m_record.heuristicTime = m_timer.getElapsedTimeInMilliSec();
+    }
+
+    /**
+     * @brief Starts the timer of the search. The counters of the search are reset, the heuristic time is kept
+     */
+    void startSearch()
+    {
+        double heuristicTime = m_record.heuristicTime;
+        m_record = Record();
+        m_record.query = m_numQueries;
+        m_record.heuristicTime = heuristicTime;
+        m_timer.start();
+    }
+
+    /**
+     * @brief Completes the record of the query
+     *
+     * @param generatedLabels The number of labels generated by the search
+     * @param targetLabels The number of labels of the target node
+     */
+    void stopSearch( unsigned int generatedLabels, unsigned int targetLabels)
+    {
+        m_timer.stop();
+        m_record.searchTime = m_timer.getElapsedTimeInMilliSec();
+        m_record.generatedLabels = generatedLabels;
+        m_record.targetLabels = targetLabels;
+        ++m_numQueries;
+    }
+
+    void prunedByNode()
+    {
+        ++m_record.prunedByNode;
+    }
+
+    void prunedByTarget()
+    {
+        ++m_record.prunedByTarget;
+    }
+
+    void observeLabels( unsigned int numLabels)
+    {
+        m_record.maxLabelsPerNode = std::max( m_record.maxLabelsPerNode, numLabels);
+    }
+
+    void observeQueue( unsigned int queueSize)
+    {
+        m_record.maxQueueSize = std::max( m_record.maxQueueSize, queueSize);
+    }
+
+    const Record& getRecord() const
+    {
+        return m_record;
+    }
+
+    unsigned int getNumQueries() const
+    {
+        return m_numQueries;
+    }
+
+    /**
+     * @brief Writes the column names of the CSV lines
+     */
+    static void writeCSVHeader( std::ostream& out)
+    {
+        out << "query,generatedLabels,targetLabels,prunedByNode,prunedByTarget,maxLabelsPerNode,maxQueueSize,heuristicTime,searchTime\n";
+    }
+
+    /**
+     * @brief Writes the record of the last query as a CSV line
+     */
+    void writeCSV( std::ostream& out) const
+    {
+        out << m_record.query << ","
+            << m_record.generatedLabels << ","
+            << m_record.targetLabels << ","
+            << m_record.prunedByNode << ","
+            << m_record.prunedByTarget << ","
+            << m_record.maxLabelsPerNode << ","
+            << m_record.maxQueueSize << ","
+            << m_record.heuristicTime << ","
+            << m_record.searchTime << "\n";
+    }
+
+    /**
+     * @brief Writes the record of the last query as a JSON object on a single line
+     */
+    void writeJSON( std::ostream& out) const
+    {
+        out << "{\"query\":" << m_record.query
+            << ",\"generatedLabels\":" << m_record.generatedLabels
+            << ",\"targetLabels\":" << m_record.targetLabels
+            << ",\"prunedByNode\":" << m_record.prunedByNode
+            << ",\"prunedByTarget\":" << m_record.prunedByTarget
+            << ",\"maxLabelsPerNode\":" << m_record.maxLabelsPerNode
+            << ",\"maxQueueSize\":" << m_record.maxQueueSize
+            << ",\"heuristicTime\":" << m_record.heuristicTime
+            << ",\"searchTime\":" << m_record.searchTime << "}\n";
+    }
+
+private:
+    Record m_record;
+    unsigned int m_numQueries;
+    Timer m_timer;
+};
+
+#endif //QUERYSTATS_H
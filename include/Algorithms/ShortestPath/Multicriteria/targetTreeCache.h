@@ -0,0 +1,268 @@
+#ifndef TARGETTREECACHE_H
+#define TARGETTREECACHE_H
+
+#include <Structs/Trees/priorityQueue.h>
+#include <Utilities/graphIO.h>
+#include <Utilities/parallel.h>
+#include <climits>
+#include <list>
+#include <map>
+#include <vector>
+
+/**
+ * @brief Least recently used cache of backward shortest path trees, keyed by target node
+ *
+ * For every cached target it holds one tree per criterion, computed on a compact snapshot of the
+ * reverse graph. The distances are stored in vectors indexed by the position of the nodes in the
+ * snapshot and not in the node payload, so that queries towards the same target can reuse them.
+ * The trees of the different criteria are built concurrently when compiled with OpenMP.
+ *
+ * The snapshot and the trees reflect the graph at the time they were built. They are rebuilt
+ * when the number of modifications of the graph has changed, so node insertions and erasures,
+ * edge updates and changes of the layout are noticed. Changes of the edge weights through
+ * iterators must be reported with DynamicGraph::markModified(), or the cache cleared with clear().
+ *
+ * The number of criteria is that of the edges. A graph without edges has no criteria, and
+ * every node but the target is unreachable from it.
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class TargetTreeCache
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
+	typedef typename GraphType::EdgeIterator    EdgeIterator;
+	typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+    typedef std::vector<unsigned int>           DistanceVector;
+    typedef PriorityQueue< unsigned int, unsigned int, HeapStorage>   PriorityQueueType;
+
+    /**
+     * @brief The trees towards a target
+     *
+     * distance[c][i] is the distance of the i-th node to the target with respect to criterion c.
+     * secondary[c][i] is the value of the next criterion along the same tree path. Unreachable
+     * nodes have the value EMPTY.
+     */
+    struct Trees
+    {
+        std::vector<DistanceVector> distance;
+        std::vector<DistanceVector> secondary;
+    };
+
+    static const unsigned int EMPTY = UINT_MAX;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph
+     * @param capacity The maximum number of targets whose trees are kept, at least one. Every entry
+     * takes 8 bytes per node and criterion.
+     */
+    TargetTreeCache( GraphType& graph, unsigned int capacity = 8):G(graph),m_capacity( capacity > 0 ? capacity : 1),m_numCriteria(0),m_hits(0),m_misses(0),m_isBuilt(false),m_numModifications(0)
+    {
+    }
+
+    /**
+     * @brief Drops all cached trees and the snapshot of the graph
+     */
+    void clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+        m_nodes.clear();
+        m_firstInEdge.clear();
+        m_sources.clear();
+        m_weights.clear();
+        m_numCriteria = 0;
+        m_isBuilt = false;
+    }
+
+    unsigned int getCapacity() const
+    {
+        return m_capacity;
+    }
+
+    unsigned int getHits() const
+    {
+        return m_hits;
+    }
+
+    unsigned int getMisses() const
+    {
+        return m_misses;
+    }
+
+    /**
+     * @brief Returns the index of a node in the vectors of the trees
+     */
+    unsigned int getIndex( const NodeIterator& u)
+    {
+        validate();
+        return m_indices[u];
+    }
+
+    /**
+     * @brief Returns the descriptors of the nodes of the snapshot, in index order
+     */
+    const std::vector<NodeDescriptor>& getNodes()
+    {
+        validate();
+        return m_nodes;
+    }
+
+    unsigned int getNumCriteria()
+    {
+        validate();
+        return m_numCriteria;
+    }
+
+    /**
+     * @brief Returns the trees towards a target, building them if they are not cached
+     */
+    const Trees& getTrees( const NodeIterator& t)
+    {
+        validate();
+
+        NodeDescriptor tD = G.getNodeDescriptor(t);
+        typename std::map< NodeDescriptor, typename EntryList::iterator>::iterator entry = m_index.find( tD);
+        if( entry != m_index.end())
+        {
+            ++m_hits;
+            m_entries.splice( m_entries.begin(), m_entries, entry->second);
+            return entry->second->second;
+        }
+
+        ++m_misses;
+        if( m_entries.size() >= m_capacity)
+        {
+            m_index.erase( m_entries.back().first);
+            m_entries.pop_back();
+        }
+
+        m_entries.push_front( std::make_pair( tD, Trees()));
+        m_index[tD] = m_entries.begin();
+        Trees& trees = m_entries.front().second;
+        trees.distance.resize( m_numCriteria);
+        trees.secondary.resize( m_numCriteria);
+
+        unsigned int target = m_indices[t];
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( int c = 0; c < (int)m_numCriteria; ++c)
+        {
+            buildTree( target, c, trees.distance[c], trees.secondary[c]);
+        }
+        return trees;
+    }
+
+private:
+    typedef std::list< std::pair< NodeDescriptor, Trees> > EntryList;
+
+    GraphType& G;
+    unsigned int m_capacity, m_numCriteria, m_hits, m_misses;
+    EntryList m_entries;
+    std::map< NodeDescriptor, typename EntryList::iterator> m_index;
+
+    bool m_isBuilt;
+    unsigned int m_numModifications;
+    std::vector<NodeDescriptor> m_nodes;
+    NodeIndexMap<GraphType> m_indices;
+    std::vector<unsigned int> m_firstInEdge, m_sources;
+    std::vector<DistanceVector> m_weights;
+
+    /**
+     * @brief Drops the trees and rebuilds the snapshot if the graph was modified since it was taken
+     */
+    void validate()
+    {
+        if( m_isBuilt && ( m_numModifications == G.getNumModifications())) return;
+        clear();
+        buildSnapshot();
+        m_numModifications = G.getNumModifications();
+        m_isBuilt = true;
+    }
+
+    /**
+     * @brief Builds the compact reverse graph that the trees are computed on
+     */
+    void buildSnapshot()
+    {
+        NodeIterator u, lastNode;
+        InEdgeIterator k, lastInEdge;
+
+        m_indices.init( G);
+        m_nodes.clear();
+        m_nodes.reserve( G.getNumNodes());
+        m_numCriteria = 0;
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            m_nodes.push_back( G.getNodeDescriptor(u));
+            if( m_numCriteria == 0 && G.beginInEdges(u) != G.endInEdges(u))
+            {
+                m_numCriteria = G.beginInEdges(u)->criteriaList.size();
+            }
+        }
+
+        m_firstInEdge.assign( 1, 0);
+        m_firstInEdge.reserve( m_nodes.size() + 1);
+        m_sources.clear();
+        m_sources.reserve( G.getNumEdges());
+        m_weights.assign( m_numCriteria, DistanceVector());
+        for( unsigned int c = 0; c < m_numCriteria; ++c) m_weights[c].reserve( G.getNumEdges());
+
+        for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+            {
+                m_sources.push_back( m_indices[ G.source(k)]);
+                for( unsigned int c = 0; c < m_numCriteria; ++c) m_weights[c].push_back( k->criteriaList[c]);
+            }
+            m_firstInEdge.push_back( m_sources.size());
+        }
+    }
+
+    void buildTree( unsigned int target, unsigned int criterion, DistanceVector& distance, DistanceVector& secondary)
+    {
+        unsigned int other = (criterion + 1) % m_numCriteria;
+        const DistanceVector& weights = m_weights[criterion];
+        const DistanceVector& otherWeights = m_weights[other];
+        PriorityQueueType pq;
+        std::vector<PQSizeType> pqitems( m_nodes.size());
+
+        distance.assign( m_nodes.size(), EMPTY);
+        secondary.assign( m_nodes.size(), EMPTY);
+        distance[target] = 0;
+        secondary[target] = 0;
+        pq.insert( 0, target, &pqitems[target]);
+
+        while( !pq.empty())
+        {
+            unsigned int u = pq.minItem();
+            pq.popMin();
+            for( unsigned int k = m_firstInEdge[u]; k < m_firstInEdge[u+1]; ++k)
+            {
+                unsigned int v = m_sources[k];
+                unsigned int newDistance = distance[u] + weights[k];
+                if( distance[v] == EMPTY)
+                {
+                    distance[v] = newDistance;
+                    secondary[v] = secondary[u] + otherWeights[k];
+                    pq.insert( newDistance, v, &pqitems[v]);
+                }
+                else if( distance[v] > newDistance)
+                {
+                    distance[v] = newDistance;
+                    secondary[v] = secondary[u] + otherWeights[k];
+                    pq.decrease( newDistance, &pqitems[v]);
+                }
+            }
+        }
+    }
+};
+
+template<class GraphType>
+const unsigned int TargetTreeCache<GraphType>::EMPTY;
+
+#endif //TARGETTREECACHE_H
@@ -0,0 +1,176 @@
+#ifndef DAGSHORTESTPATH_H
+#define DAGSHORTESTPATH_H
+
+#include <Algorithms/topologicalOrdering.h>
+#include <Utilities/graphIO.h>
+#include <vector>
+#include <limits>
+#include <cassert>
+
+/**
+ * @class DagShortestPath
+ *
+ * @brief Shortest and longest paths on a directed acyclic graph, in linear time
+ *
+ * The nodes are relaxed once each, in topological order, so no priority queue is needed. The
+ * topological order is computed when the algorithm is constructed and must be recomputed with
+ * init() after the graph changes. The results are kept in the same node fields as Dijkstra's
+ * (dist, pred and timestamp), and the weights of the edges in the field weight.
+ *
+ * @tparam GraphType The type of the graph to run the algorithm on
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class DagShortestPath
+{
+public:
+    typedef typename GraphType::NodeIterator                        NodeIterator;
+    typedef typename GraphType::EdgeIterator                        EdgeIterator;
+    typedef typename GraphType::SizeType                            SizeType;
+    typedef unsigned int                                            WeightType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to run the algorithm on. It must have no cycles
+     * @param timestamp An address containing a timestamp. A timestamp must be given in order to check whether a node is reached or not
+     */
+    DagShortestPath( GraphType& graph, unsigned int* timestamp):G(graph),m_timestamp(timestamp),m_settled(0)
+    {
+        init();
+    }
+
+    /**
+     * @brief Computes the topological order of the nodes of the graph
+     *
+     * @return False if the graph has a cycle. The paths can not be computed in this case
+     */
+    bool init()
+    {
+        CsrSnapshot<GraphType> snapshot( G);
+        std::vector<SizeType> numbers;
+        m_isAcyclic = topologicalOrder( snapshot, numbers);
+
+        m_order.resize( numbers.size());
+        m_rank.assign( snapshot.getNumNodes(), 0);
+        for( SizeType i = 0; i < numbers.size(); ++i)
+        {
+            m_order[i] = snapshot.getNode( numbers[i]);
+            m_rank[ numbers[i]] = i;
+        }
+        m_index.init( G);
+        return m_isAcyclic;
+    }
+
+    bool isAcyclic() const
+    {
+        return m_isAcyclic;
+    }
+
+    const unsigned int& getSettledNodes()
+    {
+        return m_settled;
+    }
+
+    /**
+     * @brief Builds a shortest path tree routed on a source node
+     *
+     * @param s The source node
+     */
+    void buildTree( const NodeIterator& s)
+    {
+        relax( s, G.endNodes(), false);
+    }
+
+    /**
+     * @brief Builds a longest path tree routed on a source node
+     *
+     * @param s The source node
+     */
+    void buildLongestTree( const NodeIterator& s)
+    {
+        relax( s, G.endNodes(), true);
+    }
+
+    /**
+     * @brief Runs a shortest path query between a source node s and a target node t
+     *
+     * @param s The source node
+     * @param t The target node
+     * @return The distance of the target node, or the largest weight if t is not reached from s
+     */
+    WeightType runQuery( const NodeIterator& s, const NodeIterator& t)
+    {
+        return relax( s, t, false);
+    }
+
+    /**
+     * @brief Finds the longest path between a source node s and a target node t
+     *
+     * @param s The source node
+     * @param t The target node
+     * @return The length of the longest path, or the largest weight if t is not reached from s
+     */
+    WeightType runLongestQuery( const NodeIterator& s, const NodeIterator& t)
+    {
+        return relax( s, t, true);
+    }
+
+private:
+    GraphType& G;
+    unsigned int* m_timestamp;
+    unsigned int m_settled;
+    bool m_isAcyclic;
+    std::vector<NodeIterator> m_order;
+    std::vector<SizeType> m_rank;
+    NodeIndexMap<GraphType> m_index;
+
+    /**
+     * @brief Relaxes the edges of the nodes reached from s, in topological order, until t is settled
+     *
+     * The nodes before s in the order can not be reached from s, so the scan starts at s. Every
+     * path to t only passes through nodes before t, so the distance of t is final when t is met.
+     */
+    WeightType relax( const NodeIterator& s, const NodeIterator& t, bool isLongest)
+    {
+        NodeIterator u,v;
+        EdgeIterator e,lastEdge;
+
+        assert( m_isAcyclic);
+        m_settled = 0;
+        ++(*m_timestamp);
+        s->dist = 0;
+        s->timestamp = (*m_timestamp);
+        s->pred = G.nilNodeDescriptor();
+
+        for( SizeType i = m_rank[ m_index[s]]; i < m_order.size(); ++i)
+        {
+            u = m_order[i];
+            if( u->timestamp != (*m_timestamp)) continue;
+            ++m_settled;
+            if( u == t) return t->dist;
+
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                v = G.target(e);
+                WeightType dist = u->dist + e->weight;
+
+                if( v->timestamp != (*m_timestamp))
+                {
+                    v->pred = u->getDescriptor();
+                    v->dist = dist;
+                    v->timestamp = (*m_timestamp);
+                }
+                else if( isLongest ? ( v->dist < dist) : ( v->dist > dist))
+                {
+                    v->pred = u->getDescriptor();
+                    v->dist = dist;
+                }
+            }
+        }
+        return std::numeric_limits<WeightType>::max();
+    }
+};
+
+#endif //DAGSHORTESTPATH_H
@@ -82,7 +82,14 @@ public:
         }
     }
 
-    void buildSubTree( const typename GraphType::NodeIterator& s, NodeSelection<GraphType>& targets)
+    /**
+     * @brief Builds a shortest path tree from a source node s, until all the target nodes are settled
+     *
+     * @param s The source node
+     * @param targets A selection of the target nodes, a NodeSelection or a BitmapNodeSelection
+     */
+    template<class SelectionType>
+    void buildSubTree( const typename GraphType::NodeIterator& s, SelectionType& targets)
     {
         NodeIterator u,v,lastNode;
         EdgeIterator e,lastEdge;
@@ -3,8 +3,30 @@
 
 #include <Structs/Graphs/dynamicGraph.h>
 #include <Structs/Graphs/nodeSelection.h>
+#include <Structs/Graphs/bitmapNodeSelection.h>
+#include <Structs/Graphs/csrSnapshot.h>
+#include <Algorithms/stronglyConnectedComponents.h>
+#include <Algorithms/coreDecomposition.h>
+#include <Algorithms/topologicalOrdering.h>
+#include <Algorithms/graphComparison.h>
+#include <Utilities/parallel.h>
+#include <Utilities/binaryMath.h>
 #include <queue>
+#include <stack>
+#include <limits>
 
+/**
+ * @class SearchVisitor
+ *
+ * @brief A visitor with virtual callbacks, for visitors that are chosen at run time
+ *
+ * The search cores are templates on the type of their visitor, so they call the methods of the
+ * visitor's own type. A visitor passed as a pointer to SearchVisitor is called through the
+ * virtual table, which costs an indirect call for every marked node.
+ *
+ * @author Panos Michail
+ *
+ */
 template<class GraphType>
 class SearchVisitor
 {
@@ -16,6 +38,10 @@ public:
     {  
     }
 
+    virtual ~SearchVisitor()
+    {
+    }
+
     virtual void visitOnInit()
     {
     }
@@ -35,17 +61,50 @@ public:
     }
 };
 
+
+/**
+ * @class NullSearchVisitor
+ *
+ * @brief A visitor that does nothing. Its empty inline methods compile away, so a search with it runs at the speed of the bare traversal
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class NullSearchVisitor
+{
+public:
+
+    typedef typename GraphType::NodeIterator    node;
+
+    void visitOnInit()
+    {
+    }
+
+    void visitOnFinding( const node& u)
+    {
+    }
+
+    void visitOnMarking( const node& u)
+    {
+    }
+
+    void visitOnExit()
+    {
+    }
+};
+
 /**
  * @brief This is the core Breadth First Search Algorithm
  * @param G The graph to search
  * @param root The node to start the search from
- * @param visitor A visitor that gets called for every node in the BFS tree
+ * @param visitor A visitor that gets called for every node in the search tree. Its methods are resolved at compile time, unless it is passed as a pointer to SearchVisitor
  *
  * @author Panos Michail
  *
  */
-template<class GraphType>
-void bfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisitor<GraphType>* visitor = 0)
+template<class GraphType, class VisitorType>
+void bfsCore( GraphType& G, typename GraphType::NodeIterator& root, VisitorType* visitor)
 {
     typedef typename GraphType::NodeIterator    node;
     typedef typename GraphType::EdgeIterator    edge;
@@ -84,25 +143,36 @@ void bfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisito
 }
 
 
+/**
+ * @brief Runs bfsCore without a visitor
+ */
+template<class GraphType>
+void bfsCore( GraphType& G, typename GraphType::NodeIterator& root)
+{
+    NullSearchVisitor<GraphType> visitor;
+    bfsCore( G, root, &visitor);
+}
+
+
 /**
  * @brief This is the core Breadth First Search Algorithm on the reversed graph
  * @param G The graph to search
  * @param root The node to start the search from
- * @param visitor A visitor that gets called for every node in the BFS tree
+ * @param visitor A visitor that gets called for every node in the search tree. Its methods are resolved at compile time, unless it is passed as a pointer to SearchVisitor
  *
  * @author Panos Michail
  *
  */
-template<class GraphType>
-void reverseBfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisitor<GraphType>* visitor = 0)
+template<class GraphType, class VisitorType>
+void reverseBfsCore( GraphType& G, typename GraphType::NodeIterator& root, VisitorType* visitor)
 {
     typedef typename GraphType::NodeIterator    node;
-    typedef typename GraphType::EdgeIterator    edge;
+    typedef typename GraphType::InEdgeIterator  inEdge;
     typedef typename GraphType::SizeType        SizeType;
     typedef typename GraphType::NodeData        NodeData;
 
     node u,v;
-    edge e,end;
+    inEdge k,end;
     std::queue<node> Q;
     Q.push(root);
 
@@ -118,9 +188,9 @@ void reverseBfsCore( GraphType& G, typename GraphType::NodeIterator& root, Searc
         u = Q.front();
         Q.pop();      
 
-        for( e = G.beginBackEdges(u), end = G.endBackEdges(u); e != end; ++e)
+        for( k = G.beginInEdges(u), end = G.endInEdges(u); k != end; ++k)
         {
-            v = G.source( e);
+            v = G.source( k);
             if( ! v->marked)
             {
                 visitor->visitOnMarking(v);
@@ -134,27 +204,38 @@ void reverseBfsCore( GraphType& G, typename GraphType::NodeIterator& root, Searc
 }
 
 
+/**
+ * @brief Runs reverseBfsCore without a visitor
+ */
+template<class GraphType>
+void reverseBfsCore( GraphType& G, typename GraphType::NodeIterator& root)
+{
+    NullSearchVisitor<GraphType> visitor;
+    reverseBfsCore( G, root, &visitor);
+}
+
+
 /**
  * @brief This is an undirected version of the core Breadth First Search Algorithm
  * @param G The graph to search
  * @param root The node to start the search from
- * @param visitor A visitor that gets called for every node in the BFS tree
+ * @param visitor A visitor that gets called for every node in the search tree. Its methods are resolved at compile time, unless it is passed as a pointer to SearchVisitor
  *
  * @author Panos Michail
  *
  */
-template<class GraphType>
-void undirectedBfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisitor<GraphType>* visitor = 0)
+template<class GraphType, class VisitorType>
+void undirectedBfsCore( GraphType& G, typename GraphType::NodeIterator& root, VisitorType* visitor)
 {
     typedef typename GraphType::NodeIterator    node;
     typedef typename GraphType::EdgeIterator    edge;
-    typedef typename GraphType::BackEdgeIterator    backEdge;
+    typedef typename GraphType::InEdgeIterator  inEdge;
     typedef typename GraphType::SizeType        SizeType;
     typedef typename GraphType::NodeData        NodeData;
 
     node u,v;
     edge e,end;
-    backEdge k,kEnd;
+    inEdge k,kEnd;
     std::queue<node> Q;
     Q.push(root);
 
@@ -186,7 +267,7 @@ void undirectedBfsCore( GraphType& G, typename GraphType::NodeIterator& root, Se
             }
         }
         
-        for( k = G.beginBackEdges(u), kEnd = G.endBackEdges(u); k != kEnd; ++k)
+        for( k = G.beginInEdges(u), kEnd = G.endInEdges(u); k != kEnd; ++k)
         {
             status = true;
             v = G.source( k);
@@ -203,17 +284,322 @@ void undirectedBfsCore( GraphType& G, typename GraphType::NodeIterator& root, Se
 }
 
 
+/**
+ * @brief Runs undirectedBfsCore without a visitor
+ */
+template<class GraphType>
+void undirectedBfsCore( GraphType& G, typename GraphType::NodeIterator& root)
+{
+    NullSearchVisitor<GraphType> visitor;
+    undirectedBfsCore( G, root, &visitor);
+}
+
+
+/**
+ * @brief The edges a breadth first search follows
+ */
+enum BfsDirection { FORWARD_BFS, REVERSE_BFS, UNDIRECTED_BFS };
+
+
+/**
+ * @class DirectionOptimizingBfs
+ *
+ * @brief Parallel Breadth First Search on a CsrSnapshot that switches between top-down and bottom-up steps
+ *
+ * A top-down step scans the edges of the frontier nodes, as usual. A bottom-up step makes every
+ * unreached node scan its incoming edges for a parent in the frontier, and stops at the first
+ * one it finds. When the frontier holds a large part of the graph, most edges lead to reached
+ * nodes, and the bottom-up step checks far fewer edges. The search goes bottom-up when the
+ * edges of the frontier are more than 1/alpha of the edges of the unreached nodes, and back
+ * top-down when the frontier shrinks below 1/beta of the nodes (Beamer et al., 2012).
+ *
+ * A top-down frontier is a list of nodes, and a bottom-up frontier is a bit vector over the
+ * nodes. The steps run in parallel when compiled with -fopenmp. The search computes the level
+ * and the parent of every reached node, and needs no field in the nodes.
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class DirectionOptimizingBfs
+{
+public:
+    typedef CsrSnapshot<GraphType>              Snapshot;
+    typedef typename Snapshot::SizeType         SizeType;
+    typedef uint64_t                            WordType;
+
+    DirectionOptimizingBfs( const Snapshot& G, unsigned int alpha = 15, unsigned int beta = 18):G(G),m_alpha(alpha),m_beta(beta),m_numTopDownSteps(0),m_numBottomUpSteps(0)
+    {
+    }
+
+    /**
+     * @brief Runs a search from a root node
+     *
+     * @param root The number of the root node in the snapshot
+     * @param direction The edges to follow. A reverse search follows the edges backwards
+     * @return The number of reached nodes, including the root
+     */
+    SizeType run( SizeType root, BfsDirection direction = FORWARD_BFS)
+    {
+        SizeType numNodes = G.getNumNodes();
+        setDirection( direction);
+        m_parents.assign( numNodes, unreached());
+        m_levels.assign( numNodes, unreached());
+        m_frontierBits.assign( ( numNodes + 63) >> 6, 0);
+        m_nextBits.assign( m_frontierBits.size(), 0);
+        m_numTopDownSteps = m_numBottomUpSteps = 0;
+
+        m_parents[root] = root;
+        m_levels[root] = 0;
+        m_frontier.assign( 1, root);
+
+        unsigned long long frontierEdges = getDownDegree( root);
+        unsigned long long unreachedEdges = 0;
+        for( unsigned int i = 0; i < m_numDown; ++i)
+        {
+            unreachedEdges += m_down[i].nodes->size();
+        }
+        unreachedEdges -= frontierEdges;
+
+        SizeType numReached = 1, frontierSize = 1, previousSize = 0, level = 0;
+        bool isBottomUp = false;
+        while( frontierSize)
+        {
+            ++level;
+            if( !isBottomUp && ( frontierEdges > unreachedEdges / m_alpha))
+            {
+                listToBits();
+                isBottomUp = true;
+            }
+            else if( isBottomUp && ( frontierSize < numNodes / m_beta) && ( frontierSize < previousSize))
+            {
+                bitsToList();
+                isBottomUp = false;
+            }
+
+            previousSize = frontierSize;
+            frontierSize = isBottomUp ? bottomUpStep( level, frontierEdges) : topDownStep( level, frontierEdges);
+            numReached += frontierSize;
+            unreachedEdges -= std::min( unreachedEdges, frontierEdges);
+        }
+        return numReached;
+    }
+
+    bool isReached( SizeType u) const
+    {
+        return m_parents[u] != unreached();
+    }
+
+    /**
+     * @brief Returns the number of edges on the path from the root to a reached node
+     */
+    SizeType getLevel( SizeType u) const
+    {
+        return m_levels[u];
+    }
+
+    /**
+     * @brief Returns the parent of a reached node in the search tree. The parent of the root is the root
+     */
+    SizeType getParent( SizeType u) const
+    {
+        return m_parents[u];
+    }
+
+    const std::vector<SizeType>& getLevels() const
+    {
+        return m_levels;
+    }
+
+    const std::vector<SizeType>& getParents() const
+    {
+        return m_parents;
+    }
+
+    SizeType getNumTopDownSteps() const
+    {
+        return m_numTopDownSteps;
+    }
+
+    SizeType getNumBottomUpSteps() const
+    {
+        return m_numBottomUpSteps;
+    }
+
+    static SizeType unreached()
+    {
+        return std::numeric_limits<SizeType>::max();
+    }
+
+private:
+    struct Adjacency
+    {
+        const std::vector<SizeType>* offsets;
+        const std::vector<SizeType>* nodes;
+    };
+
+    const Snapshot&                 G;
+    unsigned int                    m_alpha;
+    unsigned int                    m_beta;
+    Adjacency                       m_down[2];
+    Adjacency                       m_up[2];
+    unsigned int                    m_numDown;
+    unsigned int                    m_numUp;
+    std::vector<SizeType>           m_parents;
+    std::vector<SizeType>           m_levels;
+    std::vector<SizeType>           m_frontier;
+    std::vector< std::vector<SizeType> > m_threadFrontiers;
+    std::vector<WordType>           m_frontierBits;
+    std::vector<WordType>           m_nextBits;
+    SizeType                        m_numTopDownSteps;
+    SizeType                        m_numBottomUpSteps;
+
+    void setDirection( BfsDirection direction)
+    {
+        Adjacency forward, backward;
+        forward.offsets = &G.getOffsets();
+        forward.nodes = &G.getTargets();
+        backward.offsets = &G.getInOffsets();
+        backward.nodes = &G.getSources();
+
+        if( direction == UNDIRECTED_BFS)
+        {
+            m_down[0] = m_up[0] = forward;
+            m_down[1] = m_up[1] = backward;
+            m_numDown = m_numUp = 2;
+            return;
+        }
+        m_down[0] = ( direction == FORWARD_BFS) ? forward : backward;
+        m_up[0] = ( direction == FORWARD_BFS) ? backward : forward;
+        m_numDown = m_numUp = 1;
+    }
+
+    SizeType getDownDegree( SizeType u) const
+    {
+        SizeType degree = 0;
+        for( unsigned int i = 0; i < m_numDown; ++i)
+        {
+            degree += (*m_down[i].offsets)[u+1] - (*m_down[i].offsets)[u];
+        }
+        return degree;
+    }
+
+    SizeType topDownStep( SizeType level, unsigned long long& frontierEdges)
+    {
+        ++m_numTopDownSteps;
+        m_threadFrontiers.resize( getNumThreads());
+        for( SizeType t = 0; t < m_threadFrontiers.size(); ++t) m_threadFrontiers[t].clear();
+        unsigned long long nextEdges = 0;
+
+        #pragma omp parallel for schedule(dynamic, 64) reduction(+:nextEdges)
+        for( long i = 0; i < (long)m_frontier.size(); ++i)
+        {
+            std::vector<SizeType>& next = m_threadFrontiers[ getThreadIndex()];
+            SizeType u = m_frontier[i];
+            for( unsigned int j = 0; j < m_numDown; ++j)
+            {
+                const std::vector<SizeType>& offsets = *m_down[j].offsets;
+                const std::vector<SizeType>& nodes = *m_down[j].nodes;
+                for( SizeType k = offsets[u]; k < offsets[u+1]; ++k)
+                {
+                    SizeType v = nodes[k];
+                    if( ( m_parents[v] == unreached()) && compareAndSwap( &m_parents[v], unreached(), u))
+                    {
+                        m_levels[v] = level;
+                        next.push_back( v);
+                        nextEdges += getDownDegree( v);
+                    }
+                }
+            }
+        }
+
+        m_frontier.clear();
+        for( SizeType t = 0; t < m_threadFrontiers.size(); ++t)
+        {
+            m_frontier.insert( m_frontier.end(), m_threadFrontiers[t].begin(), m_threadFrontiers[t].end());
+        }
+        frontierEdges = nextEdges;
+        return m_frontier.size();
+    }
+
+    SizeType bottomUpStep( SizeType level, unsigned long long& frontierEdges)
+    {
+        ++m_numBottomUpSteps;
+        SizeType numNodes = G.getNumNodes();
+        unsigned long long nextEdges = 0;
+        SizeType nextSize = 0;
+
+        // Every thread writes whole words of the next frontier, so no atomics are needed
+        #pragma omp parallel for schedule(dynamic, 16) reduction(+:nextEdges,nextSize)
+        for( long w = 0; w < (long)m_nextBits.size(); ++w)
+        {
+            WordType bits = 0;
+            for( SizeType v = SizeType(w) << 6, last = std::min( v + 64, numNodes); v < last; ++v)
+            {
+                if( m_parents[v] != unreached()) continue;
+                bool isFound = false;
+                for( unsigned int j = 0; ( j < m_numUp) && !isFound; ++j)
+                {
+                    const std::vector<SizeType>& offsets = *m_up[j].offsets;
+                    const std::vector<SizeType>& nodes = *m_up[j].nodes;
+                    for( SizeType k = offsets[v]; k < offsets[v+1]; ++k)
+                    {
+                        SizeType u = nodes[k];
+                        if( ( m_frontierBits[ u >> 6] >> ( u & 63)) & 1)
+                        {
+                            m_parents[v] = u;
+                            m_levels[v] = level;
+                            bits |= WordType(1) << ( v & 63);
+                            ++nextSize;
+                            nextEdges += getDownDegree( v);
+                            isFound = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            m_nextBits[w] = bits;
+        }
+
+        m_frontierBits.swap( m_nextBits);
+        frontierEdges = nextEdges;
+        return nextSize;
+    }
+
+    void listToBits()
+    {
+        std::fill( m_frontierBits.begin(), m_frontierBits.end(), 0);
+        for( SizeType i = 0; i < m_frontier.size(); ++i)
+        {
+            m_frontierBits[ m_frontier[i] >> 6] |= WordType(1) << ( m_frontier[i] & 63);
+        }
+    }
+
+    void bitsToList()
+    {
+        m_frontier.clear();
+        for( SizeType w = 0; w < m_frontierBits.size(); ++w)
+        {
+            for( WordType bits = m_frontierBits[w]; bits; bits &= bits - 1)
+            {
+                m_frontier.push_back( ( w << 6) + countTrailingZeros64( bits));
+            }
+        }
+    }
+};
+
+
 /**
  * @brief This is the core Depth First Search Algorithm
  * @param G The graph to search
  * @param root The node to start the search from
- * @param visitor A visitor that gets called for every node in the BFS tree
+ * @param visitor A visitor that gets called for every node in the search tree. Its methods are resolved at compile time, unless it is passed as a pointer to SearchVisitor
  *
  * @author Panos Michail
  *
  */
-template<class GraphType>
-void dfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisitor<GraphType>* visitor = 0)
+template<class GraphType, class VisitorType>
+void dfsCore( GraphType& G, typename GraphType::NodeIterator& root, VisitorType* visitor)
 {
     typedef typename GraphType::NodeIterator    node;
     typedef typename GraphType::EdgeIterator    edge;
@@ -253,25 +639,36 @@ void dfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisito
 }
 
 
+/**
+ * @brief Runs dfsCore without a visitor
+ */
+template<class GraphType>
+void dfsCore( GraphType& G, typename GraphType::NodeIterator& root)
+{
+    NullSearchVisitor<GraphType> visitor;
+    dfsCore( G, root, &visitor);
+}
+
+
 /**
  * @brief This is the core Depth First Search Algorithm on the reversed graph
  * @param G The graph to search
  * @param root The node to start the search from
- * @param visitor A visitor that gets called for every node in the BFS tree
+ * @param visitor A visitor that gets called for every node in the search tree. Its methods are resolved at compile time, unless it is passed as a pointer to SearchVisitor
  *
  * @author Panos Michail
  *
  */
-template<class GraphType>
-void reverseDfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisitor<GraphType>* visitor = 0)
+template<class GraphType, class VisitorType>
+void reverseDfsCore( GraphType& G, typename GraphType::NodeIterator& root, VisitorType* visitor)
 {
     typedef typename GraphType::NodeIterator    node;
-    typedef typename GraphType::EdgeIterator    edge;
+    typedef typename GraphType::InEdgeIterator  inEdge;
     typedef typename GraphType::SizeType        SizeType;
     typedef typename GraphType::NodeData        NodeData;
 
     node u,v;
-    edge e,end;
+    inEdge k,end;
     std::stack<node> S;
     S.push(root);
 
@@ -287,9 +684,9 @@ void reverseDfsCore( GraphType& G, typename GraphType::NodeIterator& root, Searc
         u = S.top();
         S.pop();      
 
-        for( e = G.beginBackEdges(u), end = G.endBackEdges(u); e != end; ++e)
+        for( k = G.beginInEdges(u), end = G.endInEdges(u); k != end; ++k)
         {
-            v = G.source( e);
+            v = G.source( k);
             if( ! v->marked)
             {
                 visitor->visitOnMarking(v);
@@ -302,25 +699,38 @@ void reverseDfsCore( GraphType& G, typename GraphType::NodeIterator& root, Searc
     visitor->visitOnExit();
 }
 
+
+/**
+ * @brief Runs reverseDfsCore without a visitor
+ */
+template<class GraphType>
+void reverseDfsCore( GraphType& G, typename GraphType::NodeIterator& root)
+{
+    NullSearchVisitor<GraphType> visitor;
+    reverseDfsCore( G, root, &visitor);
+}
+
 /**
  * @brief This is an undirected version of the core Depth First Search Algorithm
  * @param G The graph to search
  * @param root The node to start the search from
- * @param visitor A visitor that gets called for every node in the BFS tree
+ * @param visitor A visitor that gets called for every node in the search tree. Its methods are resolved at compile time, unless it is passed as a pointer to SearchVisitor
  *
  * @author Panos Michail
  *
  */
-template<class GraphType>
-void undirectedDfsCore( GraphType& G, typename GraphType::NodeIterator& root, SearchVisitor<GraphType>* visitor = 0)
+template<class GraphType, class VisitorType>
+void undirectedDfsCore( GraphType& G, typename GraphType::NodeIterator& root, VisitorType* visitor)
 {
     typedef typename GraphType::NodeIterator    node;
     typedef typename GraphType::EdgeIterator    edge;
+    typedef typename GraphType::InEdgeIterator  inEdge;
     typedef typename GraphType::SizeType        SizeType;
     typedef typename GraphType::NodeData        NodeData;
 
     node u,v;
     edge e,end;
+    inEdge k,kEnd;
     std::stack<node> S;
     S.push(root);
 
@@ -347,9 +757,9 @@ void undirectedDfsCore( GraphType& G, typename GraphType::NodeIterator& root, Se
             }
         }
         
-        for( e = G.beginBackEdges(u), end = G.endBackEdges(u); e != end; ++e)
+        for( k = G.beginInEdges(u), kEnd = G.endInEdges(u); k != kEnd; ++k)
         {
-            v = G.source( e);
+            v = G.source( k);
             if( ! v->marked)
             {
                 visitor->visitOnMarking(v);
@@ -363,125 +773,23 @@ void undirectedDfsCore( GraphType& G, typename GraphType::NodeIterator& root, Se
 }
 
 
+/**
+ * @brief Runs undirectedDfsCore without a visitor
+ */
 template<class GraphType>
-unsigned int findStronglyConnectedComponents( GraphType& G)
-{    
-    typedef typename GraphType::NodeIterator    node;
-    typedef typename GraphType::EdgeIterator    edge;
-    typedef typename GraphType::BackEdgeIterator    backEdge;
-    typedef typename GraphType::SizeType        SizeType;
-    typedef typename GraphType::NodeData        NodeData;
-
-    node u,v;
-    edge e,end;
-    backEdge k,kEnd;
-    std::stack<node> S;
-    std::stack<node> discovered;
-    unsigned int component = 0;
-
-    for( u = G.beginNodes(), v = G.endNodes(); u != v; ++u)
-    {
-        u->marked = false; 
-    }
-
-    /*NodeIterator u = G.beginNodes();
-    discovered.push(u);
-    S.push(u);*/
-
-    while( discovered.size() != G.getNumNodes())
-    {
-        for( u = G.beginNodes(), v = G.endNodes(); u != v; ++u)
-            if( !u->marked)
-                break;
-        
-        //std::cout << u->getId() << std::endl;   
-        
-        u->marked = true;
-        discovered.push(u);
-        S.push(u);
-
-        while( !S.empty())
-        {
-            u = S.top();
-            S.pop();      
-
-            //std::cout << u->getId() << std::endl;
-
-            for( e = G.beginEdges(u), end = G.endEdges(u); e != end; ++e)
-            {
-                v = G.target( e);
-                if( ! v->marked)
-                {
-                    v->marked = true;
-                    S.push(v);
-                    discovered.push(v);
-                }
-            }
-
-           /* for( e = G.beginBackEdges(u), end = G.endBackEdges(u); e != end; ++e)
-            {
-                v = G.source( e);
-                if( ! v->marked)
-                {
-                    v->marked = true;
-                    S.push(v);
-                    discovered.push(v);
-                }
-            }*/
-
-        } 
-    }
-
-    for( u = G.beginNodes(), v = G.endNodes(); u != v; ++u) u->marked = false;
-
-    while( !discovered.empty())
-    {
-        u = discovered.top();
-        discovered.pop();
-
-        if( u->marked)
-        {
-            continue;
-        }
-        component++;
-        S.push(u);
-        u->marked = true;
-
-        while( !S.empty())
-        {
-            u = S.top();
-            S.pop();      
-            //std::cout << u->getId() << " " << u->marked << " " << S.size() << std::endl;
-            for( k = G.beginBackEdges(u), kEnd = G.endBackEdges(u); k != kEnd; ++k)
-            {
-                v = G.source(k);
-                if( ! v->marked)
-                {
-                    v->marked = true;
-                    S.push(v);
-                    v->component = component;
-                }
-            }
-
-            /*for( e = G.beginEdges(u), end = G.endEdges(u); e != end; ++e)
-            {
-                v = G.target( e);
-                if( ! v->marked)
-                {
-                    v->marked = true;
-                    S.push(v);
-                    v->component = component;
-                }
-            }*/
-        } 
-    }
-
-    return component;
+void undirectedDfsCore( GraphType& G, typename GraphType::NodeIterator& root)
+{
+    NullSearchVisitor<GraphType> visitor;
+    undirectedDfsCore( G, root, &visitor);
 }
 
 
 /**
  * @brief Check if a directed graph is strongly connected
+ *
+ * It is, if every node is reached from a root both forwards and backwards. Both searches are
+ * direction optimizing and run in parallel when compiled with -fopenmp.
+ *
  * @param G The graph to check
  *
  * @author Panos Michail
@@ -490,39 +798,22 @@ unsigned int findStronglyConnectedComponents( GraphType& G)
 template<class GraphType>
 bool isConnected( GraphType& G)
 {
-    typedef typename GraphType::NodeIterator    node;
-    typedef typename GraphType::EdgeIterator    edge;
     typedef typename GraphType::SizeType        SizeType;
-    typedef typename GraphType::NodeData        NodeData;
-    
-    class Visitor : public SearchVisitor<GraphType>
-    {
-    public:
-        Visitor():m_numNodes(1){}
-        
-        const SizeType& getNumNodes()
-        {
-            return m_numNodes;   
-        }
-        
-        virtual void visitOnMarking( const node& u)
-        {
-            //std::cout << "Connectivity Visitor\n";
-            ++m_numNodes;
-        }
-        
-        SizeType m_numNodes;
-    };
-    
-    Visitor vis;
-    node s = G.chooseNode();
-    bfsCore( G, s, &vis);
-    return vis.getNumNodes() == G.getNumNodes();
+
+    if( G.getNumNodes() < 2) return true;
+
+    CsrSnapshot<GraphType> snapshot( G);
+    DirectionOptimizingBfs<GraphType> bfs( snapshot);
+    SizeType root = snapshot.getIndex( G.chooseNode());
+    return ( bfs.run( root, FORWARD_BFS) == G.getNumNodes()) && ( bfs.run( root, REVERSE_BFS) == G.getNumNodes());
 }
 
 
 /**
  * @brief Check if a directed graph is weakly connected
+ *
+ * It is, if every node is reached from a root when the edges are followed in both directions.
+ *
  * @param G The graph to check
  *
  * @author Panos Michail
@@ -531,60 +822,38 @@ bool isConnected( GraphType& G)
 template<class GraphType>
 bool isWeaklyConnected( GraphType& G)
 {
-    typedef typename GraphType::NodeIterator    node;
-    typedef typename GraphType::EdgeIterator    edge;
     typedef typename GraphType::SizeType        SizeType;
-    typedef typename GraphType::NodeData        NodeData;
-    
-    class Visitor : public SearchVisitor<GraphType>
-    {
-    public:
-        Visitor():m_numNodes(1){}
-        
-        const SizeType& getNumNodes()
-        {
-            return m_numNodes;   
-        }
-        
-        virtual void visitOnMarking( const node& u)
-        {
-            //std::cout << "Connectivity Visitor\n";
-            ++m_numNodes;
-        }
-        
-        SizeType m_numNodes;
-    };
-    
-    Visitor vis;
-    node s = G.chooseNode();
-    undirectedBfsCore( G, s, &vis);
-    return vis.getNumNodes() == G.getNumNodes();
-}
 
+    if( G.getNumNodes() < 2) return true;
 
-template<class GraphType>
-bool topologicalSort( GraphType& G)
-{
-    return true;
+    CsrSnapshot<GraphType> snapshot( G);
+    DirectionOptimizingBfs<GraphType> bfs( snapshot);
+    SizeType root = snapshot.getIndex( G.chooseNode());
+    return bfs.run( root, UNDIRECTED_BFS) == G.getNumNodes();
 }
 
 
+/**
+ * @brief Marks the nodes of the k-core of a graph, the largest subgraph in which every node has degree at least k
+ *
+ * @param G The graph
+ * @param k The smallest degree in the core
+ *
+ * @author Panos Michail
+ *
+ */
 template<class GraphType>
 void markKCore( GraphType& G, unsigned int k)
 {
     typedef typename GraphType::NodeIterator        NodeIterator;
-    typedef typename GraphType::NodeDescriptor      NodeDescriptor;
-    typedef typename GraphType::EdgeIterator        EdgeIterator;
-    typedef typename GraphType::BackEdgeIterator    BackEdgeIterator;
-    typedef typename GraphType::EdgeDescriptor      EdgeDescriptor;
     typedef typename GraphType::SizeType            SizeType;
 
-    for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+    std::vector<SizeType> cores;
+    findCoreDecomposition( G, cores);
+    SizeType i = 0;
+    for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++i)
     {
-        if( G.degree(u) >= k)
-        {
-            u->marked = true;
-        }
+        u->marked = ( cores[i] >= k);
     }
 }
 
@@ -618,6 +887,52 @@ std::vector<typename GraphType::NodeDescriptor> getNeighbors( GraphType& G, cons
 }
 
 
+/**
+ * @brief Returns the neighbours of a node. Duplicates are found with a bitmap selection, so the neighbours are not accessed until they are returned
+ *
+ * @param G The graph, a packed memory graph
+ * @param u The node
+ * @param selection An empty selection of the graph. It is left empty, so that it can be reused for the next node
+ * @return The descriptors of the neighbours, in the order they were found
+ */
+template < class GraphType>
+std::vector<typename GraphType::NodeDescriptor> getNeighbors( GraphType& G, const typename GraphType::NodeIterator& u, BitmapNodeSelection<GraphType>& selection)
+{
+    typedef typename GraphType::NodeIterator        NodeIterator;
+    typedef typename GraphType::EdgeIterator        EdgeIterator;
+    typedef typename GraphType::InEdgeIterator      InEdgeIterator;
+    typedef typename GraphType::NodeDescriptor      NodeDescriptor;
+    typedef typename GraphType::SizeType            SizeType;
+
+    assert( selection.empty());
+    std::vector<NodeIterator> neighbors;
+
+    for( EdgeIterator e = G.beginEdges(u), endEdges = G.endEdges(u); e != endEdges; ++e)
+    {
+        NodeIterator v = G.target(e);
+        if( selection.isMember(v)) continue;
+        selection.select(v);
+        neighbors.push_back(v);
+    }
+
+    for( InEdgeIterator f = G.beginInEdges(u), endInEdges = G.endInEdges(u); f != endInEdges; ++f)
+    {
+        NodeIterator v = G.source(f);
+        if( selection.isMember(v)) continue;
+        selection.select(v);
+        neighbors.push_back(v);
+    }
+
+    std::vector<NodeDescriptor> descriptors( neighbors.size());
+    for( SizeType i = 0; i < neighbors.size(); ++i)
+    {
+        selection.deselect( neighbors[i]);
+        descriptors[i] = G.getNodeDescriptor( neighbors[i]);
+    }
+    return descriptors;
+}
+
+
 template < class GraphType>
 std::vector<typename GraphType::NodeDescriptor> getOutNeighbors( GraphType& G, const typename GraphType::NodeIterator& u)
 {
@@ -664,75 +979,26 @@ std::vector<typename GraphType::NodeDescriptor> getInNeighbors( GraphType& G, co
 
 /**
  * @brief Compare two graphs in terms of underlying structure
+ *
+ * Nodes are matched by their positions in the node order, and edges by the positions of their
+ * endpoints. The comparison takes O(n + m) time, see diffGraphs.
+ *
  * @param first The original graph
  * @param second The graph to check against to
- * @return -1 if the first graph has more nodes or edges, 0 if they are exactly the same,
- * +1 if the second graph has more nodes or edges
+ * @return -1 if the first graph has nodes or edges that the second has not, 0 if they are exactly the same,
+ * +1 if only the second graph has nodes or edges that the first has not
  *
  * @author Panos Michail
  *
  */
 template < class FirstGraphType, class SecondGraphType>
-int compare( const FirstGraphType& first, const SecondGraphType& second)
-{      
-    typename FirstGraphType::NodeIterator f_u,f_end_nodes;
-    typename FirstGraphType::EdgeIterator f_e,f_end_edges;
-    typename SecondGraphType::NodeIterator s_u, s_end_nodes;  
-    typename SecondGraphType::EdgeIterator s_e,s_end_edges;      
-
-    bool foundNode,foundEdge;
+int compare( FirstGraphType& first, SecondGraphType& second)
+{
+    GraphDiff diff;
+    diffGraphs( first, second, diff);
 
-    std::cout << "\nForward..." << std::flush;
-    for( f_u = first.beginNodes(), f_end_nodes = first.endNodes(); f_u != f_end_nodes; ++f_u)
-    {
-        foundNode = false;
-        for( s_u = second.beginNodes(), s_end_nodes = second.endNodes(); s_u != s_end_nodes; ++s_u)
-        {
-            if( second.getId(s_u) == first.getId(f_u))
-            {
-                foundNode = true;
-                for( f_e = first.beginEdges(f_u), f_end_edges = first.endEdges(f_u); f_e != f_end_edges; ++f_e)
-                {
-                    foundEdge = false;
-                    for( s_e = second.beginEdges(s_u), s_end_edges = second.endEdges(s_u); s_e != s_end_edges; ++s_e)
-                    {
-                        if( second.getId(s_e) == first.getId(f_e))
-                        {
-                            foundEdge = true;
-                        }
-                    }
-                    if( !foundEdge) return -1;
-                }
-            }
-        }
-        if( !foundNode) return -1;
-    }
-    std::cout << "done!\nBackward..." << std::flush;
-    for( s_u = second.beginNodes(), s_end_nodes = second.endNodes(); s_u != s_end_nodes; ++s_u)
-    {
-        foundNode = false;
-        for( f_u = first.beginNodes(), f_end_nodes = first.endNodes(); f_u != f_end_nodes; ++f_u)
-        {
-            if( second.getId(s_u->getId) == first.getId(f_u))
-            {
-                foundNode = true;
-                for( s_e = second.beginEdges(s_u), s_end_edges = second.endEdges(s_u); s_e != s_end_edges; ++s_e)
-                {
-                    foundEdge = false;
-                    for( f_e = first.beginEdges(f_u), f_end_edges = first.endEdges(f_u); f_e != f_end_edges; ++f_e)
-                    {
-                        if( second.getId(s_e) == first.getId(f_e))
-                        {
-                            foundEdge = true;
-                        }
-                    }
-                    if( !foundEdge) return -1;
-                }
-            }
-        }
-        if( !foundNode) return 1;
-    }
-    std::cout << "done!\n" << std::flush;    
+    if( !diff.removedNodes.empty() || !diff.removedEdges.empty()) return -1;
+    if( !diff.addedNodes.empty() || !diff.addedEdges.empty()) return 1;
     return 0;
 }
 
@@ -0,0 +1,220 @@
+#ifndef COREDECOMPOSITION_H
+#define COREDECOMPOSITION_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Structs/Graphs/csrSnapshot.h>
+#include <Utilities/parallel.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+/**
+ * Core decomposition of graphs. The k-core of a graph is its largest subgraph in which every
+ * node has degree at least k, and the core number of a node is the largest k for which it is in
+ * the k-core. The degree of a node is that of DynamicGraph::degree, the number of its outgoing
+ * and incoming edges. The core numbers are computed on a CsrSnapshot of the graph and are
+ * written to an array, in the order of the nodes of the graph.
+ */
+
+
+/**
+ * @brief Computes the core numbers with the bucket algorithm of Batagelj and Zaversnik
+ *
+ * The nodes are kept sorted by their current degree in an array with one bucket per degree.
+ * The node of smallest degree is removed repeatedly, and each of its neighbours moves one
+ * bucket down in constant time, so the whole decomposition takes linear time.
+ *
+ * @param G The snapshot of the graph
+ * @param cores Filled with the core number of every node
+ * @return The largest core number, the degeneracy of the graph
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+typename CsrSnapshot<GraphType>::SizeType bucketCoreDecomposition( const CsrSnapshot<GraphType>& G, std::vector<typename CsrSnapshot<GraphType>::SizeType>& cores)
+{
+    typedef typename CsrSnapshot<GraphType>::SizeType SizeType;
+
+    const std::vector<SizeType>* offsets[2] = { &G.getOffsets(), &G.getInOffsets() };
+    const std::vector<SizeType>* neighbors[2] = { &G.getTargets(), &G.getSources() };
+    SizeType numNodes = G.getNumNodes();
+
+    cores.resize( numNodes);
+    SizeType maxDegree = 0;
+    for( SizeType u = 0; u < numNodes; ++u)
+    {
+        cores[u] = ( G.getOffsets()[u+1] - G.getOffsets()[u]) + ( G.getInOffsets()[u+1] - G.getInOffsets()[u]);
+        maxDegree = std::max( maxDegree, cores[u]);
+    }
+
+    // bucketStart[d] is the position of the first node of degree d in the sorted nodes
+    std::vector<SizeType> bucketStart( maxDegree + 1, 0), position( numNodes), sorted( numNodes);
+    for( SizeType u = 0; u < numNodes; ++u) ++bucketStart[ cores[u]];
+    for( SizeType d = 0, start = 0; d <= maxDegree; ++d)
+    {
+        SizeType size = bucketStart[d];
+        bucketStart[d] = start;
+        start += size;
+    }
+    for( SizeType u = 0; u < numNodes; ++u)
+    {
+        position[u] = bucketStart[ cores[u]]++;
+        sorted[ position[u]] = u;
+    }
+    for( SizeType d = maxDegree; d > 0; --d) bucketStart[d] = bucketStart[d-1];
+    bucketStart[0] = 0;
+
+    SizeType degeneracy = 0;
+    for( SizeType i = 0; i < numNodes; ++i)
+    {
+        SizeType u = sorted[i];
+        degeneracy = std::max( degeneracy, cores[u]);
+        for( unsigned int j = 0; j < 2; ++j)
+        {
+            for( SizeType k = (*offsets[j])[u]; k < (*offsets[j])[u+1]; ++k)
+            {
+                SizeType v = (*neighbors[j])[k];
+                if( cores[v] <= cores[u]) continue;
+
+                // Swap v with the first node of its bucket and move the bucket start past it
+                SizeType degree = cores[v];
+                SizeType w = sorted[ bucketStart[degree]];
+                if( v != w)
+                {
+                    std::swap( sorted[ position[v]], sorted[ bucketStart[degree]]);
+                    std::swap( position[v], position[w]);
+                }
+                ++bucketStart[degree];
+                --cores[v];
+            }
+        }
+    }
+
+    return degeneracy;
+}
+
+
+/**
+ * @brief Computes the core numbers by peeling all the nodes of the current core number at once, in parallel
+ *
+ * At level k, the remaining nodes with degree k are removed, and every neighbour whose degree
+ * drops to k is removed in the same level. Degrees are decreased atomically, and a decrease
+ * below k is undone, so a node keeps degree k when it is removed (Dasari et al., 2014). Levels
+ * without nodes are skipped. Each level scans all the nodes once, so this pays off for graphs
+ * with few distinct core numbers and many threads (compile with -fopenmp).
+ *
+ * @param G The snapshot of the graph
+ * @param cores Filled with the core number of every node
+ * @return The largest core number, the degeneracy of the graph
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+typename CsrSnapshot<GraphType>::SizeType parallelCoreDecomposition( const CsrSnapshot<GraphType>& G, std::vector<typename CsrSnapshot<GraphType>::SizeType>& cores)
+{
+    typedef typename CsrSnapshot<GraphType>::SizeType SizeType;
+
+    const std::vector<SizeType>* offsets[2] = { &G.getOffsets(), &G.getInOffsets() };
+    const std::vector<SizeType>* neighbors[2] = { &G.getTargets(), &G.getSources() };
+    const SizeType none = std::numeric_limits<SizeType>::max();
+    SizeType numNodes = G.getNumNodes();
+
+    cores.resize( numNodes);
+    #pragma omp parallel for schedule(static)
+    for( long i = 0; i < (long)numNodes; ++i)
+    {
+        cores[i] = ( G.getOffsets()[i+1] - G.getOffsets()[i]) + ( G.getInOffsets()[i+1] - G.getInOffsets()[i]);
+    }
+
+    std::vector<SizeType> frontier;
+    std::vector< std::vector<SizeType> > threadFrontiers( getNumThreads());
+    SizeType numRemoved = 0, level = 0;
+    bool isFirstLevel = true;
+
+    while( numRemoved < numNodes)
+    {
+        // The remaining nodes are those with a degree above the last level
+        SizeType nextLevel = none;
+        #pragma omp parallel for schedule(static) reduction(min:nextLevel)
+        for( long i = 0; i < (long)numNodes; ++i)
+        {
+            if( ( isFirstLevel || ( cores[i] > level)) && ( cores[i] < nextLevel)) nextLevel = cores[i];
+        }
+        level = nextLevel;
+        isFirstLevel = false;
+
+        for( SizeType t = 0; t < threadFrontiers.size(); ++t) threadFrontiers[t].clear();
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)numNodes; ++i)
+        {
+            if( cores[i] == level) threadFrontiers[ getThreadIndex()].push_back( i);
+        }
+        frontier.clear();
+        for( SizeType t = 0; t < threadFrontiers.size(); ++t)
+        {
+            frontier.insert( frontier.end(), threadFrontiers[t].begin(), threadFrontiers[t].end());
+        }
+
+        while( !frontier.empty())
+        {
+            numRemoved += frontier.size();
+            for( SizeType t = 0; t < threadFrontiers.size(); ++t) threadFrontiers[t].clear();
+
+            #pragma omp parallel for schedule(dynamic, 64)
+            for( long i = 0; i < (long)frontier.size(); ++i)
+            {
+                std::vector<SizeType>& next = threadFrontiers[ getThreadIndex()];
+                SizeType u = frontier[i];
+                for( unsigned int j = 0; j < 2; ++j)
+                {
+                    for( SizeType k = (*offsets[j])[u]; k < (*offsets[j])[u+1]; ++k)
+                    {
+                        SizeType v = (*neighbors[j])[k];
+                        if( cores[v] <= level) continue;
+                        SizeType degree = fetchAndAdd( &cores[v], SizeType(-1)) - 1;
+                        if( degree == level)
+                        {
+                            next.push_back( v);
+                        }
+                        else if( degree < level)
+                        {
+                            fetchAndAdd( &cores[v], 1);
+                        }
+                    }
+                }
+            }
+
+            frontier.clear();
+            for( SizeType t = 0; t < threadFrontiers.size(); ++t)
+            {
+                frontier.insert( frontier.end(), threadFrontiers[t].begin(), threadFrontiers[t].end());
+            }
+        }
+    }
+
+    return numNodes ? level : 0;
+}
+
+
+/**
+ * @brief Computes the core number of every node of a graph
+ *
+ * @param G The graph
+ * @param cores Filled with the core number of every node, in the order of the nodes of the graph
+ * @param inParallel Whether to use parallelCoreDecomposition instead of bucketCoreDecomposition
+ * @return The largest core number, the degeneracy of the graph
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+typename GraphType::SizeType findCoreDecomposition( GraphType& G, std::vector<typename GraphType::SizeType>& cores, bool inParallel = false)
+{
+    CsrSnapshot<GraphType> snapshot( G);
+    if( inParallel) return parallelCoreDecomposition( snapshot, cores);
+    return bucketCoreDecomposition( snapshot, cores);
+}
+
+#endif //COREDECOMPOSITION_H
@@ -0,0 +1,273 @@
+#ifndef GRAPHCOMPARISON_H
+#define GRAPHCOMPARISON_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Structs/Graphs/csrSnapshot.h>
+#include <Utilities/binaryMath.h>
+#include <Utilities/parallel.h>
+#include <Utilities/radixSort.h>
+#include <vector>
+#include <utility>
+
+/**
+ * Comparison of graphs. The nodes of two graphs are matched by their ids, and the edges by the
+ * ids of their endpoints. By default the id of a node is its position in the node order, as in
+ * graph files and change logs. Another id, such as a field of the nodes, is given with a class
+ * like PositionNodeIds. Node and edge data take part only in fingerprints, through a class like
+ * NoPayloadHash.
+ */
+
+
+/**
+ * @class PositionNodeIds
+ *
+ * @brief Gives every node its position in the node order as an id
+ */
+template<class GraphType>
+class PositionNodeIds
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    unsigned int operator()( const NodeIterator& u, SizeType position) const
+    {
+        return position;
+    }
+};
+
+
+/**
+ * @class NoPayloadHash
+ *
+ * @brief Leaves node and edge data out of a fingerprint. A class that hashes some fields of the data provides the same two methods
+ */
+template<class GraphType>
+class NoPayloadHash
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+
+    uint64_t hashNode( const NodeIterator& u) const
+    {
+        return 0;
+    }
+
+    uint64_t hashEdge( const EdgeIterator& e) const
+    {
+        return 0;
+    }
+};
+
+
+/**
+ * @class GraphDiff
+ *
+ * @brief The nodes and edges that were added to or removed from a graph, by id
+ *
+ * Nodes and edges are sorted by id. An edge is the pair of the ids of its source and target, and
+ * parallel edges are counted separately.
+ */
+class GraphDiff
+{
+public:
+    typedef std::pair<unsigned int,unsigned int>    Edge;
+
+    std::vector<unsigned int>   addedNodes;
+    std::vector<unsigned int>   removedNodes;
+    std::vector<Edge>           addedEdges;
+    std::vector<Edge>           removedEdges;
+
+    bool empty() const
+    {
+        return addedNodes.empty() && removedNodes.empty() && addedEdges.empty() && removedEdges.empty();
+    }
+
+    void clear()
+    {
+        addedNodes.clear();
+        removedNodes.clear();
+        addedEdges.clear();
+        removedEdges.clear();
+    }
+};
+
+
+/**
+ * @brief Collects the ids of the nodes and the pairs of ids of the edges of a graph, in parallel
+ *
+ * @param G The snapshot of the graph
+ * @param nodeIds The ids of the nodes
+ * @param nodeKeys Filled with the id of every node
+ * @param edgeKeys Filled with the id of the source of every edge in the high 32 bits, and the id of its target in the low ones
+ */
+template<class GraphType, class NodeIdsType>
+void collectGraphKeys( const CsrSnapshot<GraphType>& G, const NodeIdsType& nodeIds, std::vector<uint64_t>& nodeKeys, std::vector<uint64_t>& edgeKeys)
+{
+    typedef typename CsrSnapshot<GraphType>::SizeType SizeType;
+
+    const std::vector<SizeType>& offsets = G.getOffsets();
+    const std::vector<SizeType>& targets = G.getTargets();
+    SizeType numNodes = G.getNumNodes();
+
+    nodeKeys.resize( numNodes);
+    #pragma omp parallel for schedule(static)
+    for( long i = 0; i < (long)numNodes; ++i)
+    {
+        nodeKeys[i] = nodeIds( G.getNode(i), i);
+    }
+
+    edgeKeys.resize( G.getNumEdges());
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( long i = 0; i < (long)numNodes; ++i)
+    {
+        for( SizeType k = offsets[i]; k < offsets[i+1]; ++k)
+        {
+            edgeKeys[k] = ( nodeKeys[i] << 32) | nodeKeys[ targets[k]];
+        }
+    }
+}
+
+
+/**
+ * @brief Computes a fingerprint of the structure and of some of the data of a graph
+ *
+ * The fingerprint is the sum of hashes of every node and every edge, so it does not depend on
+ * the order of the nodes and edges in memory. Two graphs with the same ids, the same edges
+ * between them and the same hashed data have the same fingerprint, and two different graphs
+ * almost never do. The hashes are computed in parallel when compiled with -fopenmp.
+ *
+ * @param G The graph
+ * @param nodeIds The ids of the nodes, such as PositionNodeIds
+ * @param payload The hashes of the node and edge data, such as NoPayloadHash
+ * @return The fingerprint
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType, class NodeIdsType, class PayloadHashType>
+uint64_t graphFingerprint( GraphType& G, const NodeIdsType& nodeIds, const PayloadHashType& payload)
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    CsrSnapshot<GraphType> snapshot( G);
+    std::vector<uint64_t> nodeKeys, edgeKeys;
+    collectGraphKeys( snapshot, nodeIds, nodeKeys, edgeKeys);
+
+    const std::vector<SizeType>& offsets = snapshot.getOffsets();
+    SizeType numNodes = snapshot.getNumNodes();
+    unsigned long long sum = 0;
+
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:sum)
+    for( long i = 0; i < (long)numNodes; ++i)
+    {
+        NodeIterator u = snapshot.getNode(i);
+        // The constant keeps a node from hashing like an edge from node 0
+        sum += mixBits64( mixBits64( nodeKeys[i] ^ 0x9E3779B97F4A7C15ULL) + payload.hashNode(u));
+
+        SizeType k = offsets[i];
+        for( EdgeIterator e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e, ++k)
+        {
+            sum += mixBits64( mixBits64( edgeKeys[k]) + payload.hashEdge(e));
+        }
+    }
+
+    return mixBits64( sum + ( uint64_t( numNodes) << 32) + snapshot.getNumEdges());
+}
+
+
+/**
+ * @brief Computes a fingerprint of the structure of a graph, with the positions of the nodes as ids
+ */
+template<class GraphType>
+uint64_t graphFingerprint( GraphType& G)
+{
+    return graphFingerprint( G, PositionNodeIds<GraphType>(), NoPayloadHash<GraphType>());
+}
+
+
+/**
+ * @brief Finds the keys of a sorted list that are not in another one, and the other way around
+ */
+inline void subtractSortedKeys( const std::vector<uint64_t>& first, const std::vector<uint64_t>& second, std::vector<uint64_t>& onlyFirst, std::vector<uint64_t>& onlySecond)
+{
+    size_t i = 0, j = 0;
+    onlyFirst.clear();
+    onlySecond.clear();
+    while( ( i < first.size()) && ( j < second.size()))
+    {
+        if( first[i] < second[j]) onlyFirst.push_back( first[i++]);
+        else if( second[j] < first[i]) onlySecond.push_back( second[j++]);
+        else
+        {
+            ++i;
+            ++j;
+        }
+    }
+    onlyFirst.insert( onlyFirst.end(), first.begin() + i, first.end());
+    onlySecond.insert( onlySecond.end(), second.begin() + j, second.end());
+}
+
+
+/**
+ * @brief Finds the nodes and edges that were added to or removed from a graph
+ *
+ * The ids of the nodes and edges of both graphs are collected in parallel, radix sorted and
+ * merged, so the whole comparison takes O(n + m) time.
+ *
+ * @param first The old graph
+ * @param second The new graph
+ * @param diff Filled with the nodes and edges of second that are not in first as added, and those of first that are not in second as removed
+ * @param firstIds The ids of the nodes of the old graph, such as PositionNodeIds
+ * @param secondIds The ids of the nodes of the new graph
+ *
+ * @author Panos Michail
+ *
+ */
+template<class FirstGraphType, class SecondGraphType, class FirstIdsType, class SecondIdsType>
+void diffGraphs( FirstGraphType& first, SecondGraphType& second, GraphDiff& diff, const FirstIdsType& firstIds, const SecondIdsType& secondIds)
+{
+    std::vector<uint64_t> firstNodes, firstEdges, secondNodes, secondEdges, added, removed;
+    {
+        CsrSnapshot<FirstGraphType> snapshot( first);
+        collectGraphKeys( snapshot, firstIds, firstNodes, firstEdges);
+    }
+    {
+        CsrSnapshot<SecondGraphType> snapshot( second);
+        collectGraphKeys( snapshot, secondIds, secondNodes, secondEdges);
+    }
+
+    diff.clear();
+    radixSort( firstNodes, 32);
+    radixSort( secondNodes, 32);
+    subtractSortedKeys( firstNodes, secondNodes, removed, added);
+    diff.addedNodes.assign( added.begin(), added.end());
+    diff.removedNodes.assign( removed.begin(), removed.end());
+
+    radixSort( firstEdges);
+    radixSort( secondEdges);
+    subtractSortedKeys( firstEdges, secondEdges, removed, added);
+    for( size_t i = 0; i < added.size(); ++i)
+    {
+        diff.addedEdges.push_back( GraphDiff::Edge( added[i] >> 32, added[i] & 0xFFFFFFFFULL));
+    }
+    for( size_t i = 0; i < removed.size(); ++i)
+    {
+        diff.removedEdges.push_back( GraphDiff::Edge( removed[i] >> 32, removed[i] & 0xFFFFFFFFULL));
+    }
+}
+
+
+/**
+ * @brief Finds the nodes and edges that were added to or removed from a graph, with the positions of the nodes as ids
+ */
+template<class FirstGraphType, class SecondGraphType>
+void diffGraphs( FirstGraphType& first, SecondGraphType& second, GraphDiff& diff)
+{
+    diffGraphs( first, second, diff, PositionNodeIds<FirstGraphType>(), PositionNodeIds<SecondGraphType>());
+}
+
+#endif //GRAPHCOMPARISON_H
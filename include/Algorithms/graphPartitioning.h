@@ -0,0 +1,435 @@
+#ifndef GRAPHPARTITIONING_H
+#define GRAPHPARTITIONING_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+/**
+ * @brief Partitions a graph into a uniform grid over the bounding box of the node coordinates
+ *
+ * Every node needs the fields x, y for its coordinates and cell, where the partitioner writes the
+ * cell the node belongs to. The grid has div x div cells, where div is the largest integer whose
+ * square does not exceed the requested number of cells.
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class GridPartitioner
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to partition
+     * @param numCells The requested number of cells
+     */
+    GridPartitioner( GraphType& graph, unsigned int numCells = 16):G(graph),m_div(1)
+    {
+        while( (m_div + 1) * (m_div + 1) <= numCells) ++m_div;
+    }
+
+    /**
+     * @brief Assigns every node of the graph to a cell
+     *
+     * @return The number of cells
+     */
+    unsigned int run()
+    {
+        std::cout << "Partitioning graph into a " << m_div << "x" << m_div << " grid...\n";
+        unsigned int xmax = 0, xmin = std::numeric_limits<unsigned int>::max(), ymax = 0, ymin = std::numeric_limits<unsigned int>::max();
+        NodeIterator u, lastNode;
+        for ( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            if ( u->x > xmax) xmax = u->x;
+            if ( u->x < xmin) xmin = u->x;
+            if ( u->y > ymax) ymax = u->y;
+            if ( u->y < ymin) ymin = u->y;
+        }
+
+        unsigned long long width = (unsigned long long)xmax - xmin + 1;
+        unsigned long long height = (unsigned long long)ymax - ymin + 1;
+        for ( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            unsigned int column = ((unsigned long long)(u->x - xmin) * m_div) / width;
+            unsigned int row = ((unsigned long long)(u->y - ymin) * m_div) / height;
+            u->cell = row * m_div + column;
+        }
+        return getNumCells();
+    }
+
+    unsigned int getNumCells() const
+    {
+        return m_div * m_div;
+    }
+
+private:
+    GraphType& G;
+    unsigned int m_div;
+};
+
+
+/**
+ * @brief Partitions a graph into cells of balanced size with small cuts, using recursive inertial flow bisection
+ *
+ * Each bisection sorts the nodes of a part along a few directions in the plane (horizontal, vertical
+ * and the two diagonals). For every direction the first and last fraction of the nodes are taken as
+ * sources and sinks and a minimum cut between them is computed on the underlying undirected graph
+ * with unit capacities. The direction with the smallest cut is kept. Both sides of every cut contain
+ * at least the balance fraction of the part, so the cells are balanced when the number of cells is
+ * a power of two.
+ *
+ * Every node needs the fields x, y for its coordinates and cell, where the partitioner writes the
+ * cell the node belongs to.
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class InertialFlowPartitioner
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+
+    /**
+     * @brief Constructor
+     *
+     * @param graph The graph to partition
+     * @param numCells The number of cells
+     * @param balance The fraction of the nodes of a part used as sources and as sinks in each bisection
+     */
+    InertialFlowPartitioner( GraphType& graph, unsigned int numCells = 16, double balance = 0.25):
+                                    G(graph),
+                                    m_numCells( numCells > 0 ? numCells : 1),
+                                    m_balance(balance),
+                                    m_stamp(0)
+    {
+    }
+
+    /**
+     * @brief Assigns every node of the graph to a cell
+     *
+     * @return The number of cells
+     */
+    unsigned int run()
+    {
+        std::cout << "Partitioning graph into " << m_numCells << " cells with inertial flow...\n";
+        buildAdjacency();
+
+        std::vector<unsigned int> nodes( m_nodes.size());
+        for( unsigned int i = 0; i < nodes.size(); ++i) nodes[i] = i;
+        m_cells.assign( m_nodes.size(), 0);
+        m_localId.assign( m_nodes.size(), 0);
+        m_visited.assign( m_nodes.size(), 0);
+        m_cutEdges = 0;
+
+        bisect( nodes, 0, m_numCells);
+
+        for( unsigned int i = 0; i < m_nodes.size(); ++i)
+        {
+            m_nodes[i]->cell = m_cells[i];
+        }
+        std::cout << "\tcut edges: " << m_cutEdges << "\n";
+        return m_numCells;
+    }
+
+    unsigned int getNumCells() const
+    {
+        return m_numCells;
+    }
+
+    /**
+     * @brief Returns the number of undirected edges cut by the last partitioning
+     */
+    unsigned int getCutEdges() const
+    {
+        return m_cutEdges;
+    }
+
+private:
+    GraphType& G;
+    unsigned int m_numCells;
+    double m_balance;
+    unsigned int m_stamp, m_cutEdges;
+
+    std::vector<NodeIterator> m_nodes;
+    std::vector<unsigned int> m_firstNeighbor, m_neighbors, m_cells, m_localId, m_visited;
+
+    // Flow network of the part that is currently being bisected, in local indices
+    std::vector<unsigned int> m_firstArc, m_head, m_mate;
+    std::vector<int> m_flow, m_level;
+    std::vector<unsigned int> m_currentArc;
+    std::vector<char> m_role;
+
+    enum { NONE = 0, SOURCE = 1, SINK = 2 };
+
+    /**
+     * @brief Builds a compact undirected adjacency of the graph, without loops and parallel edges
+     *
+     * The cell field of every node temporarily holds the index of the node.
+     */
+    void buildAdjacency()
+    {
+        NodeIterator u, v, lastNode;
+        EdgeIterator e, lastEdge;
+        InEdgeIterator k, lastInEdge;
+
+        m_nodes.clear();
+        for ( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            u->cell = m_nodes.size();
+            m_nodes.push_back(u);
+        }
+
+        m_firstNeighbor.assign( m_nodes.size() + 1, 0);
+        m_neighbors.clear();
+        std::vector<unsigned int> adjacent;
+        for( unsigned int i = 0; i < m_nodes.size(); ++i)
+        {
+            u = m_nodes[i];
+            adjacent.clear();
+            for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                v = G.target(e);
+                if( v->cell != i) adjacent.push_back( v->cell);
+            }
+            for( k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+            {
+                v = G.source(k);
+                if( v->cell != i) adjacent.push_back( v->cell);
+            }
+            std::sort( adjacent.begin(), adjacent.end());
+            adjacent.erase( std::unique( adjacent.begin(), adjacent.end()), adjacent.end());
+            m_neighbors.insert( m_neighbors.end(), adjacent.begin(), adjacent.end());
+            m_firstNeighbor[i+1] = m_neighbors.size();
+        }
+    }
+
+    void bisect( std::vector<unsigned int>& nodes, unsigned int firstCell, unsigned int numCells)
+    {
+        if( numCells <= 1 || nodes.size() <= 1)
+        {
+            for( unsigned int i = 0; i < nodes.size(); ++i) m_cells[nodes[i]] = firstCell;
+            return;
+        }
+
+        buildNetwork( nodes);
+
+        std::vector<char> side, bestSide;
+        unsigned int bestCut = std::numeric_limits<unsigned int>::max();
+        double bestImbalance = 1;
+        for( unsigned int direction = 0; direction < 4; ++direction)
+        {
+            unsigned int cut = computeCut( nodes, direction, side);
+            unsigned int sourceSide = std::count( side.begin(), side.end(), 1);
+            double imbalance = std::fabs( 0.5 - (double)sourceSide / nodes.size());
+            if( cut < bestCut || ( cut == bestCut && imbalance < bestImbalance))
+            {
+                bestCut = cut;
+                bestImbalance = imbalance;
+                bestSide.swap( side);
+            }
+        }
+        m_cutEdges += bestCut;
+
+        std::vector<unsigned int> first, second;
+        for( unsigned int i = 0; i < nodes.size(); ++i)
+        {
+            if( bestSide[i]) first.push_back( nodes[i]);
+            else second.push_back( nodes[i]);
+        }
+        std::vector<unsigned int>().swap( nodes);
+
+        unsigned int firstCells = numCells / 2;
+        bisect( first, firstCell, firstCells);
+        bisect( second, firstCell + firstCells, numCells - firstCells);
+    }
+
+    /**
+     * @brief Builds the unit capacity flow network induced by the nodes of a part
+     */
+    void buildNetwork( const std::vector<unsigned int>& nodes)
+    {
+        ++m_stamp;
+        for( unsigned int i = 0; i < nodes.size(); ++i)
+        {
+            m_visited[nodes[i]] = m_stamp;
+            m_localId[nodes[i]] = i;
+        }
+
+        m_firstArc.assign( nodes.size() + 1, 0);
+        m_head.clear();
+        for( unsigned int i = 0; i < nodes.size(); ++i)
+        {
+            for( unsigned int j = m_firstNeighbor[nodes[i]]; j < m_firstNeighbor[nodes[i]+1]; ++j)
+            {
+                if( m_visited[m_neighbors[j]] == m_stamp) m_head.push_back( m_localId[m_neighbors[j]]);
+            }
+            m_firstArc[i+1] = m_head.size();
+        }
+
+        // Every undirected edge is a pair of arcs, each one the reverse of the other
+        m_mate.resize( m_head.size());
+        for( unsigned int i = 0; i < nodes.size(); ++i)
+        {
+            for( unsigned int a = m_firstArc[i]; a < m_firstArc[i+1]; ++a)
+            {
+                unsigned int w = m_head[a];
+                m_mate[a] = std::lower_bound( m_head.begin() + m_firstArc[w], m_head.begin() + m_firstArc[w+1], i) - m_head.begin();
+            }
+        }
+    }
+
+    double project( const NodeIterator& u, unsigned int direction) const
+    {
+        switch( direction)
+        {
+            case 0: return u->x;
+            case 1: return u->y;
+            case 2: return (double)u->x + u->y;
+            default: return (double)u->x - u->y;
+        }
+    }
+
+    /**
+     * @brief Computes a minimum cut between the extreme nodes along a direction
+     *
+     * @param nodes The nodes of the part
+     * @param direction The projection direction
+     * @param side Set to 1 for the nodes on the source side of the cut and 0 otherwise
+     * @return The number of cut edges
+     */
+    unsigned int computeCut( const std::vector<unsigned int>& nodes, unsigned int direction, std::vector<char>& side)
+    {
+        unsigned int n = nodes.size();
+        std::vector< std::pair<double, unsigned int> > order( n);
+        for( unsigned int i = 0; i < n; ++i)
+        {
+            order[i] = std::make_pair( project( m_nodes[nodes[i]], direction), i);
+        }
+        std::sort( order.begin(), order.end());
+
+        unsigned int terminals = std::max( 1u, (unsigned int)( m_balance * n));
+        if( 2 * terminals > n) terminals = n / 2;
+        m_role.assign( n, NONE);
+        for( unsigned int i = 0; i < terminals; ++i)
+        {
+            m_role[order[i].second] = SOURCE;
+            m_role[order[n - 1 - i].second] = SINK;
+        }
+
+        m_flow.assign( m_head.size(), 0);
+        unsigned int flow = 0;
+        while( buildLevels( n))
+        {
+            m_currentArc.assign( m_firstArc.begin(), m_firstArc.end() - 1);
+            for( unsigned int s = 0; s < n; ++s)
+            {
+                if( m_role[s] != SOURCE) continue;
+                while( augment( s)) ++flow;
+            }
+        }
+
+        // The source side consists of the nodes reachable from the sources in the residual network
+        buildLevels( n);
+        side.assign( n, 0);
+        for( unsigned int i = 0; i < n; ++i)
+        {
+            if( m_level[i] >= 0 && m_role[i] != SINK) side[i] = 1;
+        }
+        return flow;
+    }
+
+    /**
+     * @brief Computes the BFS levels of the residual network from all sources
+     *
+     * @return True if some sink is reachable
+     */
+    bool buildLevels( unsigned int n)
+    {
+        m_level.assign( n, -1);
+        std::vector<unsigned int> queue;
+        queue.reserve( n);
+        for( unsigned int i = 0; i < n; ++i)
+        {
+            if( m_role[i] == SOURCE)
+            {
+                m_level[i] = 0;
+                queue.push_back(i);
+            }
+        }
+
+        bool reachedSink = false;
+        for( unsigned int head = 0; head < queue.size(); ++head)
+        {
+            unsigned int v = queue[head];
+            if( m_role[v] == SINK)
+            {
+                reachedSink = true;
+                continue;
+            }
+            for( unsigned int a = m_firstArc[v]; a < m_firstArc[v+1]; ++a)
+            {
+                unsigned int w = m_head[a];
+                if( m_level[w] < 0 && m_flow[a] < 1)
+                {
+                    m_level[w] = m_level[v] + 1;
+                    queue.push_back(w);
+                }
+            }
+        }
+        return reachedSink;
+    }
+
+    /**
+     * @brief Finds an augmenting path from a source along the level graph and pushes a unit of flow over it
+     */
+    bool augment( unsigned int s)
+    {
+        std::vector<unsigned int> path;
+        unsigned int v = s;
+        while( true)
+        {
+            if( m_role[v] == SINK)
+            {
+                for( unsigned int i = 0; i < path.size(); ++i)
+                {
+                    ++m_flow[path[i]];
+                    --m_flow[m_mate[path[i]]];
+                }
+                return true;
+            }
+
+            bool advanced = false;
+            for( ; m_currentArc[v] < m_firstArc[v+1]; ++m_currentArc[v])
+            {
+                unsigned int a = m_currentArc[v];
+                unsigned int w = m_head[a];
+                if( m_flow[a] < 1 && m_level[w] == m_level[v] + 1)
+                {
+                    path.push_back(a);
+                    v = w;
+                    advanced = true;
+                    break;
+                }
+            }
+            if( advanced) continue;
+
+            // Dead end, retreat
+            m_level[v] = -1;
+            if( path.empty()) return false;
+            v = m_head[m_mate[path.back()]];
+            path.pop_back();
+            ++m_currentArc[v];
+        }
+    }
+};
+
+#endif//GRAPHPARTITIONING_H
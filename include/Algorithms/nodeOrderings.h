@@ -0,0 +1,255 @@
+#ifndef NODEORDERINGS_H
+#define NODEORDERINGS_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Utilities/graphIO.h>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+
+/**
+ * Orders of the nodes of a graph for DynamicGraph::reorder. Each one puts nodes that are likely
+ * to be visited together close to each other, so that graph searches mostly access memory that
+ * is already in the cache.
+ *
+ * The searches follow edges in both directions, so that one way streets do not separate
+ * neighbouring nodes. The spatial orders need the node fields x and y, and the cell order the
+ * field cell of a partitioner (see graphPartitioning.h).
+ */
+
+
+/**
+ * @brief Orders the nodes by breadth first search, starting from the first unvisited node of the current order
+ *
+ * @param G The graph
+ * @param order Filled with the descriptors of the nodes in the new order
+ */
+template<class GraphType>
+void getBfsOrder( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& order)
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    NodeIndexMap<GraphType> index;
+    index.init( G);
+    std::vector<bool> isVisited( G.getNumNodes(), false);
+    std::vector<NodeIterator> queue;
+    queue.reserve( G.getNumNodes());
+    order.clear();
+    order.reserve( G.getNumNodes());
+
+    for( NodeIterator root = G.beginNodes(), lastNode = G.endNodes(); root != lastNode; ++root)
+    {
+        if( isVisited[ index[root]]) continue;
+        isVisited[ index[root]] = true;
+        queue.clear();
+        queue.push_back( root);
+        for( SizeType head = 0; head < queue.size(); ++head)
+        {
+            NodeIterator u = queue[head];
+            order.push_back( G.getNodeDescriptor( u));
+            for( EdgeIterator e = G.beginEdges(u), end = G.endEdges(u); e != end; ++e)
+            {
+                NodeIterator v = G.target(e);
+                if( isVisited[ index[v]]) continue;
+                isVisited[ index[v]] = true;
+                queue.push_back( v);
+            }
+            for( InEdgeIterator k = G.beginInEdges(u), end = G.endInEdges(u); k != end; ++k)
+            {
+                NodeIterator v = G.source(k);
+                if( isVisited[ index[v]]) continue;
+                isVisited[ index[v]] = true;
+                queue.push_back( v);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Orders the nodes by depth first search, starting from the first unvisited node of the current order
+ *
+ * @param G The graph
+ * @param order Filled with the descriptors of the nodes in the new order
+ */
+template<class GraphType>
+void getDfsOrder( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& order)
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+
+    NodeIndexMap<GraphType> index;
+    index.init( G);
+    std::vector<bool> isVisited( G.getNumNodes(), false);
+    std::vector<NodeIterator> stack;
+    order.clear();
+    order.reserve( G.getNumNodes());
+
+    for( NodeIterator root = G.beginNodes(), lastNode = G.endNodes(); root != lastNode; ++root)
+    {
+        stack.push_back( root);
+        while( !stack.empty())
+        {
+            NodeIterator u = stack.back();
+            stack.pop_back();
+            if( isVisited[ index[u]]) continue;
+            isVisited[ index[u]] = true;
+            order.push_back( G.getNodeDescriptor( u));
+
+            // Pushed in reverse, so that the neighbours are visited in the order of the edges
+            for( InEdgeIterator k = G.endInEdges(u), begin = G.beginInEdges(u); k != begin; )
+            {
+                --k;
+                NodeIterator v = G.source(k);
+                if( !isVisited[ index[v]]) stack.push_back( v);
+            }
+            for( EdgeIterator e = G.endEdges(u), begin = G.beginEdges(u); e != begin; )
+            {
+                --e;
+                NodeIterator v = G.target(e);
+                if( !isVisited[ index[v]]) stack.push_back( v);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns the position of a cell on the Hilbert curve that fills a 2^16 x 2^16 grid
+ */
+inline uint64_t getHilbertIndex( uint32_t x, uint32_t y)
+{
+    const uint32_t n = 1 << 16;
+    uint64_t d = 0;
+    for( uint32_t s = n >> 1; s > 0; s >>= 1)
+    {
+        uint32_t rx = ( x & s) > 0;
+        uint32_t ry = ( y & s) > 0;
+        d += uint64_t(s) * s * ( ( 3 * rx) ^ ry);
+
+        // Rotate the quadrant, so that the curve is continuous
+        if( ry == 0)
+        {
+            if( rx == 1)
+            {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap( x, y);
+        }
+    }
+    return d;
+}
+
+/**
+ * @brief Returns the position of a cell on the Z-order curve of a 2^16 x 2^16 grid, by interleaving the bits of x and y
+ */
+inline uint64_t getZIndex( uint32_t x, uint32_t y)
+{
+    uint64_t key = 0;
+    for( unsigned int bit = 0; bit < 16; ++bit)
+    {
+        key |= uint64_t( ( x >> bit) & 1) << ( 2 * bit);
+        key |= uint64_t( ( y >> bit) & 1) << ( 2 * bit + 1);
+    }
+    return key;
+}
+
+/**
+ * @brief Orders the nodes along a space filling curve over a 2^16 x 2^16 grid on the bounding box of the coordinates
+ *
+ * @param G The graph
+ * @param order Filled with the descriptors of the nodes in the new order
+ * @param curveIndex The position of a grid cell on the curve
+ */
+template<class GraphType>
+void getSpaceFillingCurveOrder( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& order, uint64_t (*curveIndex)( uint32_t, uint32_t))
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = -std::numeric_limits<double>::max(), maxY = maxX;
+    std::vector<NodeIterator> nodes;
+    nodes.reserve( G.getNumNodes());
+    for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+    {
+        minX = std::min( minX, double( u->x));
+        minY = std::min( minY, double( u->y));
+        maxX = std::max( maxX, double( u->x));
+        maxY = std::max( maxY, double( u->y));
+        nodes.push_back( u);
+    }
+    double scaleX = ( maxX > minX) ? 65535.0 / ( maxX - minX) : 0;
+    double scaleY = ( maxY > minY) ? 65535.0 / ( maxY - minY) : 0;
+
+    std::vector< std::pair<uint64_t,SizeType> > keys( nodes.size());
+    for( SizeType i = 0; i < nodes.size(); ++i)
+    {
+        uint32_t x = uint32_t( ( nodes[i]->x - minX) * scaleX);
+        uint32_t y = uint32_t( ( nodes[i]->y - minY) * scaleY);
+        keys[i] = std::make_pair( curveIndex( x, y), i);
+    }
+    std::sort( keys.begin(), keys.end());
+
+    order.resize( nodes.size());
+    for( SizeType i = 0; i < nodes.size(); ++i)
+    {
+        order[i] = G.getNodeDescriptor( nodes[ keys[i].second]);
+    }
+}
+
+/**
+ * @brief Orders the nodes along the Hilbert curve of their coordinates
+ */
+template<class GraphType>
+void getHilbertOrder( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& order)
+{
+    getSpaceFillingCurveOrder( G, order, &getHilbertIndex);
+}
+
+/**
+ * @brief Orders the nodes along the Z-order curve of their coordinates
+ */
+template<class GraphType>
+void getZOrder( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& order)
+{
+    getSpaceFillingCurveOrder( G, order, &getZIndex);
+}
+
+/**
+ * @brief Orders the nodes by their cell. The nodes of a cell keep their current order
+ *
+ * Reordering a graph by a spatial order first makes the cells internally local too.
+ *
+ * @param G The graph
+ * @param order Filled with the descriptors of the nodes in the new order
+ */
+template<class GraphType>
+void getCellOrder( GraphType& G, std::vector<typename GraphType::NodeDescriptor>& order)
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    std::vector< std::pair<unsigned int,SizeType> > keys;
+    std::vector<NodeIterator> nodes;
+    keys.reserve( G.getNumNodes());
+    nodes.reserve( G.getNumNodes());
+    for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+    {
+        keys.push_back( std::make_pair( (unsigned int)( u->cell), SizeType( nodes.size())));
+        nodes.push_back( u);
+    }
+    std::sort( keys.begin(), keys.end());
+
+    order.resize( nodes.size());
+    for( SizeType i = 0; i < nodes.size(); ++i)
+    {
+        order[i] = G.getNodeDescriptor( nodes[ keys[i].second]);
+    }
+}
+
+#endif //NODEORDERINGS_H
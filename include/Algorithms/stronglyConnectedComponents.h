@@ -0,0 +1,492 @@
+#ifndef STRONGLYCONNECTEDCOMPONENTS_H
+#define STRONGLYCONNECTEDCOMPONENTS_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Structs/Graphs/csrSnapshot.h>
+#include <Structs/Graphs/hotColdPayload.h>
+#include <Utilities/parallel.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+/**
+ * Strongly connected components of directed graphs. The components are computed on a
+ * CsrSnapshot of the graph and are written to an array, where the component of the i-th node
+ * of the graph (in the order of beginNodes) is at position i. No fields in the nodes are needed.
+ */
+
+
+/**
+ * @brief Finds the strongly connected components with an iterative version of Tarjan's algorithm
+ *
+ * The algorithm takes linear time and keeps its own stack of calls, so long paths can not
+ * overflow the call stack. The components are numbered in reverse topological order: no edge
+ * leads from a component to one with a larger number.
+ *
+ * @param G The snapshot of the graph
+ * @param components Filled with the component of every node
+ * @return The number of components
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+typename CsrSnapshot<GraphType>::SizeType tarjanStronglyConnectedComponents( const CsrSnapshot<GraphType>& G, std::vector<typename CsrSnapshot<GraphType>::SizeType>& components)
+{
+    typedef typename CsrSnapshot<GraphType>::SizeType SizeType;
+
+    const SizeType unvisited = std::numeric_limits<SizeType>::max();
+    const std::vector<SizeType>& offsets = G.getOffsets();
+    const std::vector<SizeType>& targets = G.getTargets();
+    SizeType numNodes = G.getNumNodes();
+
+    // A node is on the stack if it is visited and has no component yet
+    std::vector<SizeType> order( numNodes, unvisited), lowLink( numNodes);
+    std::vector<SizeType> stack;
+    std::vector< std::pair<SizeType,SizeType> > calls;
+    components.assign( numNodes, unvisited);
+    SizeType numVisited = 0, numComponents = 0;
+
+    for( SizeType root = 0; root < numNodes; ++root)
+    {
+        if( order[root] != unvisited) continue;
+        order[root] = lowLink[root] = numVisited++;
+        stack.push_back( root);
+        calls.push_back( std::make_pair( root, offsets[root]));
+
+        while( !calls.empty())
+        {
+            SizeType u = calls.back().first;
+            if( calls.back().second < offsets[u+1])
+            {
+                SizeType v = targets[ calls.back().second++];
+                if( order[v] == unvisited)
+                {
+                    order[v] = lowLink[v] = numVisited++;
+                    stack.push_back( v);
+                    calls.push_back( std::make_pair( v, offsets[v]));
+                }
+                else if( components[v] == unvisited)
+                {
+                    lowLink[u] = std::min( lowLink[u], order[v]);
+                }
+                continue;
+            }
+
+            calls.pop_back();
+            if( !calls.empty())
+            {
+                SizeType parent = calls.back().first;
+                lowLink[parent] = std::min( lowLink[parent], lowLink[u]);
+            }
+
+            if( lowLink[u] == order[u])
+            {
+                SizeType v;
+                do
+                {
+                    v = stack.back();
+                    stack.pop_back();
+                    components[v] = numComponents;
+                }
+                while( v != u);
+                ++numComponents;
+            }
+        }
+    }
+
+    return numComponents;
+}
+
+
+/**
+ * @class ForwardBackwardScc
+ *
+ * @brief Finds the strongly connected components in parallel, by trimming, forward-backward search and coloring
+ *
+ * First, nodes without incoming or outgoing edges are trimmed as components of their own, for
+ * a few rounds. Then the component of a node of high degree is found as the nodes that are
+ * reached from it both forwards and backwards; in most real graphs it is the largest one by
+ * far. The remaining nodes are colored by the largest node number that reaches them, and every
+ * node that keeps its own color collects its component backwards among the nodes of its color.
+ * Coloring is repeated until all the nodes have a component (Slota et al., 2014).
+ *
+ * All the steps run in parallel when compiled with -fopenmp. The numbers of the components
+ * then depend on the order of the threads.
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class ForwardBackwardScc
+{
+public:
+    typedef CsrSnapshot<GraphType>              Snapshot;
+    typedef typename Snapshot::SizeType         SizeType;
+
+    ForwardBackwardScc( const Snapshot& G):G(G),m_components(0),m_numComponents(0)
+    {
+    }
+
+    /**
+     * @brief Finds the components
+     *
+     * @param components Filled with the component of every node
+     * @return The number of components
+     */
+    SizeType run( std::vector<SizeType>& components)
+    {
+        m_components = &components;
+        m_numComponents = 0;
+        components.assign( G.getNumNodes(), unassigned());
+        if( G.getNumNodes() == 0) return 0;
+
+        trim();
+        findPivotComponent();
+        trim();
+        while( colorComponents())
+        {
+        }
+        return m_numComponents;
+    }
+
+private:
+    const Snapshot&                         G;
+    std::vector<SizeType>*                  m_components;
+    SizeType                                m_numComponents;
+    std::vector<SizeType>                   m_marks;
+    std::vector<SizeType>                   m_colors;
+    std::vector<SizeType>                   m_frontier;
+    std::vector< std::vector<SizeType> >    m_threadFrontiers;
+
+    static SizeType unassigned()
+    {
+        return std::numeric_limits<SizeType>::max();
+    }
+
+    bool isActive( SizeType u) const
+    {
+        return (*m_components)[u] == unassigned();
+    }
+
+    bool hasActiveNeighbor( SizeType u, const std::vector<SizeType>& offsets, const std::vector<SizeType>& nodes) const
+    {
+        for( SizeType k = offsets[u]; k < offsets[u+1]; ++k)
+        {
+            if( ( nodes[k] != u) && isActive( nodes[k])) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Makes every node without active incoming or outgoing edges a component
+     *
+     * A node may miss a neighbour that is trimmed at the same time by another thread. It is
+     * then trimmed in the next round, so the result does not depend on the order of the threads.
+     */
+    void trim()
+    {
+        const unsigned int maxRounds = 8;
+        for( unsigned int round = 0; round < maxRounds; ++round)
+        {
+            SizeType numTrimmed = 0;
+            #pragma omp parallel for schedule(dynamic, 1024) reduction(+:numTrimmed)
+            for( long i = 0; i < (long)G.getNumNodes(); ++i)
+            {
+                SizeType u = i;
+                if( !isActive(u)) continue;
+                if( hasActiveNeighbor( u, G.getOffsets(), G.getTargets()) && hasActiveNeighbor( u, G.getInOffsets(), G.getSources())) continue;
+                (*m_components)[u] = fetchAndAdd( &m_numComponents, 1);
+                ++numTrimmed;
+            }
+            if( !numTrimmed) break;
+        }
+    }
+
+    /**
+     * @brief Marks with newMark the active nodes with oldMark that are reached from a root
+     */
+    void reach( SizeType root, const std::vector<SizeType>& offsets, const std::vector<SizeType>& nodes, SizeType oldMark, SizeType newMark)
+    {
+        m_marks[root] = newMark;
+        m_frontier.assign( 1, root);
+        m_threadFrontiers.resize( getNumThreads());
+
+        while( !m_frontier.empty())
+        {
+            for( SizeType t = 0; t < m_threadFrontiers.size(); ++t) m_threadFrontiers[t].clear();
+
+            #pragma omp parallel for schedule(dynamic, 64)
+            for( long i = 0; i < (long)m_frontier.size(); ++i)
+            {
+                std::vector<SizeType>& next = m_threadFrontiers[ getThreadIndex()];
+                SizeType u = m_frontier[i];
+                for( SizeType k = offsets[u]; k < offsets[u+1]; ++k)
+                {
+                    SizeType v = nodes[k];
+                    if( ( m_marks[v] == oldMark) && isActive(v) && compareAndSwap( &m_marks[v], oldMark, newMark))
+                    {
+                        next.push_back( v);
+                    }
+                }
+            }
+
+            m_frontier.clear();
+            for( SizeType t = 0; t < m_threadFrontiers.size(); ++t)
+            {
+                m_frontier.insert( m_frontier.end(), m_threadFrontiers[t].begin(), m_threadFrontiers[t].end());
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the component of the active node with the most paths through it, by a forward and a backward search
+     */
+    void findPivotComponent()
+    {
+        const std::vector<SizeType>& offsets = G.getOffsets();
+        const std::vector<SizeType>& inOffsets = G.getInOffsets();
+        SizeType pivot = unassigned();
+        unsigned long long maxDegreeProduct = 0;
+        for( SizeType u = 0; u < G.getNumNodes(); ++u)
+        {
+            if( !isActive(u)) continue;
+            unsigned long long degreeProduct = (unsigned long long)( offsets[u+1] - offsets[u]) * ( inOffsets[u+1] - inOffsets[u]);
+            if( ( pivot == unassigned()) || ( degreeProduct > maxDegreeProduct))
+            {
+                pivot = u;
+                maxDegreeProduct = degreeProduct;
+            }
+        }
+        if( pivot == unassigned()) return;
+
+        // Forward reached nodes are marked 1, and those of them reached backwards too are marked 2
+        m_marks.assign( G.getNumNodes(), 0);
+        reach( pivot, offsets, G.getTargets(), 0, 1);
+        reach( pivot, inOffsets, G.getSources(), 1, 2);
+
+        SizeType component = m_numComponents++;
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)G.getNumNodes(); ++i)
+        {
+            if( m_marks[i] == 2) (*m_components)[i] = component;
+        }
+        std::vector<SizeType>().swap( m_marks);
+    }
+
+    /**
+     * @brief Colors the active nodes and collects the component of every node that keeps its own color
+     *
+     * @return False if there were no active nodes
+     */
+    bool colorComponents()
+    {
+        const std::vector<SizeType>& offsets = G.getOffsets();
+        const std::vector<SizeType>& targets = G.getTargets();
+        m_colors.resize( G.getNumNodes());
+
+        SizeType numActive = 0;
+        #pragma omp parallel for schedule(static) reduction(+:numActive)
+        for( long i = 0; i < (long)G.getNumNodes(); ++i)
+        {
+            if( !isActive(i)) continue;
+            m_colors[i] = i;
+            ++numActive;
+        }
+        if( !numActive) return false;
+
+        // Every node takes the largest color of the nodes that reach it
+        SizeType numChanged = 1;
+        while( numChanged)
+        {
+            numChanged = 0;
+            #pragma omp parallel for schedule(dynamic, 1024) reduction(+:numChanged)
+            for( long i = 0; i < (long)G.getNumNodes(); ++i)
+            {
+                SizeType u = i;
+                if( !isActive(u)) continue;
+                SizeType color = m_colors[u];
+                for( SizeType k = offsets[u]; k < offsets[u+1]; ++k)
+                {
+                    SizeType v = targets[k];
+                    if( !isActive(v)) continue;
+                    for( SizeType previous = m_colors[v]; previous < color; previous = m_colors[v])
+                    {
+                        if( compareAndSwap( &m_colors[v], previous, color))
+                        {
+                            ++numChanged;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<SizeType> roots;
+        for( SizeType u = 0; u < G.getNumNodes(); ++u)
+        {
+            if( isActive(u) && ( m_colors[u] == u)) roots.push_back( u);
+        }
+
+        // The nodes of a color are only visited by the search of its root
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( long i = 0; i < (long)roots.size(); ++i)
+        {
+            collectComponent( roots[i]);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Gives a component to the nodes of the color of a root that reach the root
+     */
+    void collectComponent( SizeType root)
+    {
+        const std::vector<SizeType>& inOffsets = G.getInOffsets();
+        const std::vector<SizeType>& sources = G.getSources();
+        SizeType component = fetchAndAdd( &m_numComponents, 1);
+        std::vector<SizeType> stack( 1, root);
+        (*m_components)[root] = component;
+
+        while( !stack.empty())
+        {
+            SizeType u = stack.back();
+            stack.pop_back();
+            for( SizeType k = inOffsets[u]; k < inOffsets[u+1]; ++k)
+            {
+                SizeType v = sources[k];
+                if( ( m_colors[v] != root) || !isActive(v)) continue;
+                (*m_components)[v] = component;
+                stack.push_back( v);
+            }
+        }
+    }
+};
+
+
+/**
+ * @brief Finds the strongly connected components of a graph
+ *
+ * @param G The graph
+ * @param components Filled with the component of every node, in the order of the nodes of the graph
+ * @param inParallel Whether to use the parallel ForwardBackwardScc instead of Tarjan's algorithm
+ * @return The number of components
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+typename GraphType::SizeType findStronglyConnectedComponents( GraphType& G, std::vector<typename GraphType::SizeType>& components, bool inParallel = false)
+{
+    CsrSnapshot<GraphType> snapshot( G);
+    if( inParallel)
+    {
+        ForwardBackwardScc<GraphType> scc( snapshot);
+        return scc.run( components);
+    }
+    return tarjanStronglyConnectedComponents( snapshot, components);
+}
+
+
+/**
+ * @brief Finds the strongly connected components of a graph and stores them in the field component of the nodes
+ *
+ * @param G The graph
+ * @return The number of components
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+unsigned int findStronglyConnectedComponents( GraphType& G)
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    std::vector<SizeType> components;
+    SizeType numComponents = findStronglyConnectedComponents( G, components);
+    SizeType i = 0;
+    for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++i)
+    {
+        u->component = components[i];
+    }
+    return numComponents;
+}
+
+
+/**
+ * @brief Copies the largest strongly connected component of a graph into another graph, built in one batch
+ *
+ * Road networks contain small pieces, such as the ends of one way streets, that can not be
+ * left or entered. Searches and preprocessing usually run on the largest component only. The
+ * node and edge data are copied; the cold parts of HotColdPayload data are not.
+ *
+ * @param G The graph
+ * @param H The graph to build. Its node and edge data must be those of G
+ * @param ids Filled with the descriptors of the nodes of H
+ * @param origins Filled with the descriptors in G of the nodes of H
+ * @param inParallel Whether to find the components in parallel
+ * @return The number of nodes of the component
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType, class ComponentGraphType>
+typename GraphType::SizeType extractLargestStronglyConnectedComponent( GraphType& G, ComponentGraphType& H, std::vector<typename ComponentGraphType::NodeDescriptor>& ids, std::vector<typename GraphType::NodeDescriptor>& origins, bool inParallel = false)
+{
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef typename GraphType::NodeData        NodeData;
+    typedef typename GraphType::EdgeData        EdgeData;
+
+    std::vector<SizeType> components;
+    SizeType numComponents = findStronglyConnectedComponents( G, components, inParallel);
+
+    std::vector<SizeType> componentSizes( numComponents, 0);
+    for( SizeType i = 0; i < components.size(); ++i)
+    {
+        ++componentSizes[ components[i]];
+    }
+    SizeType largest = std::max_element( componentSizes.begin(), componentSizes.end()) - componentSizes.begin();
+
+    // The nodes of the component keep their order
+    const SizeType none = std::numeric_limits<SizeType>::max();
+    std::vector<SizeType> newIds( components.size(), none);
+    std::vector<NodeIterator> nodes;
+    origins.clear();
+    SizeType i = 0;
+    for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++i)
+    {
+        if( numComponents && ( components[i] == largest))
+        {
+            newIds[i] = nodes.size();
+            nodes.push_back( u);
+            origins.push_back( G.getNodeDescriptor( u));
+        }
+    }
+
+    NodeIndexMap<GraphType> index;
+    index.init( G);
+    std::vector< std::pair<SizeType,SizeType> > edges;
+    std::vector<EdgeData> edgeData;
+    for( i = 0; i < nodes.size(); ++i)
+    {
+        for( EdgeIterator e = G.beginEdges( nodes[i]), lastEdge = G.endEdges( nodes[i]); e != lastEdge; ++e)
+        {
+            SizeType target = newIds[ index[ G.target(e)]];
+            if( target == none) continue;
+            edges.push_back( std::make_pair( i, target));
+            edgeData.push_back( *e);
+        }
+    }
+
+    H.buildFromEdgeList( nodes.size(), edges, edgeData, ids);
+    for( i = 0; i < nodes.size(); ++i)
+    {
+        ColdDataStorage<NodeData>::assign( *H.getNodeIterator( ids[i]), *nodes[i]);
+    }
+    return nodes.size();
+}
+
+#endif //STRONGLYCONNECTEDCOMPONENTS_H
@@ -0,0 +1,135 @@
+#ifndef TOPOLOGICALORDERING_H
+#define TOPOLOGICALORDERING_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Structs/Graphs/csrSnapshot.h>
+#include <Utilities/parallel.h>
+#include <vector>
+
+/**
+ * @brief Finds a topological order of the nodes with Kahn's algorithm, one level at a time
+ *
+ * The nodes without incoming edges form the first level. Every node of a level removes its
+ * outgoing edges, and the nodes that are left without incoming edges form the next level. The
+ * in-degrees are computed and the nodes of a level are processed in parallel (compile with
+ * -fopenmp), with atomic decrements of the in-degrees. The whole order takes linear time. With
+ * more than one thread, the order of the nodes inside a level may differ between runs.
+ *
+ * @param G The snapshot of the graph
+ * @param order Filled with the numbers of the nodes in topological order. If the graph has a cycle, it holds only the nodes that no cycle reaches
+ * @param levelOffsets If given, filled with the position in order of the first node of every level, followed by the size of order
+ * @return False if the graph has a cycle
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+bool topologicalOrder( const CsrSnapshot<GraphType>& G, std::vector<typename CsrSnapshot<GraphType>::SizeType>& order, std::vector<typename CsrSnapshot<GraphType>::SizeType>* levelOffsets = 0)
+{
+    typedef typename CsrSnapshot<GraphType>::SizeType SizeType;
+
+    const std::vector<SizeType>& offsets = G.getOffsets();
+    const std::vector<SizeType>& targets = G.getTargets();
+    const std::vector<SizeType>& inOffsets = G.getInOffsets();
+    SizeType numNodes = G.getNumNodes();
+
+    std::vector<SizeType> inDegrees( numNodes);
+    std::vector< std::vector<SizeType> > threadLevels( getNumThreads());
+
+    #pragma omp parallel for schedule(static)
+    for( long i = 0; i < (long)numNodes; ++i)
+    {
+        inDegrees[i] = inOffsets[i+1] - inOffsets[i];
+        if( !inDegrees[i]) threadLevels[ getThreadIndex()].push_back( i);
+    }
+
+    order.clear();
+    order.reserve( numNodes);
+    if( levelOffsets) levelOffsets->clear();
+
+    // The nodes of the current level are order[levelStart] to order[levelEnd - 1]
+    SizeType levelStart = 0;
+    for( SizeType t = 0; t < threadLevels.size(); ++t)
+    {
+        order.insert( order.end(), threadLevels[t].begin(), threadLevels[t].end());
+    }
+
+    while( levelStart < order.size())
+    {
+        SizeType levelEnd = order.size();
+        if( levelOffsets) levelOffsets->push_back( levelStart);
+        for( SizeType t = 0; t < threadLevels.size(); ++t) threadLevels[t].clear();
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for( long i = levelStart; i < (long)levelEnd; ++i)
+        {
+            std::vector<SizeType>& next = threadLevels[ getThreadIndex()];
+            SizeType u = order[i];
+            for( SizeType k = offsets[u]; k < offsets[u+1]; ++k)
+            {
+                SizeType v = targets[k];
+                if( fetchAndAdd( &inDegrees[v], SizeType(-1)) == 1) next.push_back( v);
+            }
+        }
+
+        for( SizeType t = 0; t < threadLevels.size(); ++t)
+        {
+            order.insert( order.end(), threadLevels[t].begin(), threadLevels[t].end());
+        }
+        levelStart = levelEnd;
+    }
+
+    if( levelOffsets) levelOffsets->push_back( order.size());
+    return order.size() == numNodes;
+}
+
+
+/**
+ * @brief Finds a topological order of the nodes of a graph
+ *
+ * @param G The graph
+ * @param order Filled with the nodes in topological order. If the graph has a cycle, it holds only the nodes that no cycle reaches
+ * @return False if the graph has a cycle
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+bool topologicalSort( GraphType& G, std::vector<typename GraphType::NodeIterator>& order)
+{
+    typedef typename GraphType::SizeType        SizeType;
+
+    CsrSnapshot<GraphType> snapshot( G);
+    std::vector<SizeType> numbers;
+    bool isAcyclic = topologicalOrder( snapshot, numbers);
+
+    order.resize( numbers.size());
+    #pragma omp parallel for schedule(static)
+    for( long i = 0; i < (long)numbers.size(); ++i)
+    {
+        order[i] = snapshot.getNode( numbers[i]);
+    }
+    return isAcyclic;
+}
+
+
+/**
+ * @brief Checks whether a graph has a topological order, that is whether it has no cycles
+ *
+ * @param G The graph
+ * @return False if the graph has a cycle
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+bool topologicalSort( GraphType& G)
+{
+    typedef typename GraphType::SizeType        SizeType;
+
+    CsrSnapshot<GraphType> snapshot( G);
+    std::vector<SizeType> order;
+    return topologicalOrder( snapshot, order);
+}
+
+#endif //TOPOLOGICALORDERING_H
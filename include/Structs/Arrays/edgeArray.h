@@ -2,23 +2,36 @@
 #define EDGEARRAY_H
 
 #include <Structs/Graphs/dynamicGraph.h>
-#include <Structs/Maps/pmMap.h>
+#include <Structs/Arrays/poolArray.h>
 
+/**
+ * @class EdgeArray
+ *
+ * @brief Data associated with the edges of a packed memory graph, found in constant time
+ *
+ * The values are kept in a flat array aligned with the edge array of the graph, and they move
+ * along with the edges (see PoolArray). An incoming edge has the value of its edge.
+ *
+ * @author Panos Michail
+ *
+ */
 template< typename dataType, typename GraphType>
 class EdgeArray
 {
 public:
 
-    typedef GraphType                       Graph;
-    typedef typename Graph::NodeIterator    node;
-    typedef typename Graph::EdgeIterator    edge;
-    typedef typename Graph::SizeType        sizeType;
+    typedef GraphType                                       Graph;
+    typedef typename Graph::NodeIterator                    node;
+    typedef typename Graph::EdgeIterator                    edge;
+    typedef typename Graph::InEdgeIterator                  inEdge;
+    typedef typename Graph::SizeType                        sizeType;
+    typedef typename Graph::Implementation::EdgeElement     EdgeElement;
 
     EdgeArray():m_G(0)
     {
     }
 
-    EdgeArray( const Graph* G, dataType data = dataType()):m_G(G)
+    EdgeArray( Graph* G, dataType data = dataType()):m_G(0)
     {
         init(G, data);
     }
@@ -27,37 +40,25 @@ public:
     {
     }
 
-    void init( const Graph* G, dataType data = dataType())
+    void init( Graph* G, dataType data = dataType())
     {
-        m_map.clear();
         m_G = G;
-        
-        node u, lastNode;
-        edge e, lastEdge;
-        for( u = G->beginNodes(), lastNode = G->endNodes(); u != lastNode; ++u)
-        {
-            for( e = G->beginNodes(), lastEdge = G->endNodes(); e != lastEdge; ++e)
-            {   
-                m_map[e->getDescriptor()] = data;
-            }
-        }
+        m_values.init( m_G->impl->m_edges, data);
     }
 
     dataType& operator[] ( const edge& e )
     {
-        return  m_map[ e->getDescriptor()];
+        return m_values.at( e.getAddress());
     }
-	
-	const dataType& operator[] ( const edge& e ) const
+
+    dataType& operator[] ( const inEdge& k )
     {
-		return  m_map[ e->getDescriptor()];
+        return m_values.at( k->m_edge);
     }
 
 private:
-    const GraphType*                                        m_G;
-    PMMap< typename GraphType::EdgeDescriptor, dataType>    m_map;
+    Graph*                              m_G;
+    PoolArray< EdgeElement, dataType>   m_values;
 };
 
-
-
 #endif //EDGEARRAY_H
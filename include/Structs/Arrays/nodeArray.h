@@ -2,23 +2,35 @@
 #define NODEARRAY_H
 
 #include <Structs/Graphs/dynamicGraph.h>
-#include <Structs/Maps/pmMap.h>
-
-
+#include <Structs/Arrays/poolArray.h>
+
+
+/**
+ * @class NodeArray
+ *
+ * @brief Data associated with the nodes of a packed memory graph, found in constant time
+ *
+ * The values are kept in a flat array aligned with the node array of the graph, and they move
+ * along with the nodes (see PoolArray).
+ *
+ * @author Panos Michail
+ *
+ */
 template< typename dataType, typename GraphType>
 class NodeArray
 {
 public:
 
-    typedef GraphType                       Graph;
-    typedef typename Graph::NodeIterator    node;
-    typedef typename Graph::SizeType        sizeType;
+    typedef GraphType                                       Graph;
+    typedef typename Graph::NodeIterator                    node;
+    typedef typename Graph::SizeType                        sizeType;
+    typedef typename Graph::Implementation::NodeElement     NodeElement;
 
     NodeArray():m_G(0)
     {
     }
 
-    NodeArray( const Graph* G, dataType data = dataType()):m_G(G)
+    NodeArray( Graph* G, dataType data = dataType()):m_G(0)
     {
         init(G, data);
     }
@@ -27,31 +39,20 @@ public:
     {
     }
 
-    void init( const Graph* G, dataType data = dataType())
+    void init( Graph* G, dataType data = dataType())
     {
-        m_map.clear();
         m_G = G;
-        
-        node u, end;
-        for( u = G->beginNodes(), end = G->endNodes(); u != end; ++u)
-        {
-            m_map[u->getDescriptor()] = data;
-        }
+        m_values.init( m_G->impl->m_nodes, data);
     }
 
     dataType& operator[] ( const node& u )
     {
-        return  m_map[ u->getDescriptor()];
-    }
-	
-	const dataType& operator[] ( const node& u ) const
-    {
-		return  m_map[ u->getDescriptor()];
+        return m_values.at( u.getAddress());
     }
 
 private:
-    const GraphType*                            m_G;
-    PMMap< typename GraphType::NodeDescriptor, dataType> m_map;
+    Graph*                              m_G;
+    PoolArray< NodeElement, dataType>   m_values;
 };
 
 
@@ -5,6 +5,8 @@
 #include <Utilities/mersenneTwister.h>
 #include <set>
 #include <deque>
+#include <vector>
+#include <algorithm>
 #include <assert.h>
 #include <limits>
 #include <memory>
@@ -61,6 +63,39 @@ public:
         return m_end;
     }
 
+    /**
+     * @brief Replaces the contents of the array with a sequence of elements, spread evenly over the pool
+     *
+     * Every element is reported to the observers as a move from the given sequence to its
+     * final position. This is much faster than inserting the elements one by one.
+     *
+     * @param elements The elements, in the order they should appear in the array
+     */
+    void assign( const std::vector<dataType>& elements)
+    {
+        if( elements.empty())
+        {
+            clear();
+            return;
+        }
+
+        delete[] m_pool;
+        m_numElements = elements.size();
+        m_poolSize = std::max( nextPowerOf2( SizeType( m_numElements / m_maxFullnessPercentage) + 1), SizeType(4));
+        m_bucketSize = nextPowerOf2( floorLog2( m_poolSize));
+        init();
+
+        // The observers see the sequence as the old pool of the elements. It is only read
+        m_oldPool = const_cast<dataType*>( &elements[0]);
+        CopyingStream stream( this, m_oldPool);
+        m_auxNode = m_helper.getRoot();
+        m_auxNode->m_cardinality = m_numElements;
+        m_helper.rearrangeOver( m_auxNode, stream);
+        resetObservers();
+        m_oldPool = 0;
+        m_auxIter.reset( m_pool);
+    }
+
     Iterator atIndex ( const SizeType& poolIndex )
     {
         if( poolIndex < m_poolSize)
@@ -257,7 +292,8 @@ public:
 
     inline SizeType getElementIndexOf( const Iterator& it)
     {
-        
+        // The end is past the last bucket, where the tree has no offsets
+        if( it == m_end) return m_numElements;
         return modulusPow2( getPoolIndexOf(it) , m_bucketSize) +
                  m_helper.getAggregateOffsetOver( getPoolIndexOf(it) );
     }
@@ -805,21 +841,13 @@ public:
 
         m_ptr = m_PMA->m_pool + m_PMA->m_bucketSize + ( (m_ptr - m_PMA->m_pool) & m_PMA->m_bucketMask);
 
-        assert( (*this == m_PMA->m_end) ||  (*m_ptr) != m_PMA->m_emptyElement);
-
-        return *this;
-
-        /*if( *this != m_PMA->m_end)
+        // A sparse array may have empty buckets, which are skipped as in begin()
+        while( (*this != m_PMA->m_end) && ( (*m_ptr) == m_PMA->m_emptyElement ) )
         {
-            m_ptr = m_PMA->m_pool + m_PMA->m_bucketSize + ( (m_ptr - m_PMA->m_pool) & m_PMA->m_bucketMask);
-            while( (*this != m_PMA->m_end) && ( (*m_ptr) == m_PMA->m_emptyElement ) )
-            {
-                m_ptr += m_PMA->m_bucketSize;
-            };
-            return *this;
+            m_ptr += m_PMA->m_bucketSize;
         }
 
-        return *this;*/
+        return *this;
     }
     
     Iterator operator++(int unused) // postfix
@@ -870,7 +898,10 @@ public:
         if( (*this != m_PMA->m_end) && ((*m_ptr) == m_PMA->m_emptyElement))
         {
             m_ptr = m_PMA->m_pool + m_PMA->m_bucketSize + ( (m_ptr - m_PMA->m_pool) & m_PMA->m_bucketMask);
-            assert( (*this == m_PMA->m_end) ||  (*m_ptr) != m_PMA->m_emptyElement);
+            while( (*this != m_PMA->m_end) && ( (*m_ptr) == m_PMA->m_emptyElement ) )
+            {
+                m_ptr += m_PMA->m_bucketSize;
+            }
         }
     }
 
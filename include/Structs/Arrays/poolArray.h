@@ -0,0 +1,142 @@
+#ifndef POOLARRAY_H
+#define POOLARRAY_H
+
+#include <Structs/Arrays/packedMemoryArray.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @class PoolArray
+ *
+ * @brief A flat array of values aligned with the pool of a packed memory array
+ *
+ * The value of an element is at the position of the element in the pool, so it is found in
+ * constant time. The array observes the packed memory array and moves the values along with
+ * their elements. The moves of a rearrangement are applied together when it is over, because
+ * a rearrangement may overwrite the old position of an element before it reports its move.
+ *
+ * After a bulk load, such as DynamicGraph::buildFromEdgeList or DynamicGraph::reorder, all the
+ * values are reset to the default value. Elements inserted after init start with an undefined
+ * value. The array must not outlive the packed memory array.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename ElementType, typename DataType>
+class PoolArray : public PackedMemoryArray<ElementType>::Observer
+{
+public:
+    typedef typename PackedMemoryArray<ElementType>::SizeType SizeType;
+
+    PoolArray():m_array(0),m_pool(0),m_destinationPool(0),m_values(0),m_size(0)
+    {
+    }
+
+    ~PoolArray()
+    {
+        detach();
+        delete[] m_values;
+    }
+
+    /**
+     * @brief Attaches the array to a packed memory array and sets all its values
+     */
+    void init( PackedMemoryArray<ElementType>& array, const DataType& value)
+    {
+        detach();
+        m_array = &array;
+        m_pool = m_array->getPool();
+        m_default = value;
+        allocate( m_array->getPoolSize());
+        m_array->registerObserver( this);
+    }
+
+    void detach()
+    {
+        if( m_array) m_array->unregisterObserver( this);
+        m_array = 0;
+        m_moves.clear();
+    }
+
+    DataType& at( const ElementType* element)
+    {
+        if( !m_moves.empty() || m_pool != m_array->getPool()) synchronize();
+        return m_values[ element - m_pool];
+    }
+
+    void move( ElementType* source, ElementType* sourcePool, ElementType* destination, ElementType* destinationPool, const ElementType& data)
+    {
+        Move m;
+        m.hasSource = ( sourcePool == m_pool);
+        m.source = m.hasSource ? SizeType( source - sourcePool) : 0;
+        m.destination = destination - destinationPool;
+        m_moves.push_back( m);
+        m_destinationPool = destinationPool;
+    }
+
+    void reset()
+    {
+        if( !m_moves.empty()) synchronize();
+    }
+
+private:
+    struct Move
+    {
+        SizeType source;
+        SizeType destination;
+        bool hasSource;
+    };
+
+    PackedMemoryArray<ElementType>* m_array;
+    ElementType*                    m_pool;
+    ElementType*                    m_destinationPool;
+    DataType*                       m_values;
+    SizeType                        m_size;
+    DataType                        m_default;
+    std::vector<Move>               m_moves;
+    std::vector<DataType>           m_moved;
+
+    PoolArray( const PoolArray&);
+    PoolArray& operator = ( const PoolArray&);
+
+    /**
+     * @brief Replaces the values with an array of the default value. A plain array, because a std::vector<bool> has no references to its values
+     */
+    void allocate( SizeType size)
+    {
+        delete[] m_values;
+        m_values = new DataType[size];
+        m_size = size;
+        std::fill( m_values, m_values + m_size, m_default);
+    }
+
+    /**
+     * @brief Applies the recorded moves. All the values are read before any of them is written
+     *
+     * The new pool is taken from the moves, because while an array is resized it still reports
+     * its old pool.
+     */
+    void synchronize()
+    {
+        ElementType* pool = m_moves.empty() ? m_array->getPool() : m_destinationPool;
+        m_moved.resize( m_moves.size());
+        for( SizeType i = 0; i < m_moves.size(); ++i)
+        {
+            m_moved[i] = m_moves[i].hasSource ? m_values[ m_moves[i].source] : m_default;
+        }
+
+        if( m_pool != pool || m_size != m_array->getPoolSize())
+        {
+            m_pool = pool;
+            allocate( m_array->getPoolSize());
+        }
+
+        for( SizeType i = 0; i < m_moves.size(); ++i)
+        {
+            m_values[ m_moves[i].destination] = m_moved[i];
+        }
+        m_moves.clear();
+    }
+};
+
+#endif //POOLARRAY_H
@@ -0,0 +1,156 @@
+#ifndef SLABALLOCATOR_H
+#define SLABALLOCATOR_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+/**
+ * @class SlabAllocator
+ *
+ * @brief Allocates small items from large contiguous slabs
+ *
+ * Items never move, so pointers to them stay valid until they are released. Released items are
+ * kept in a free list and reused first. Items allocated one after the other are contiguous, so
+ * they share cache lines, and all of them are freed at once with a few deallocations.
+ *
+ * Every item also has a 32-bit index, which can be stored instead of a pointer.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename T>
+class SlabAllocator
+{
+public:
+    typedef unsigned int SizeType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param slabBits Every slab holds 2^slabBits items
+     */
+    SlabAllocator( unsigned int slabBits = 16):m_slabBits(slabBits),m_slabMask( ( 1 << slabBits) - 1),m_numUsed(0)
+    {
+    }
+
+    ~SlabAllocator()
+    {
+        clear();
+    }
+
+    /**
+     * @brief Returns a new item, initialized with T()
+     */
+    T* allocate()
+    {
+        return atIndex( allocateIndex());
+    }
+
+    /**
+     * @brief Returns the index of a new item, initialized with T()
+     */
+    SizeType allocateIndex()
+    {
+        SizeType index;
+        if( !m_freeIndices.empty())
+        {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        }
+        else
+        {
+            if( m_numUsed == ( m_slabs.size() << m_slabBits)) addSlab();
+            index = m_numUsed++;
+        }
+        *atIndex( index) = T();
+        return index;
+    }
+
+    /**
+     * @brief Frees all the items
+     */
+    void clear()
+    {
+        for( SizeType i = 0; i < m_slabs.size(); ++i)
+        {
+            delete[] m_slabs[i];
+        }
+        m_slabs.clear();
+        m_slabBases.clear();
+        m_freeIndices.clear();
+        m_numUsed = 0;
+    }
+
+    /**
+     * @brief Returns the index of an item
+     */
+    SizeType getIndex( const T* item) const
+    {
+        typename std::vector< std::pair<const T*,SizeType> >::const_iterator it;
+        it = std::upper_bound( m_slabBases.begin(), m_slabBases.end(), std::make_pair( item, SizeType(-1)));
+        assert( it != m_slabBases.begin());
+        --it;
+        assert( item - it->first <= SizeType( m_slabMask));
+        return ( it->second << m_slabBits) + SizeType( item - it->first);
+    }
+
+    /**
+     * @brief Returns the item with an index
+     */
+    T* atIndex( SizeType index) const
+    {
+        return m_slabs[ index >> m_slabBits] + ( index & m_slabMask);
+    }
+
+    /**
+     * @brief Puts an item back to the free list
+     */
+    void release( T* item)
+    {
+        releaseIndex( getIndex( item));
+    }
+
+    void releaseIndex( SizeType index)
+    {
+        m_freeIndices.push_back( index);
+    }
+
+    /**
+     * @brief Makes room for a number of items, so that allocating them causes no new slabs
+     */
+    void reserve( SizeType numItems)
+    {
+        if( numItems <= m_freeIndices.size()) return;
+        while( ( m_slabs.size() << m_slabBits) < m_numUsed + numItems - m_freeIndices.size()) addSlab();
+    }
+
+    /**
+     * @brief Returns the number of allocated items
+     */
+    SizeType size() const
+    {
+        return m_numUsed - m_freeIndices.size();
+    }
+
+private:
+    unsigned int                                m_slabBits;
+    SizeType                                    m_slabMask;
+    SizeType                                    m_numUsed;
+    std::vector<T*>                             m_slabs;
+    std::vector< std::pair<const T*,SizeType> > m_slabBases;
+    std::vector<SizeType>                       m_freeIndices;
+
+    SlabAllocator( const SlabAllocator&);
+    SlabAllocator& operator = ( const SlabAllocator&);
+
+    void addSlab()
+    {
+        T* slab = new T[ m_slabMask + 1];
+        std::pair<const T*,SizeType> base( slab, m_slabs.size());
+        m_slabBases.insert( std::upper_bound( m_slabBases.begin(), m_slabBases.end(), base), base);
+        m_slabs.push_back( slab);
+    }
+};
+
+#endif //SLABALLOCATOR_H
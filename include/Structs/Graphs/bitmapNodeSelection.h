@@ -0,0 +1,272 @@
+#ifndef BITMAPNODESELECTION_H
+#define BITMAPNODESELECTION_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Utilities/binaryMath.h>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @class BitmapNodeSelection
+ *
+ * @brief A selection of nodes, kept as a bit vector over the node slots of a packed memory graph
+ *
+ * Unlike NodeSelection, it needs no field in the nodes, and it tests a node for membership
+ * without accessing the node. Unions, intersections and differences are computed on whole
+ * words, 128 bits at a time with SSE2 where it is available (it is enabled by default on
+ * x86-64). The size of a selection after such an operation is found by counting bits.
+ *
+ * The slots of the nodes change when nodes are inserted or erased, so a selection is only valid
+ * as long as the graph has the same nodes.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename GraphType>
+class BitmapNodeSelection
+{
+public:
+
+    typedef GraphType                       Graph;
+    typedef typename Graph::NodeIterator    NodeIterator;
+    typedef typename Graph::NodeDescriptor  NodeDescriptor;
+    typedef typename Graph::SizeType        SizeType;
+    typedef uint64_t                        WordType;
+
+    /**
+     * @class Iterator
+     *
+     * @brief Visits the selected nodes in the order of their slots
+     */
+    class Iterator
+    {
+    public:
+        Iterator():m_selection(0),m_word(0),m_bits(0)
+        {
+        }
+
+        Iterator( const BitmapNodeSelection* selection, SizeType word):m_selection(selection),m_word(word),m_bits(0)
+        {
+            if( m_word < m_selection->m_words.size())
+            {
+                m_bits = m_selection->m_words[m_word];
+                skipEmptyWords();
+            }
+        }
+
+        NodeIterator operator*() const
+        {
+            return m_selection->m_G->getNodeAtSlot( getSlot());
+        }
+
+        SizeType getSlot() const
+        {
+            return ( m_word << 6) + countTrailingZeros64( m_bits);
+        }
+
+        Iterator& operator++()
+        {
+            m_bits &= m_bits - 1;
+            skipEmptyWords();
+            return *this;
+        }
+
+        bool operator == ( const Iterator& other) const
+        {
+            return ( m_word == other.m_word) && ( m_bits == other.m_bits);
+        }
+
+        bool operator != ( const Iterator& other) const
+        {
+            return !( *this == other);
+        }
+
+    private:
+        const BitmapNodeSelection*  m_selection;
+        SizeType                    m_word;
+        WordType                    m_bits;
+
+        void skipEmptyWords()
+        {
+            while( !m_bits && ( ++m_word < m_selection->m_words.size()))
+            {
+                m_bits = m_selection->m_words[m_word];
+            }
+        }
+    };
+
+    BitmapNodeSelection( Graph* G):m_G(G),m_numNodes(0)
+    {
+        m_words.assign( ( m_G->getNumNodeSlots() + 63) >> 6, 0);
+    }
+
+    ~BitmapNodeSelection()
+    {
+    }
+
+    Iterator begin() const
+    {
+        return Iterator( this, 0);
+    }
+
+    Iterator end() const
+    {
+        return Iterator( this, m_words.size());
+    }
+
+    void clear()
+    {
+        std::fill( m_words.begin(), m_words.end(), 0);
+        m_numNodes = 0;
+    }
+
+    bool empty() const
+    {
+        return m_numNodes == 0;
+    }
+
+    /**
+     * @brief Fills a vector with the descriptors of the selected nodes
+     */
+    void getMembers( std::vector<NodeDescriptor>& members) const
+    {
+        members.clear();
+        members.reserve( m_numNodes);
+        for( Iterator it = begin(), last = end(); it != last; ++it)
+        {
+            members.push_back( m_G->getNodeDescriptor( *it));
+        }
+    }
+
+    bool isMember( const NodeDescriptor& uD) const
+    {
+        return isMember( m_G->getNodeIterator( uD));
+    }
+
+    bool isMember( const NodeIterator& u) const
+    {
+        SizeType slot = m_G->getNodeSlot(u);
+        return ( m_words[ slot >> 6] >> ( slot & 63)) & 1;
+    }
+
+    SizeType size() const
+    {
+        return m_numNodes;
+    }
+
+    void select( const NodeDescriptor& uD)
+    {
+        select( m_G->getNodeIterator( uD));
+    }
+
+    void select( const NodeIterator& u)
+    {
+        SizeType slot = m_G->getNodeSlot(u);
+        WordType bit = WordType(1) << ( slot & 63);
+        if( m_words[ slot >> 6] & bit) return;
+        m_words[ slot >> 6] |= bit;
+        ++m_numNodes;
+    }
+
+    void deselect( const NodeDescriptor& uD)
+    {
+        deselect( m_G->getNodeIterator( uD));
+    }
+
+    void deselect( const NodeIterator& u)
+    {
+        SizeType slot = m_G->getNodeSlot(u);
+        WordType bit = WordType(1) << ( slot & 63);
+        if( !( m_words[ slot >> 6] & bit)) return;
+        m_words[ slot >> 6] &= ~bit;
+        --m_numNodes;
+    }
+
+    /**
+     * @brief Adds the nodes of another selection of the same graph
+     */
+    void unite( const BitmapNodeSelection& other)
+    {
+        assert( m_words.size() == other.m_words.size());
+        SizeType i = 0;
+#ifdef __SSE2__
+        for( ; i + 2 <= m_words.size(); i += 2)
+        {
+            __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( &m_words[i]));
+            __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( &other.m_words[i]));
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( &m_words[i]), _mm_or_si128( a, b));
+        }
+#endif
+        for( ; i < m_words.size(); ++i)
+        {
+            m_words[i] |= other.m_words[i];
+        }
+        countNodes();
+    }
+
+    /**
+     * @brief Keeps only the nodes that are also in another selection of the same graph
+     */
+    void intersect( const BitmapNodeSelection& other)
+    {
+        assert( m_words.size() == other.m_words.size());
+        SizeType i = 0;
+#ifdef __SSE2__
+        for( ; i + 2 <= m_words.size(); i += 2)
+        {
+            __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( &m_words[i]));
+            __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( &other.m_words[i]));
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( &m_words[i]), _mm_and_si128( a, b));
+        }
+#endif
+        for( ; i < m_words.size(); ++i)
+        {
+            m_words[i] &= other.m_words[i];
+        }
+        countNodes();
+    }
+
+    /**
+     * @brief Removes the nodes of another selection of the same graph
+     */
+    void subtract( const BitmapNodeSelection& other)
+    {
+        assert( m_words.size() == other.m_words.size());
+        SizeType i = 0;
+#ifdef __SSE2__
+        for( ; i + 2 <= m_words.size(); i += 2)
+        {
+            __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( &m_words[i]));
+            __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( &other.m_words[i]));
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( &m_words[i]), _mm_andnot_si128( b, a));
+        }
+#endif
+        for( ; i < m_words.size(); ++i)
+        {
+            m_words[i] &= ~other.m_words[i];
+        }
+        countNodes();
+    }
+
+private:
+    GraphType*              m_G;
+    std::vector<WordType>   m_words;
+    SizeType                m_numNodes;
+
+    void countNodes()
+    {
+        m_numNodes = 0;
+        for( SizeType i = 0; i < m_words.size(); ++i)
+        {
+            m_numNodes += popCount64( m_words[i]);
+        }
+    }
+};
+
+
+#endif // BITMAPNODESELECTION_H
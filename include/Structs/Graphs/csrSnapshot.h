@@ -0,0 +1,144 @@
+#ifndef CSRSNAPSHOT_H
+#define CSRSNAPSHOT_H
+
+#include <Structs/Graphs/dynamicGraph.h>
+#include <Utilities/graphIO.h>
+#include <Utilities/parallel.h>
+#include <vector>
+
+/**
+ * @class CsrSnapshot
+ *
+ * @brief A read-only copy of the topology of a graph in compressed sparse row form
+ *
+ * The nodes are numbered 0 to n-1 in the order of the graph. The targets of the edges of node i
+ * are targets[ offsets[i] ] to targets[ offsets[i+1] - 1 ], and the sources of its incoming
+ * edges are stored the same way. Algorithms that process the whole graph in parallel work on a
+ * snapshot, because the nodes of a dynamic graph can not be accessed by their number. The
+ * snapshot does not follow later changes of the graph.
+ *
+ * A graph with m edges takes 8m bytes in a snapshot. The snapshot is built in parallel.
+ *
+ * @author Panos Michail
+ *
+ */
+template<class GraphType>
+class CsrSnapshot
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    CsrSnapshot( GraphType& G)
+    {
+        build( G);
+    }
+
+    void build( GraphType& G)
+    {
+        m_nodes.clear();
+        m_nodes.reserve( G.getNumNodes());
+        for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+        {
+            m_nodes.push_back( u);
+        }
+        m_index.init( G);
+
+        SizeType numNodes = m_nodes.size();
+        m_offsets.assign( numNodes + 1, 0);
+        m_inOffsets.assign( numNodes + 1, 0);
+
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for( long i = 0; i < (long)numNodes; ++i)
+        {
+            NodeIterator u = m_nodes[i];
+            SizeType outDegree = 0, inDegree = 0;
+            for( EdgeIterator e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e) ++outDegree;
+            for( InEdgeIterator k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k) ++inDegree;
+            m_offsets[i+1] = outDegree;
+            m_inOffsets[i+1] = inDegree;
+        }
+
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            m_offsets[i+1] += m_offsets[i];
+            m_inOffsets[i+1] += m_inOffsets[i];
+        }
+        m_targets.resize( m_offsets[numNodes]);
+        m_sources.resize( m_inOffsets[numNodes]);
+
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for( long i = 0; i < (long)numNodes; ++i)
+        {
+            NodeIterator u = m_nodes[i];
+            SizeType position = m_offsets[i];
+            for( EdgeIterator e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e)
+            {
+                m_targets[position++] = m_index[ G.target(e)];
+            }
+            position = m_inOffsets[i];
+            for( InEdgeIterator k = G.beginInEdges(u), lastInEdge = G.endInEdges(u); k != lastInEdge; ++k)
+            {
+                m_sources[position++] = m_index[ G.source(k)];
+            }
+        }
+    }
+
+    SizeType getNumNodes() const
+    {
+        return m_nodes.size();
+    }
+
+    SizeType getNumEdges() const
+    {
+        return m_targets.size();
+    }
+
+    /**
+     * @brief Returns the number of a node of the graph
+     */
+    SizeType getIndex( const NodeIterator& u) const
+    {
+        return m_index[u];
+    }
+
+    /**
+     * @brief Returns the node of the graph with a number
+     */
+    const NodeIterator& getNode( SizeType i) const
+    {
+        return m_nodes[i];
+    }
+
+    const std::vector<SizeType>& getOffsets() const
+    {
+        return m_offsets;
+    }
+
+    const std::vector<SizeType>& getTargets() const
+    {
+        return m_targets;
+    }
+
+    const std::vector<SizeType>& getInOffsets() const
+    {
+        return m_inOffsets;
+    }
+
+    const std::vector<SizeType>& getSources() const
+    {
+        return m_sources;
+    }
+
+private:
+    std::vector<NodeIterator>   m_nodes;
+    NodeIndexMap<GraphType>     m_index;
+    std::vector<SizeType>       m_offsets;
+    std::vector<SizeType>       m_targets;
+    std::vector<SizeType>       m_inOffsets;
+    std::vector<SizeType>       m_sources;
+};
+
+#endif //CSRSNAPSHOT_H
@@ -2,11 +2,13 @@
 #define DYNAMICGRAPH_H
 
 #include <Structs/Arrays/packedMemoryArray.h>
+#include <Structs/Graphs/hotColdPayload.h>
 #include <Utilities/mersenneTwister.h>
 #include <Utilities/graphIO.h>
 #include <Utilities/graphGenerators.h>
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 
 class DefaultGraphItem
@@ -102,9 +104,12 @@ public:
     typedef typename GraphImplementation<Vtype,Etype>::InEdgeIterator   InEdgeIterator;
     typedef Vtype                                                       NodeData;
     typedef Etype                                                       EdgeData;
+    typedef typename ColdDataStorage<Vtype>::ColdData                   NodeColdData;
+    typedef typename ColdDataStorage<Etype>::ColdData                   EdgeColdData;
     typedef unsigned int                                                PropertyType;
+    typedef GraphImplementation<Vtype,Etype>                            Implementation;
 
-    DynamicGraph()
+    DynamicGraph():m_numModifications(0)
     {
         impl = new GraphImplementation<Vtype,Etype>();
     }
@@ -115,6 +120,51 @@ public:
     }
     
 
+    /**
+     * @brief Erases and inserts a batch of edges
+     *
+     * The implementation may reorder the batch, or lay out its edges again, to apply it with
+     * fewer data movements than with calls to eraseEdge and insertEdge. Erasures of edges that
+     * are not in the graph and insertions of loops are ignored. Insertions of edges that are in
+     * the graph only replace their data.
+     *
+     * @param erasures The edges to be erased, without duplicates
+     * @param insertions The edges to be inserted, without duplicates or edges that are also erased
+     * @param insertionData The data of every inserted edge
+     */
+    void applyEdgeBatch( const std::vector<EdgeDescriptor>& erasures, const std::vector<EdgeDescriptor>& insertions, const std::vector<EdgeData>& insertionData)
+    {
+        assert( insertions.size() == insertionData.size());
+        std::vector<EdgeDescriptor> validErasures, validInsertions;
+        std::vector<EdgeData> validInsertionData;
+        validErasures.reserve( erasures.size());
+        for( SizeType i = 0; i < erasures.size(); ++i)
+        {
+            if( hasEdge( erasures[i])) validErasures.push_back( erasures[i]);
+        }
+        validInsertions.reserve( insertions.size());
+        validInsertionData.reserve( insertions.size());
+        for( SizeType i = 0; i < insertions.size(); ++i)
+        {
+            const EdgeDescriptor& eD = insertions[i];
+            if( eD.first == eD.second || !hasNode( eD.first) || !hasNode( eD.second)) continue;
+            if( hasEdge( eD))
+            {
+                EdgeIterator e = getEdgeIterator( eD);
+                ColdDataStorage<EdgeData>::assign( *e, insertionData[i]);
+                ColdDataStorage<EdgeData>::assign( *getInEdgeIterator(e), insertionData[i]);
+                continue;
+            }
+            validInsertions.push_back( eD);
+            validInsertionData.push_back( insertionData[i]);
+        }
+
+        impl->applyEdgeBatch( validErasures, validInsertions, validInsertionData);
+        m_numEdges += validInsertions.size();
+        m_numEdges -= validErasures.size();
+        ++m_numModifications;
+    }
+
     /**
      * @brief Returns the first outgoing edge of a node
      *
@@ -149,6 +199,71 @@ public:
         return impl->beginNodes();
     }
 
+    /**
+     * @brief Replaces the contents of the graph with the nodes and edges of an edge list
+     *
+     * Loops are dropped and of several edges between the same nodes only the last one is kept,
+     * as with repeated calls to insertEdge. The edges are handed to the implementation in one
+     * batch, which is much faster than inserting them one by one.
+     *
+     * @param numNodes The number of nodes. Node ids are in the range [0, numNodes-1]
+     * @param edges The edges as pairs of node ids
+     * @param edgeData The data of every edge, or empty for default data
+     * @param ids Filled with the descriptor of every node id
+     */
+    void buildFromEdgeList( SizeType numNodes, const std::vector< std::pair<SizeType,SizeType> >& edges, const std::vector<EdgeData>& edgeData, std::vector<NodeDescriptor>& ids)
+    {
+        assert( edgeData.empty() || edgeData.size() == edges.size());
+
+        // Counting sort by source, keeping the input order among the edges of a node
+        std::vector<SizeType> firstEdge( numNodes + 1, 0);
+        for( SizeType i = 0; i < edges.size(); ++i)
+        {
+            assert( edges[i].first < numNodes && edges[i].second < numNodes);
+            ++firstEdge[ edges[i].first + 1];
+        }
+        for( SizeType u = 0; u < numNodes; ++u)
+        {
+            firstEdge[u+1] += firstEdge[u];
+        }
+        std::vector<SizeType> order( edges.size());
+        std::vector<SizeType> nextEdge( firstEdge.begin(), firstEdge.end() - 1);
+        for( SizeType i = 0; i < edges.size(); ++i)
+        {
+            order[ nextEdge[ edges[i].first]++] = i;
+        }
+
+        std::vector< std::pair<SizeType,SizeType> > sortedEdges;
+        std::vector<EdgeData> sortedData;
+        sortedEdges.reserve( edges.size());
+        if( !edgeData.empty()) sortedData.reserve( edges.size());
+
+        std::vector<SizeType> lastSeen( numNodes, std::numeric_limits<SizeType>::max());
+        for( SizeType u = 0; u < numNodes; ++u)
+        {
+            SizeType first = sortedEdges.size();
+            for( SizeType j = firstEdge[u]; j < firstEdge[u+1]; ++j)
+            {
+                SizeType i = order[j];
+                SizeType v = edges[i].second;
+                if( v == u) continue;
+                if( lastSeen[v] != std::numeric_limits<SizeType>::max() && lastSeen[v] >= first)
+                {
+                    if( !edgeData.empty()) sortedData[ lastSeen[v]] = edgeData[i];
+                    continue;
+                }
+                lastSeen[v] = sortedEdges.size();
+                sortedEdges.push_back( edges[i]);
+                if( !edgeData.empty()) sortedData.push_back( edgeData[i]);
+            }
+        }
+
+        impl->buildFromEdgeList( numNodes, sortedEdges, sortedData, ids);
+        m_numNodes = numNodes;
+        m_numEdges = sortedEdges.size();
+        ++m_numModifications;
+    }
+
     /**
      * @brief Returns the random node
      * 
@@ -167,11 +282,13 @@ public:
         impl->clear();
         m_numNodes = 0;
         m_numEdges = 0;
+        ++m_numModifications;
     }
     
     void compress()
     {
         impl->compress();
+        ++m_numModifications;
     }
 
     /**
@@ -188,6 +305,7 @@ public:
     void expand()
     {
         impl->expand();
+        ++m_numModifications;
     }
 
     /**
@@ -245,6 +363,7 @@ public:
         if( !hasEdge(descriptor)) return;
         impl->eraseEdge( descriptor.first, descriptor.second);
         --m_numEdges;
+        ++m_numModifications;
     }
     
     /**
@@ -282,11 +401,11 @@ public:
             EdgeDescriptor eD = *it;
             e = getEdgeIterator( eD);
             eraseEdge( getEdgeDescriptor(e));
-            --m_numEdges;
         } 
         
          impl->eraseNode( descriptor);
          --m_numNodes;
+         ++m_numModifications;
          assert(hasValidInEdges());
     }
 
@@ -429,6 +548,88 @@ public:
         return impl->getDescriptor(u);
     }
 
+    /**
+     * @brief Returns the cold part of the data of a node. Only packed memory graphs with HotColdPayload node data support it
+     *
+     * @param u The node
+     * @return The cold data of the node
+     */
+    NodeColdData& getColdData( const NodeIterator& u)
+    {
+        return impl->getColdData(u);
+    }
+
+    /**
+     * @brief Returns the cold part of the data of an edge, which is shared with its incoming edge
+     *
+     * @param e The edge
+     * @return The cold data of the edge
+     */
+    EdgeColdData& getColdData( const EdgeIterator& e)
+    {
+        return impl->getColdData(e);
+    }
+
+    EdgeColdData& getColdData( const InEdgeIterator& k)
+    {
+        return impl->getColdData(k);
+    }
+
+    /**
+     * @brief Returns the 32-bit index of a node descriptor. Only packed memory graphs support descriptor indices
+     *
+     * @param descriptor The descriptor of the node
+     * @return The index of the descriptor, valid as long as the node is in the graph
+     */
+    SizeType getDescriptorIndex( const NodeDescriptor& descriptor) const
+    {
+        return impl->getDescriptorIndex( descriptor);
+    }
+
+    /**
+     * @brief Returns the node descriptor with a 32-bit index
+     *
+     * @param index The index of the descriptor
+     * @return The descriptor of the node
+     */
+    NodeDescriptor getDescriptorAtIndex( const SizeType& index) const
+    {
+        return impl->getDescriptorAtIndex( index);
+    }
+
+    /**
+     * @brief Returns the slot of a node, a number in the range [0, getNumNodeSlots()-1] that is unique among the nodes. Only packed memory graphs support node slots
+     *
+     * Unlike the relative position, the slot is found in constant time without accessing the
+     * node. The slots of the nodes change when a node is inserted or erased.
+     *
+     * @param u The node
+     * @return The slot of the node
+     */
+    SizeType getNodeSlot( const NodeIterator& u) const
+    {
+        return impl->getNodeSlot(u);
+    }
+
+    /**
+     * @brief Returns the node in a slot
+     *
+     * @param slot A slot that holds a node
+     * @return An iterator to the node
+     */
+    NodeIterator getNodeAtSlot( const SizeType& slot) const
+    {
+        return impl->getNodeAtSlot( slot);
+    }
+
+    /**
+     * @brief Returns the number of node slots, an upper bound on the slot of any node
+     */
+    SizeType getNumNodeSlots() const
+    {
+        return impl->getNumNodeSlots();
+    }
+
     /**
      * @brief Returns iterator to a node
      * 
@@ -471,6 +672,28 @@ public:
         return m_numNodes;
     }
 
+    /**
+     * @brief Returns the number of modifications of the graph
+     *
+     * Every insertion, erasure or move of nodes and edges, bulk load and change of the layout
+     * increases it, since any of them may invalidate iterators and positions. Structures built
+     * from the graph, such as caches of search trees, compare it to the value they were built
+     * with. Changes of node or edge data through iterators are not seen by the graph and must be
+     * reported with markModified().
+     */
+    unsigned int getNumModifications() const
+    {
+        return m_numModifications;
+    }
+
+    /**
+     * @brief Reports a change of the graph that it can not see, such as a change of edge weights
+     */
+    void markModified()
+    {
+        ++m_numModifications;
+    }
+
     /**
      * @brief Returns the relative position of a node as an id in the range [0, numNodes-1]
      *
@@ -491,7 +714,7 @@ public:
     bool hasEdge( const NodeDescriptor& uD, const NodeDescriptor& vD)
     {
         assert( hasNode( uD) && hasNode( vD));
-        return hasEdge( getNodeIterator( uD), getNodeIterator( vD));
+        return impl->hasEdge( uD, vD);
     }
 
     /**
@@ -503,13 +726,7 @@ public:
      */
     bool hasEdge( const NodeIterator& u, const NodeIterator& v)
     {
-        EdgeIterator e, end;
-        NodeIterator neigh;        
-        for( e = beginEdges(u), end = endEdges(u); e != end; ++e)
-        {
-            if( target(e) == v) return true;
-        }
-        return false;
+        return impl->hasEdge( getNodeDescriptor(u), getNodeDescriptor(v));
     }
     
     /**
@@ -574,6 +791,30 @@ public:
         return true;
     }
 
+    /**
+     * @brief Checks if a sequence of descriptors is an order of the nodes of the graph
+     *
+     * @param order A sequence of node descriptors
+     * @return True if it holds the descriptor of every node exactly once, false otherwise
+     */
+    bool isNodeOrder( const std::vector<NodeDescriptor>& order)
+    {
+        if( order.size() != m_numNodes)
+        {
+            return false;
+        }
+
+        std::vector<NodeDescriptor> descriptors, sortedOrder( order);
+        descriptors.reserve( m_numNodes);
+        for( NodeIterator u = beginNodes(), end_nodes = endNodes(); u != end_nodes; ++u)
+        {
+            descriptors.push_back( getNodeDescriptor(u));
+        }
+        std::sort( descriptors.begin(), descriptors.end());
+        std::sort( sortedOrder.begin(), sortedOrder.end());
+        return descriptors == sortedOrder;
+    }
+
     /**
      * @brief Returns the in degree of a node (number of incoming edges)
      * 
@@ -601,6 +842,7 @@ public:
         if( !hasNode(vD)) return EdgeDescriptor(0,0);
         if( hasEdge( uD, vD)) return getEdgeDescriptor( uD, vD);
         ++m_numEdges;
+        ++m_numModifications;
         impl->insertEdge( uD, vD);
         return getEdgeDescriptor( uD, vD);
     }
@@ -613,12 +855,14 @@ public:
     NodeDescriptor insertNode() 
     {
         ++m_numNodes;
+        ++m_numModifications;
         return impl->insertNode();
     }
 
     NodeDescriptor insertNodeBefore( NodeDescriptor descriptor) 
     {
         ++m_numNodes;
+        ++m_numModifications;
         return impl->insertNodeBefore( descriptor);
     }
     
@@ -740,6 +984,7 @@ public:
         if( !hasNode(vD)) return EdgeDescriptor(0,0);
         if( hasEdge( uD, vD)) return getEdgeDescriptor( uD, vD);
         ++m_numEdges;
+        ++m_numModifications;
         impl->pushEdge( uD, vD);
         return getEdgeDescriptor( uD, vD);
     }
@@ -755,6 +1000,23 @@ public:
         reader->read(*this);
     }
 
+    /**
+     * @brief Puts the nodes of the graph in a new order
+     *
+     * The whole layout of the graph is rebuilt in one pass, which is much faster than moving
+     * the nodes one by one. Orders that put adjacent nodes close to each other, such as those
+     * of nodeOrderings.h, make the accesses of graph searches mostly local. Node descriptors
+     * stay valid, but iterators do not.
+     *
+     * @param order The descriptors of all the nodes, in their new order
+     */
+    void reorder( const std::vector<NodeDescriptor>& order)
+    {
+        assert( isNodeOrder( order));
+        impl->reorder( order);
+        ++m_numModifications;
+    }
+
     /**
      * @brief Reserves memory for the graph
      *
@@ -764,6 +1026,7 @@ public:
     void reserve( const SizeType& numNodes, const SizeType& numEdges)
     {
         impl->reserve( numNodes, numEdges);
+        ++m_numModifications;
     }
 
     /**
@@ -809,6 +1072,7 @@ public:
 
         impl->setDescriptor( u, vD);
         impl->setDescriptor( v, uD);
+        ++m_numModifications;
     }
 
     /**
@@ -844,9 +1108,13 @@ public:
     }
 
 private:
+    template<typename dataType, typename GraphType> friend class NodeArray;
+    template<typename dataType, typename GraphType> friend class EdgeArray;
+
     GraphImplementation<Vtype,Etype>*   impl;
     SizeType                            m_numNodes;
     SizeType                            m_numEdges;
+    unsigned int                        m_numModifications;
 };
 
 
@@ -40,6 +40,29 @@ public:
         }        
     }
 
+    /**
+     * @brief Erases and inserts a batch of edges, one by one
+     *
+     * @param erasures Edges of the graph, without duplicates
+     * @param insertions Edges that are not in the graph, without loops or duplicates
+     * @param insertionData The data of every inserted edge
+     */
+    void applyEdgeBatch( const std::vector< std::pair<NodeDescriptor,NodeDescriptor> >& erasures, const std::vector< std::pair<NodeDescriptor,NodeDescriptor> >& insertions, const std::vector<Etype>& insertionData)
+    {
+        for( SizeType i = 0; i < erasures.size(); ++i)
+        {
+            NodeDescriptor uD = erasures[i].first, vD = erasures[i].second;
+            eraseEdge( uD, vD);
+        }
+        for( SizeType i = 0; i < insertions.size(); ++i)
+        {
+            insertEdge( insertions[i].first, insertions[i].second);
+            EdgeIterator e = getEdgeIterator( insertions[i].first, insertions[i].second);
+            static_cast<Etype&>(*e) = insertionData[i];
+            static_cast<Etype&>(*getInEdgeIterator(e)) = insertionData[i];
+        }
+    }
+
     EdgeIterator beginEdges( const NodeIterator& u) 
     { 
         return u->m_edges.begin();
@@ -66,6 +89,35 @@ public:
         return m_auxNodeIterator;
 	}
 	
+    /**
+     * @brief Replaces the graph with the nodes and edges of an edge list
+     *
+     * @param numNodes The number of nodes
+     * @param edges The edges as pairs of node ids, sorted by source, without loops or duplicates
+     * @param edgeData The data of the edges, or empty for default data
+     * @param ids Filled with the descriptor of every node id
+     */
+    void buildFromEdgeList( SizeType numNodes, const std::vector< std::pair<SizeType,SizeType> >& edges, const std::vector<Etype>& edgeData, std::vector<NodeDescriptor>& ids)
+    {
+        clear();
+        ids.resize( numNodes);
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            ids[i] = insertNode();
+        }
+        for( SizeType i = 0; i < edges.size(); ++i)
+        {
+            insertEdge( ids[ edges[i].first], ids[ edges[i].second]);
+            if( edgeData.empty()) continue;
+            EdgeIterator e = getNodeIterator( ids[ edges[i].first])->m_edges.end();
+            InEdgeIterator k = getNodeIterator( ids[ edges[i].second])->m_inEdges.end();
+            --e;
+            --k;
+            static_cast<Etype&>(*e) = edgeData[i];
+            static_cast<Etype&>(*k) = edgeData[i];
+        }
+    }
+
 	void clear()
     {
         m_nodes.clear();
@@ -108,7 +160,17 @@ public:
         InEdgeIterator k = getInEdgeIterator( e);
         NodeIterator u = getNodeIterator( uD);
 
+        // the edges after the erased ones move back by one position, so their pairs are updated
+        for( InEdgeIterator l = k + 1, end = endInEdges(v); l != end; ++l)
+        {
+            --getEdgeIterator(l)->m_InEdge;
+        }
         (*v).m_inEdges.erase(k);
+
+        for( EdgeIterator f = e + 1, end = endEdges(u); f != end; ++f)
+        {
+            --getInEdgeIterator(f)->m_edge;
+        }
         (*u).m_edges.erase(e);
 
         --m_numEdges;
@@ -188,7 +250,7 @@ public:
             NodeIterator neigh;        
             for( e = beginEdges(u), end = endEdges(u); e != end; ++e)
             {
-                neigh = target(e);
+                neigh = getAdjacentNodeIterator(e);
                 if( neigh == v)
                 {
                     return true;
@@ -327,6 +389,20 @@ public:
         insertEdge(uD,vD);
     }
 
+    /**
+     * @brief Puts the nodes in a new order, by relinking the list of the nodes. Nodes and edges are not moved in memory
+     *
+     * @param order The descriptors of all the nodes, in their new order
+     */
+    void reorder( const std::vector<NodeDescriptor>& order)
+    {
+        assert( order.size() == m_nodes.size());
+        for( SizeType i = 0; i < order.size(); ++i)
+        {
+            m_nodes.splice( m_nodes.end(), m_nodes, *order[i]);
+        }
+    }
+
     void reserve( const SizeType& numNodes, const SizeType& numEdges)
     {
         return;
@@ -0,0 +1,131 @@
+#ifndef HOTCOLDPAYLOAD_H
+#define HOTCOLDPAYLOAD_H
+
+#include <Structs/Arrays/slabAllocator.h>
+
+/**
+ * @class HotColdPayload
+ *
+ * @brief Node or edge data split in a hot part, stored with the topology, and a cold part, stored aside
+ *
+ * The hot part holds the fields that graph searches touch on every visit, such as distances,
+ * predecessors, timestamps and weights. The cold part holds everything else, such as names,
+ * labels and properties. A packed memory graph keeps the cold parts in a slab of its own, and
+ * every payload keeps only the 32-bit index of its cold part, so that the node and edge arrays
+ * stay dense and rebalances do not copy the cold parts. An edge and its incoming edge share
+ * their cold part.
+ *
+ * For example:
+ *
+ *     struct NodeHot : DefaultGraphItem { unsigned int dist, timestamp; ... };
+ *     struct NodeCold { std::string name; ... };
+ *     typedef DynamicGraph< PackedMemoryGraphImpl, HotColdPayload<NodeHot,NodeCold>, EdgeData> Graph;
+ *
+ *     G.getColdData(u).name = "Athens";
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename HotType, typename ColdType>
+class HotColdPayload : public HotType
+{
+public:
+    typedef HotType     HotData;
+    typedef ColdType    ColdData;
+
+    HotColdPayload():HotType(),m_coldIndex(0)
+    {
+    }
+
+    static unsigned int memUsage()
+    {
+        return sizeof( HotColdPayload);
+    }
+
+    unsigned int m_coldIndex;
+};
+
+
+/**
+ * @class ColdDataStorage
+ *
+ * @brief Stores the cold parts of the payloads of a graph. Payloads without a cold part need no storage
+ *
+ * The graph attaches a cold part to every new node and edge, and detaches it when the node or
+ * edge is erased. Payloads given by the user are assigned without their cold index, so that
+ * they keep the cold part that is attached to them.
+ */
+template<typename PayloadType>
+class ColdDataStorage
+{
+public:
+    typedef unsigned int SizeType;
+
+    struct NoColdData {};
+    typedef NoColdData ColdData;
+
+    void attach( PayloadType& payload) {}
+    void attach( PayloadType& payload, PayloadType& twin) {}
+    void detach( const PayloadType& payload) {}
+    void clear() {}
+    void reserve( SizeType numPayloads) {}
+
+    static void assign( PayloadType& payload, const PayloadType& data)
+    {
+        payload = data;
+    }
+};
+
+
+template<typename HotType, typename ColdType>
+class ColdDataStorage< HotColdPayload<HotType,ColdType> >
+{
+public:
+    typedef unsigned int                        SizeType;
+    typedef HotColdPayload<HotType,ColdType>    PayloadType;
+    typedef ColdType                            ColdData;
+
+    void attach( PayloadType& payload)
+    {
+        payload.m_coldIndex = m_coldData.allocateIndex();
+    }
+
+    /**
+     * @brief Attaches a new cold part to two payloads, such as an edge and its incoming edge
+     */
+    void attach( PayloadType& payload, PayloadType& twin)
+    {
+        attach( payload);
+        twin.m_coldIndex = payload.m_coldIndex;
+    }
+
+    void detach( const PayloadType& payload)
+    {
+        m_coldData.releaseIndex( payload.m_coldIndex);
+    }
+
+    void clear()
+    {
+        m_coldData.clear();
+    }
+
+    void reserve( SizeType numPayloads)
+    {
+        m_coldData.reserve( numPayloads);
+    }
+
+    static void assign( PayloadType& payload, const PayloadType& data)
+    {
+        static_cast<HotType&>( payload) = static_cast<const HotType&>( data);
+    }
+
+    ColdType& get( const PayloadType& payload)
+    {
+        return *m_coldData.atIndex( payload.m_coldIndex);
+    }
+
+private:
+    SlabAllocator<ColdType> m_coldData;
+};
+
+#endif //HOTCOLDPAYLOAD_H
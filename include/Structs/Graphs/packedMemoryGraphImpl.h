@@ -2,7 +2,11 @@
 #define PACKEDMEMORYGRAPHIMPL_H
 
 #include <Utilities/mersenneTwister.h>
+#include <Structs/Arrays/slabAllocator.h>
+#include <Structs/Graphs/hotColdPayload.h>
 #include <vector>
+#include <algorithm>
+#include <stdint.h>
 
 template<typename Vtype, typename Etype>
 class PMGNode;
@@ -16,6 +20,8 @@ template<typename Vtype, typename Etype>
 class PMGEdgeObserver;
 template<typename Vtype, typename Etype>
 class PMGInEdgeObserver;
+template<typename Vtype, typename Etype>
+class PMGEdgeIndex;
 
 
 template<typename Vtype, typename Etype>
@@ -35,11 +41,16 @@ class PackedMemoryGraphImpl
     friend class PMGNodeObserver< Vtype, Etype>;
     friend class PMGEdgeObserver< Vtype, Etype>;
     friend class PMGInEdgeObserver< Vtype, Etype>;
+    friend class PMGEdgeIndex< Vtype, Etype>;
+    template<typename dataType, typename GraphType> friend class NodeArray;
+    template<typename dataType, typename GraphType> friend class EdgeArray;
 
 public:
     
     typedef unsigned int                                                        SizeType;
     typedef PMGNode<Vtype,Etype>**                                              NodeDescriptor;
+    typedef PMGNode<Vtype,Etype>                                                NodeElement;
+    typedef PMGEdge<Vtype,Etype>                                                EdgeElement;
     typedef typename PackedMemoryArray< PMGNode< Vtype, Etype> >::Iterator      NodeIterator;
     typedef typename PackedMemoryArray< PMGEdge< Vtype, Etype> >::Iterator      EdgeIterator;
     typedef typename PackedMemoryArray< PMGInEdge< Vtype, Etype> >::Iterator    InEdgeIterator;
@@ -62,16 +73,46 @@ public:
         delete m_nodeObserver;
         delete m_edgeObserver;
         delete m_InEdgeObserver;
+    }
+    
+    /**
+     * @brief Erases and inserts a batch of edges
+     *
+     * A batch that is small compared to the graph is applied edge by edge, in the order of the
+     * sources, so that consecutive updates fall in the same region of the edge array and share
+     * its rebalances. A larger batch is merged with the edges of the graph and the edge arrays
+     * are laid out again with one bulk load each, which costs no rebalances at all.
+     *
+     * @param erasures Edges of the graph, without duplicates
+     * @param insertions Edges that are not in the graph, without loops or duplicates
+     * @param insertionData The data of every inserted edge
+     */
+    void applyEdgeBatch( const std::vector< std::pair<NodeDescriptor,NodeDescriptor> >& erasures, const std::vector< std::pair<NodeDescriptor,NodeDescriptor> >& insertions, const std::vector<Etype>& insertionData)
+    {
+        if( ( erasures.size() + insertions.size()) * REBUILD_BATCH_RATIO >= m_edges.size())
+        {
+            rebuildEdges( erasures, insertions, insertionData);
+            return;
+        }
 
-        NodeIterator end = m_nodes.end();
-        EdgeIterator end_edges = m_edges.end();
+        std::vector<SizeType> order;
+        sortByNode( erasures, true, order);
+        for( SizeType i = 0; i < order.size(); ++i)
+        {
+            eraseEdge( erasures[ order[i]].first, erasures[ order[i]].second);
+        }
 
-        for( NodeIterator u = m_nodes.begin(); u != end; ++u)
+        sortByNode( insertions, true, order);
+        for( SizeType i = 0; i < order.size(); ++i)
         {
-            delete u->getDescriptor();
+            const std::pair<NodeDescriptor,NodeDescriptor>& edge = insertions[ order[i]];
+            insertEdge( edge.first, edge.second);
+            EdgeIterator e = getEdgeIterator( edge.first, edge.second);
+            m_edgeColdData.assign( *e, insertionData[ order[i]]);
+            m_edgeColdData.assign( *getInEdgeIterator(e), insertionData[ order[i]]);
         }
     }
-    
+
     EdgeIterator beginEdges()
     {
         return m_edges.begin();
@@ -101,8 +142,95 @@ public:
         return m_auxNodeIterator;
 	}
 	
+    /**
+     * @brief Replaces the graph with the nodes and edges of an edge list
+     *
+     * The nodes, edges and incoming edges are laid out with one bulk load per array and linked
+     * afterwards, instead of being inserted one by one.
+     *
+     * @param numNodes The number of nodes
+     * @param edges The edges as pairs of node ids, sorted by source, without loops or duplicates
+     * @param edgeData The data of the edges, or empty for default data
+     * @param ids Filled with the descriptor of every node id
+     */
+    void buildFromEdgeList( SizeType numNodes, const std::vector< std::pair<SizeType,SizeType> >& edges, const std::vector<Etype>& edgeData, std::vector<NodeDescriptor>& ids)
+    {
+        SizeType numEdges = edges.size();
+        clear();
+
+        ids.resize( numNodes);
+        std::vector< PMGNode<Vtype,Etype> > nodes( numNodes);
+        m_descriptors.reserve( numNodes);
+        m_nodeColdData.reserve( numNodes);
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            ids[i] = m_descriptors.allocate();
+            nodes[i].setDescriptor( ids[i]);
+            m_nodeColdData.attach( nodes[i]);
+        }
+        m_nodes.assign( nodes);
+        nodes.clear();
+
+        // The incoming edges are grouped by target with a counting sort
+        std::vector<SizeType> firstEdge( numNodes + 1, 0), firstInEdge( numNodes + 1, 0), inPosition( numEdges);
+        for( SizeType i = 0; i < numEdges; ++i)
+        {
+            ++firstEdge[ edges[i].first + 1];
+            ++firstInEdge[ edges[i].second + 1];
+        }
+        for( SizeType u = 0; u < numNodes; ++u)
+        {
+            firstEdge[u+1] += firstEdge[u];
+            firstInEdge[u+1] += firstInEdge[u];
+        }
+        std::vector<SizeType> nextInEdge( firstInEdge.begin(), firstInEdge.end() - 1);
+        for( SizeType i = 0; i < numEdges; ++i)
+        {
+            inPosition[i] = nextInEdge[ edges[i].second]++;
+        }
+
+        std::vector< PMGEdge<Vtype,Etype> > outEdges( numEdges);
+        std::vector< PMGInEdge<Vtype,Etype> > inEdges( numEdges);
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)numEdges; ++i)
+        {
+            PMGEdge<Vtype,Etype>& e = outEdges[i];
+            PMGInEdge<Vtype,Etype>& k = inEdges[ inPosition[i]];
+            if( !edgeData.empty())
+            {
+                m_edgeColdData.assign( e, edgeData[i]);
+                m_edgeColdData.assign( k, edgeData[i]);
+            }
+            e.m_adjacentNode = *ids[ edges[i].second];
+            k.m_adjacentNode = *ids[ edges[i].first];
+        }
+        m_edgeColdData.reserve( numEdges);
+        for( SizeType i = 0; i < numEdges; ++i)
+        {
+            m_edgeColdData.attach( outEdges[i], inEdges[ inPosition[i]]);
+        }
+        m_edges.assign( outEdges);
+        m_inEdges.assign( inEdges);
+        outEdges.clear();
+        inEdges.clear();
+
+        std::vector< PMGNode<Vtype,Etype>* > nodeAddress( numNodes);
+        for( SizeType u = 0; u < numNodes; ++u)
+        {
+            nodeAddress[u] = *ids[u];
+        }
+        linkEdges( nodeAddress, firstEdge, firstInEdge, inPosition);
+
+        m_lastPushedNode = m_nodes.end();
+        m_currentPushedNode = m_nodes.end();
+    }
+
 	void clear()
     {
+        m_descriptors.clear();
+        m_nodeColdData.clear();
+        m_edgeColdData.clear();
+        m_edgeIndex.clear();
         m_nodes.clear();
         m_edges.clear();
         m_inEdges.clear();
@@ -154,8 +282,8 @@ public:
             EdgeIterator f = e;
             ++f;
             
-            // if it has no more edges
-            if( f.getAddress() == u->m_lastEdge)
+            // if it has no more edges; the last node with edges ends at the end of the array
+            if( f == endEdges(u))
             {
                 setFirstEdge(u,0);
             }
@@ -170,7 +298,7 @@ public:
 		    NodeIterator w,z;
 			InEdgeIterator f = k;
 		    ++f;
-			if( f.getAddress() == v->m_lastInEdge)
+			if( f == endInEdges(v))
             {
                 setFirstInEdge( v, 0);
             }
@@ -180,6 +308,8 @@ public:
             }
 		}
 
+        m_edgeIndex.erase( e.getAddress());
+        m_edgeColdData.detach( *e);
         e->m_InEdge = 0;
         m_edges.erase( e);
         k->m_edge = 0;
@@ -189,8 +319,11 @@ public:
     void eraseNode( NodeDescriptor uD) 
     { 
         NodeIterator u = getNodeIterator( uD);
+        // the edges must be erased first, so that the edge ranges of the other nodes are kept
+        assert( !u->hasEdges() && !u->hasInEdges());
+        m_nodeColdData.detach( *u);
         m_nodes.erase(u);
-        delete uD;
+        m_descriptors.release( uD);
     }
     
     void expand()
@@ -276,6 +409,11 @@ public:
         return u->hasInEdges();
     }
   
+    bool hasEdge( const NodeDescriptor& uD, const NodeDescriptor& vD)
+    {
+        return m_edgeIndex.find( uD, vD) != 0;
+    }
+
     bool hasNode( const NodeDescriptor& descriptor)
     {
         return descriptor != 0;
@@ -295,22 +433,69 @@ public:
     {
         return u->getDescriptor();
     }
+
+    /**
+     * @brief Returns the 32-bit index of a node descriptor, which can be stored instead of the descriptor
+     */
+    SizeType getDescriptorIndex( const NodeDescriptor& descriptor) const
+    {
+        return m_descriptors.getIndex( descriptor);
+    }
+
+    NodeDescriptor getDescriptorAtIndex( const SizeType& index) const
+    {
+        return m_descriptors.atIndex( index);
+    }
+
+    /**
+     * @brief Returns the position of a node in the pool of the node array. It is found from the address of the node alone
+     */
+    SizeType getNodeSlot( const NodeIterator& u)
+    {
+        return u.getAddress() - m_nodes.getPool();
+    }
+
+    NodeIterator getNodeAtSlot( const SizeType& slot)
+    {
+        return m_nodes.atIndex( slot);
+    }
+
+    SizeType getNumNodeSlots() const
+    {
+        return m_nodes.capacity();
+    }
+
+    /**
+     * @brief Returns the cold part of the data of a node, if its data is a HotColdPayload
+     */
+    typename ColdDataStorage<Vtype>::ColdData& getColdData( const NodeIterator& u)
+    {
+        return m_nodeColdData.get( *u);
+    }
+
+    /**
+     * @brief Returns the cold part of the data of an edge, if its data is a HotColdPayload
+     */
+    typename ColdDataStorage<Etype>::ColdData& getColdData( const EdgeIterator& e)
+    {
+        return m_edgeColdData.get( *e);
+    }
+
+    typename ColdDataStorage<Etype>::ColdData& getColdData( const InEdgeIterator& k)
+    {
+        return m_edgeColdData.get( *k);
+    }
     
+    /**
+     * @brief Returns the edge from one node to another in constant time, through the edge index
+     *
+     * @return The edge, or the end of the edges of the source if there is no such edge
+     */
     EdgeIterator getEdgeIterator( const NodeDescriptor& uD, const NodeDescriptor& vD)
     {
-        NodeIterator u = getNodeIterator( uD);
-        NodeIterator v = getNodeIterator( vD);
-        EdgeIterator e, end;
-        NodeIterator neigh;        
-        for( e = beginEdges(u), end = endEdges(u); e != end; ++e)
-        {
-            neigh = getAdjacentNodeIterator(e);
-            if( neigh == v)
-            {
-                break;
-            }
-        }
-        return e;
+        PMGEdge<Vtype,Etype>* address = m_edgeIndex.find( uD, vD);
+        if( !address) return endEdges( getNodeIterator( uD));
+        return m_edges.atAddress( address);
     }
     
     EdgeIterator getEdgeIterator( const InEdgeIterator& k) 
@@ -393,11 +578,13 @@ public:
 
         PMGEdge<Vtype, Etype> newEdge( v.getAddress());
         PMGInEdge<Vtype, Etype> newInEdge( u.getAddress());
+        m_edgeColdData.attach( newEdge, newInEdge);
         e = m_edges.insert( e, newEdge);
         k = m_inEdges.insert( k, newInEdge);        
 
         e->m_InEdge = k.getAddress();
         k->m_edge = e.getAddress();  
+        m_edgeIndex.insert( uD, vD, e.getAddress());
 
         assert( k->m_adjacentNode != 0);
 
@@ -494,11 +681,11 @@ public:
 
     NodeDescriptor insertNode() 
     { 
-        NodeDescriptor m_auxNodeDescriptor = new PMGNode<Vtype,Etype>*();
-        *m_auxNodeDescriptor = 0;
+        NodeDescriptor m_auxNodeDescriptor = m_descriptors.allocate();
         //std::cout << "\nMalloced for node" << m_auxNodeDescriptor << std::endl;
         PMGNode<Vtype,Etype> newNode;
         newNode.setDescriptor( m_auxNodeDescriptor);
+        m_nodeColdData.attach( newNode);
         NodeIterator m_auxNodeIterator = m_nodes.optimalInsert( newNode);
         //NodeIterator m_auxNodeIterator = m_nodes.insert( m_nodes.end(),newNode);
         //NodeIterator m_auxNodeIterator = m_nodes.insert( m_nodes.begin(),newNode);
@@ -510,11 +697,11 @@ public:
 
     NodeDescriptor insertNodeBefore( NodeDescriptor descriptor) 
     { 
-        NodeDescriptor m_auxNodeDescriptor = new PMGNode<Vtype,Etype>*();
+        NodeDescriptor m_auxNodeDescriptor = m_descriptors.allocate();
         
-        *m_auxNodeDescriptor = 0;
         PMGNode<Vtype,Etype> newNode;
         newNode.setDescriptor( m_auxNodeDescriptor);
+        m_nodeColdData.attach( newNode);
 
 
         NodeIterator m_auxNodeIterator = m_nodes.insert( getNodeIterator(descriptor), newNode);
@@ -634,6 +821,7 @@ public:
 
         PMGEdge<Vtype, Etype> newEdge( v.getAddress());
         PMGInEdge<Vtype, Etype> newInEdge( u.getAddress());
+        m_edgeColdData.attach( newEdge, newInEdge);
 
 
         m_edges.push_back( newEdge);
@@ -647,6 +835,7 @@ public:
 
         //k->m_adjacentNode = u.getPoolIndex();
         k->m_edge = e.getAddress();  
+        m_edgeIndex.insert( uD, vD, e.getAddress());
 
         assert( k->m_adjacentNode != 0);
 
@@ -712,6 +901,105 @@ public:
 
     }
 
+    /**
+     * @brief Lays out the graph again with the nodes in a new order
+     *
+     * The nodes, edges and incoming edges are collected in the new order in one pass and bulk
+     * loaded, so that the edges of consecutive nodes are consecutive in memory. The edges of a
+     * node keep their order. Node descriptors stay valid.
+     *
+     * @param order The descriptors of all the nodes, in their new order
+     */
+    void reorder( const std::vector<NodeDescriptor>& order)
+    {
+        SizeType numNodes = order.size();
+        assert( numNodes == m_nodes.size());
+
+        // The new position of every node, by its position in the pool
+        PMGNode<Vtype,Etype>* nodePool = m_nodes.getPool();
+        std::vector<SizeType> newPosition( m_nodes.getPoolSize());
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            newPosition[ *order[i] - nodePool] = i;
+        }
+
+        std::vector<SizeType> firstEdge( numNodes + 1), firstInEdge( numNodes + 1);
+        PMGInEdge<Vtype,Etype>* inEdgePool = m_inEdges.getPool();
+        std::vector<SizeType> inEdgePosition( m_inEdges.getPoolSize());
+        std::vector< PMGInEdge<Vtype,Etype> > inEdges;
+        std::vector<SizeType> inEdgeSource;
+        inEdges.reserve( m_inEdges.size());
+        inEdgeSource.reserve( m_inEdges.size());
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            PMGNode<Vtype,Etype>* node = *order[i];
+            firstInEdge[i] = inEdges.size();
+            if( !node->hasInEdges()) continue;
+            for( InEdgeIterator k = getInEdgeIteratorAtAddress( node->m_firstInEdge), end = getInEdgeIteratorAtAddress( node->m_lastInEdge); k != end; ++k)
+            {
+                inEdgePosition[ k.getAddress() - inEdgePool] = inEdges.size();
+                inEdgeSource.push_back( newPosition[ k->m_adjacentNode - nodePool]);
+                inEdges.push_back( *k);
+                inEdges.back().m_edge = 0;
+            }
+        }
+        firstInEdge[numNodes] = inEdges.size();
+
+        std::vector< PMGEdge<Vtype,Etype> > outEdges;
+        std::vector<SizeType> edgeTarget, inPosition;
+        outEdges.reserve( m_edges.size());
+        edgeTarget.reserve( m_edges.size());
+        inPosition.reserve( m_edges.size());
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            PMGNode<Vtype,Etype>* node = *order[i];
+            firstEdge[i] = outEdges.size();
+            if( !node->hasEdges()) continue;
+            for( EdgeIterator e = getEdgeIteratorAtAddress( node->m_firstEdge), end = getEdgeIteratorAtAddress( node->m_lastEdge); e != end; ++e)
+            {
+                edgeTarget.push_back( newPosition[ e->m_adjacentNode - nodePool]);
+                inPosition.push_back( inEdgePosition[ e->m_InEdge - inEdgePool]);
+                outEdges.push_back( *e);
+                outEdges.back().m_InEdge = 0;
+            }
+        }
+        firstEdge[numNodes] = outEdges.size();
+        std::vector<SizeType>().swap( newPosition);
+        std::vector<SizeType>().swap( inEdgePosition);
+
+        // Without edges the node observer only updates the descriptors
+        std::vector< PMGNode<Vtype,Etype> > nodes( numNodes);
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            nodes[i] = **order[i];
+            nodes[i].m_firstEdge = nodes[i].m_lastEdge = 0;
+            nodes[i].m_firstInEdge = nodes[i].m_lastInEdge = 0;
+        }
+        m_nodes.assign( nodes);
+        std::vector< PMGNode<Vtype,Etype> >().swap( nodes);
+
+        std::vector< PMGNode<Vtype,Etype>* > nodeAddress( numNodes);
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            nodeAddress[i] = *order[i];
+        }
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)outEdges.size(); ++i)
+        {
+            outEdges[i].m_adjacentNode = nodeAddress[ edgeTarget[i]];
+            inEdges[i].m_adjacentNode = nodeAddress[ inEdgeSource[i]];
+        }
+
+        m_edges.assign( outEdges);
+        m_inEdges.assign( inEdges);
+        std::vector< PMGEdge<Vtype,Etype> >().swap( outEdges);
+        std::vector< PMGInEdge<Vtype,Etype> >().swap( inEdges);
+        linkEdges( nodeAddress, firstEdge, firstInEdge, inPosition);
+
+        m_lastPushedNode = m_nodes.end();
+        m_currentPushedNode = m_nodes.end();
+    }
+
     void reserve( const SizeType& numNodes, const SizeType& numEdges)
     {
         std::cout << "\tReserving space for nodes\t";
@@ -737,12 +1025,221 @@ public:
 
 
 private:
+    /**
+     * A batch of at least 1/REBUILD_BATCH_RATIO of the edges is applied by laying out the edge arrays again
+     */
+    static const SizeType REBUILD_BATCH_RATIO = 16;
+
+    /**
+     * @brief Links the edges of bulk loaded edge arrays to each other and to their nodes
+     *
+     * @param nodes The nodes, in the order of the node array
+     * @param firstEdge The position of the first edge of every node, followed by the number of edges
+     * @param firstInEdge The position of the first incoming edge of every node, followed by the number of edges
+     * @param inPosition The position of the incoming edge of every edge
+     */
+    void linkEdges( const std::vector< PMGNode<Vtype,Etype>* >& nodes, const std::vector<SizeType>& firstEdge, const std::vector<SizeType>& firstInEdge, const std::vector<SizeType>& inPosition)
+    {
+        SizeType numNodes = nodes.size();
+        SizeType numEdges = inPosition.size();
+
+        std::vector< PMGEdge<Vtype,Etype>* > edgeAddress;
+        std::vector< PMGInEdge<Vtype,Etype>* > inEdgeAddress;
+        edgeAddress.reserve( numEdges + 1);
+        inEdgeAddress.reserve( numEdges + 1);
+        for( EdgeIterator e = m_edges.begin(), end = m_edges.end(); e != end; ++e)
+        {
+            edgeAddress.push_back( e.getAddress());
+        }
+        for( InEdgeIterator k = m_inEdges.begin(), end = m_inEdges.end(); k != end; ++k)
+        {
+            inEdgeAddress.push_back( k.getAddress());
+        }
+        // The edges past the last node with edges end at the end of the arrays
+        edgeAddress.push_back( 0);
+        inEdgeAddress.push_back( 0);
+
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)numEdges; ++i)
+        {
+            edgeAddress[i]->m_InEdge = inEdgeAddress[ inPosition[i]];
+            inEdgeAddress[ inPosition[i]]->m_edge = edgeAddress[i];
+        }
+
+        #pragma omp parallel for schedule(static)
+        for( long u = 0; u < (long)numNodes; ++u)
+        {
+            PMGNode<Vtype,Etype>* node = nodes[u];
+            node->m_firstEdge = node->m_lastEdge = 0;
+            node->m_firstInEdge = node->m_lastInEdge = 0;
+            if( firstEdge[u] != firstEdge[u+1])
+            {
+                node->m_firstEdge = edgeAddress[ firstEdge[u]];
+                node->m_lastEdge = edgeAddress[ firstEdge[u+1]];
+            }
+            if( firstInEdge[u] != firstInEdge[u+1])
+            {
+                node->m_firstInEdge = inEdgeAddress[ firstInEdge[u]];
+                node->m_lastInEdge = inEdgeAddress[ firstInEdge[u+1]];
+            }
+        }
+
+        m_edgeIndex.clear();
+        m_edgeIndex.reserve( numEdges);
+        for( SizeType u = 0; u < numNodes; ++u)
+        {
+            for( SizeType i = firstEdge[u]; i < firstEdge[u+1]; ++i)
+            {
+                m_edgeIndex.insert( nodes[u]->getDescriptor(), edgeAddress[i]->m_adjacentNode->getDescriptor(), edgeAddress[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Lays out the edge arrays again, without the erased edges and with the inserted ones
+     *
+     * The remaining edges of every node keep their order and the inserted ones follow them.
+     */
+    void rebuildEdges( const std::vector< std::pair<NodeDescriptor,NodeDescriptor> >& erasures, const std::vector< std::pair<NodeDescriptor,NodeDescriptor> >& insertions, const std::vector<Etype>& insertionData)
+    {
+        // The erased edges are met in the order of their addresses
+        std::vector< PMGEdge<Vtype,Etype>* > erasedEdges;
+        std::vector< PMGInEdge<Vtype,Etype>* > erasedInEdges;
+        erasedEdges.reserve( erasures.size());
+        erasedInEdges.reserve( erasures.size());
+        for( SizeType i = 0; i < erasures.size(); ++i)
+        {
+            EdgeIterator e = getEdgeIterator( erasures[i].first, erasures[i].second);
+            erasedEdges.push_back( e.getAddress());
+            m_edgeColdData.detach( *e);
+            erasedInEdges.push_back( e->m_InEdge);
+        }
+        std::sort( erasedEdges.begin(), erasedEdges.end());
+        std::sort( erasedInEdges.begin(), erasedInEdges.end());
+
+        std::vector< PMGNode<Vtype,Etype>* > nodes;
+        nodes.reserve( m_nodes.size());
+        for( NodeIterator u = m_nodes.begin(), end = m_nodes.end(); u != end; ++u)
+        {
+            nodes.push_back( u.getAddress());
+        }
+        SizeType numNodes = nodes.size();
+        SizeType numEdges = m_edges.size() - erasures.size() + insertions.size();
+
+        std::vector<SizeType> bySource, byTarget;
+        sortByNode( insertions, true, bySource);
+        sortByNode( insertions, false, byTarget);
+
+        std::vector<SizeType> firstEdge( numNodes + 1), firstInEdge( numNodes + 1), inPosition( numEdges);
+        std::vector<SizeType> insertionPosition( insertions.size());
+        std::vector<SizeType> edgePosition( m_edges.getPoolSize());
+        PMGEdge<Vtype,Etype>* edgePool = m_edges.getPool();
+
+        // The remaining edges of every node, followed by its inserted edges
+        std::vector< PMGEdge<Vtype,Etype> > outEdges;
+        outEdges.reserve( numEdges);
+        SizeType erased = 0, inserted = 0;
+        for( SizeType u = 0; u < numNodes; ++u)
+        {
+            PMGNode<Vtype,Etype>* node = nodes[u];
+            firstEdge[u] = outEdges.size();
+            if( node->hasEdges())
+            {
+                for( EdgeIterator e = getEdgeIteratorAtAddress( node->m_firstEdge), end = getEdgeIteratorAtAddress( node->m_lastEdge); e != end; ++e)
+                {
+                    if( erased < erasedEdges.size() && erasedEdges[erased] == e.getAddress())
+                    {
+                        ++erased;
+                        continue;
+                    }
+                    edgePosition[ e.getAddress() - edgePool] = outEdges.size();
+                    outEdges.push_back( *e);
+                    outEdges.back().m_InEdge = 0;
+                }
+            }
+            for( ; inserted < bySource.size() && *insertions[ bySource[inserted]].first == node; ++inserted)
+            {
+                SizeType i = bySource[inserted];
+                insertionPosition[i] = outEdges.size();
+                outEdges.push_back( PMGEdge<Vtype,Etype>( *insertions[i].second));
+                m_edgeColdData.assign( outEdges.back(), insertionData[i]);
+            }
+        }
+        firstEdge[numNodes] = outEdges.size();
+
+        std::vector< PMGInEdge<Vtype,Etype> > inEdges;
+        inEdges.reserve( numEdges);
+        erased = inserted = 0;
+        for( SizeType u = 0; u < numNodes; ++u)
+        {
+            PMGNode<Vtype,Etype>* node = nodes[u];
+            firstInEdge[u] = inEdges.size();
+            if( node->hasInEdges())
+            {
+                for( InEdgeIterator k = getInEdgeIteratorAtAddress( node->m_firstInEdge), end = getInEdgeIteratorAtAddress( node->m_lastInEdge); k != end; ++k)
+                {
+                    if( erased < erasedInEdges.size() && erasedInEdges[erased] == k.getAddress())
+                    {
+                        ++erased;
+                        continue;
+                    }
+                    inPosition[ edgePosition[ k->m_edge - edgePool]] = inEdges.size();
+                    inEdges.push_back( *k);
+                    inEdges.back().m_edge = 0;
+                }
+            }
+            for( ; inserted < byTarget.size() && *insertions[ byTarget[inserted]].second == node; ++inserted)
+            {
+                SizeType i = byTarget[inserted];
+                inPosition[ insertionPosition[i]] = inEdges.size();
+                inEdges.push_back( PMGInEdge<Vtype,Etype>( *insertions[i].first));
+                m_edgeColdData.assign( inEdges.back(), insertionData[i]);
+                m_edgeColdData.attach( outEdges[ insertionPosition[i]], inEdges.back());
+            }
+        }
+        firstInEdge[numNodes] = inEdges.size();
+        std::vector<SizeType>().swap( edgePosition);
+
+        m_edges.assign( outEdges);
+        m_inEdges.assign( inEdges);
+        std::vector< PMGEdge<Vtype,Etype> >().swap( outEdges);
+        std::vector< PMGInEdge<Vtype,Etype> >().swap( inEdges);
+        linkEdges( nodes, firstEdge, firstInEdge, inPosition);
+
+        m_lastPushedNode = m_nodes.end();
+        m_currentPushedNode = m_nodes.end();
+    }
+
+    /**
+     * @brief Orders edges by the position of their source, or their target, in the node array
+     *
+     * @param order Filled with the positions of the edges in the new order
+     */
+    void sortByNode( const std::vector< std::pair<NodeDescriptor,NodeDescriptor> >& edges, bool bySource, std::vector<SizeType>& order)
+    {
+        std::vector< std::pair< PMGNode<Vtype,Etype>*, SizeType> > keys( edges.size());
+        for( SizeType i = 0; i < edges.size(); ++i)
+        {
+            keys[i] = std::make_pair( bySource ? *edges[i].first : *edges[i].second, i);
+        }
+        std::sort( keys.begin(), keys.end());
+        order.resize( edges.size());
+        for( SizeType i = 0; i < edges.size(); ++i)
+        {
+            order[i] = keys[i].second;
+        }
+    }
+
     PackedMemoryArray< PMGNode< Vtype, Etype> >     m_nodes;
     PackedMemoryArray< PMGEdge< Vtype, Etype> >     m_edges; 
     PackedMemoryArray< PMGInEdge< Vtype, Etype> >   m_inEdges;
     PMGNodeObserver< Vtype, Etype>*                 m_nodeObserver;
     PMGEdgeObserver< Vtype, Etype>*                 m_edgeObserver;
     PMGInEdgeObserver< Vtype, Etype>*               m_InEdgeObserver;
+    PMGEdgeIndex< Vtype, Etype>                     m_edgeIndex;
+    SlabAllocator< PMGNode< Vtype, Etype>* >        m_descriptors;
+    ColdDataStorage< Vtype>                         m_nodeColdData;
+    ColdDataStorage< Etype>                         m_edgeColdData;
 
     NodeIterator m_lastPushedNode, m_currentPushedNode;
 
@@ -759,14 +1256,16 @@ public:
     
     PMGEdge( unsigned int init = 0): Etype(),
                         m_adjacentNode(0), 
-                        m_InEdge(0)
+                        m_InEdge(0),
+                        m_indexSlot(0)
     {
     }
    
     PMGEdge( PMGNode<Vtype,Etype>* adjacentNode):
             Etype(),
 			m_adjacentNode(adjacentNode),
-			m_InEdge(0)
+			m_InEdge(0),
+			m_indexSlot(0)
     {
     }
 
@@ -812,6 +1311,7 @@ public:
 
     PMGNode<Vtype,Etype>*       m_adjacentNode;
     PMGInEdge<Vtype,Etype>*     m_InEdge;   
+    SizeType                    m_indexSlot;
 };
 
 
@@ -1018,6 +1518,7 @@ public:
         if( !(edge.m_InEdge)) return;      
         
         edge.m_InEdge->m_edge = destination;
+        m_G->m_edgeIndex.move( edge.m_indexSlot, destination);
 
         /*if( source == (PMGEdge<Vtype,Etype>*)0x139c910)
         {
@@ -1101,4 +1602,149 @@ private:
 };
 
 
+/**
+ * @brief Finds the edge from one node to another in constant expected time
+ *
+ * An open addressing hash table with linear probing, keyed by the descriptors of the source and
+ * the target, which do not change when nodes move. Every edge keeps the slot of its entry, so
+ * that PMGEdgeObserver updates the address of a moved edge without a search, as node descriptors
+ * are updated by PMGNodeObserver. Entries that are shifted back by an erasure, or moved by a
+ * resize, update the slot of their edge.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename Vtype, typename Etype>
+class PMGEdgeIndex
+{
+public:
+    typedef typename PackedMemoryGraphImpl<Vtype,Etype>::NodeDescriptor NodeDescriptor;
+    typedef typename PackedMemoryGraphImpl<Vtype,Etype>::SizeType       SizeType;
+
+    PMGEdgeIndex()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        m_entries.assign( MIN_CAPACITY, Entry());
+        m_mask = MIN_CAPACITY - 1;
+        m_size = 0;
+    }
+
+    /**
+     * @brief Makes room for a number of edges, so that inserting them causes no resizes
+     */
+    void reserve( SizeType numEdges)
+    {
+        SizeType capacity = MIN_CAPACITY;
+        while( capacity * 3 < numEdges * 4) capacity <<= 1;
+        if( capacity > m_entries.size()) resize( capacity);
+    }
+
+    /**
+     * @brief Returns the address of the edge from one node to another, or 0 if there is no such edge
+     */
+    PMGEdge<Vtype,Etype>* find( const NodeDescriptor& uD, const NodeDescriptor& vD) const
+    {
+        for( SizeType slot = hash( uD, vD); m_entries[slot].edge; slot = ( slot + 1) & m_mask)
+        {
+            if( m_entries[slot].source == uD && m_entries[slot].target == vD) return m_entries[slot].edge;
+        }
+        return 0;
+    }
+
+    void insert( const NodeDescriptor& uD, const NodeDescriptor& vD, PMGEdge<Vtype,Etype>* edge)
+    {
+        if( ( m_size + 1) * 4 > m_entries.size() * 3) resize( m_entries.size() * 2);
+        SizeType slot = hash( uD, vD);
+        while( m_entries[slot].edge) slot = ( slot + 1) & m_mask;
+        place( slot, Entry( uD, vD, edge));
+        ++m_size;
+    }
+
+    /**
+     * @brief Erases the entry of an edge, and shifts back the entries that follow it, so that no probe sequence is broken
+     */
+    void erase( PMGEdge<Vtype,Etype>* edge)
+    {
+        SizeType hole = edge->m_indexSlot;
+        assert( m_entries[hole].edge == edge);
+        m_entries[hole] = Entry();
+        --m_size;
+
+        for( SizeType slot = ( hole + 1) & m_mask; m_entries[slot].edge; slot = ( slot + 1) & m_mask)
+        {
+            SizeType home = hash( m_entries[slot].source, m_entries[slot].target);
+            if( ( ( slot - home) & m_mask) >= ( ( slot - hole) & m_mask))
+            {
+                place( hole, m_entries[slot]);
+                m_entries[slot] = Entry();
+                hole = slot;
+            }
+        }
+    }
+
+    /**
+     * @brief Records the new address of an edge that moved
+     */
+    void move( SizeType slot, PMGEdge<Vtype,Etype>* destination)
+    {
+        m_entries[slot].edge = destination;
+    }
+
+private:
+    static const SizeType MIN_CAPACITY = 16;
+
+    struct Entry
+    {
+        Entry():source(0),target(0),edge(0)
+        {
+        }
+
+        Entry( NodeDescriptor source, NodeDescriptor target, PMGEdge<Vtype,Etype>* edge):source(source),target(target),edge(edge)
+        {
+        }
+
+        NodeDescriptor          source;
+        NodeDescriptor          target;
+        PMGEdge<Vtype,Etype>*   edge;
+    };
+
+    std::vector<Entry>  m_entries;
+    SizeType            m_mask;
+    SizeType            m_size;
+
+    SizeType hash( const NodeDescriptor& uD, const NodeDescriptor& vD) const
+    {
+        uint64_t key = ( reinterpret_cast<uintptr_t>( uD) >> 3) * 0x9E3779B97F4A7C15ULL ^ ( reinterpret_cast<uintptr_t>( vD) >> 3);
+        return SizeType( ( key * 0xC2B2AE3D27D4EB4FULL) >> 32) & m_mask;
+    }
+
+    void place( SizeType slot, const Entry& entry)
+    {
+        m_entries[slot] = entry;
+        entry.edge->m_indexSlot = slot;
+    }
+
+    void resize( SizeType capacity)
+    {
+        std::vector<Entry> entries( capacity);
+        m_entries.swap( entries);
+        m_mask = capacity - 1;
+        for( SizeType i = 0; i < entries.size(); ++i)
+        {
+            if( !entries[i].edge) continue;
+            SizeType slot = hash( entries[i].source, entries[i].target);
+            while( m_entries[slot].edge) slot = ( slot + 1) & m_mask;
+            place( slot, entries[i]);
+        }
+    }
+};
+
+template<typename Vtype, typename Etype>
+const typename PMGEdgeIndex<Vtype,Etype>::SizeType PMGEdgeIndex<Vtype,Etype>::MIN_CAPACITY;
+
+
 #endif //PACKEDMEMORYGRAPHIMPL_H
@@ -550,7 +550,7 @@ public:
         return *m_ptr;
     }
 
-    DataType* operator -> ()
+    DataType* operator -> () const
     {
         return m_ptr;
     }
@@ -1,6 +1,8 @@
 #ifndef BINARYMATH_H
 #define BINARYMATH_H
 
+#include <stdint.h>
+
 //changed comment
 
 inline unsigned int modulusPow2( unsigned int divident, unsigned int powerOf2Divisor)
@@ -86,5 +88,38 @@ inline int isPowerOf2 (unsigned int x)
  return (x == 1);
 }
 
+inline unsigned int popCount64( uint64_t x)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll( x);
+#else
+    x = x - ( ( x >> 1) & 0x5555555555555555ULL);
+    x = ( x & 0x3333333333333333ULL) + ( ( x >> 2) & 0x3333333333333333ULL);
+    x = ( x + ( x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return ( x * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+/**
+ * @brief Returns the position of the lowest set bit of a non-zero word
+ */
+inline unsigned int countTrailingZeros64( uint64_t x)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll( x);
+#else
+    return popCount64( ( x & -x) - 1);
+#endif
+}
+
+/**
+ * @brief Scrambles the bits of a word, so that close words give unrelated results (the finalizer of splitmix64)
+ */
+inline uint64_t mixBits64( uint64_t x)
+{
+    x = ( x ^ ( x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = ( x ^ ( x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ ( x >> 31);
+}
 
 #endif //BINARYMATH_H
@@ -0,0 +1,360 @@
+#ifndef CHANGELOG_H
+#define CHANGELOG_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <Utilities/graphIO.h>
+#include <Utilities/outputBuffer.h>
+#include <Utilities/numberParsing.h>
+#include <Utilities/timer.h>
+
+/**
+ * Change logs are text files, compressed or not, with one change of a graph per line:
+ *
+ *     c <comment>
+ *     an <id>                   adds a node with an id
+ *     dn <id>                   erases a node and its edges
+ *     ae <source> <target> <w>  adds an edge with weight w, or sets its weight if it exists
+ *     de <source> <target>      erases an edge
+ *     sw <source> <target> <w>  sets the weight of an edge
+ *
+ * Node ids are positions in the vector of descriptors of the graph, such as the one returned by
+ * GraphReader::getIds().
+ */
+
+
+/**
+ * @brief Writes a change log
+ *
+ * @author Panos Michail
+ *
+ */
+class ChangeLogWriter
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param filename The name of the file. It is compressed if its extension is .gz or .zst
+     * @param backgroundWriter If true, a background thread writes the output to the file
+     */
+    ChangeLogWriter( const std::string& filename, bool backgroundWriter = false):m_out( 1 << 22, backgroundWriter)
+    {
+        m_out.open( filename);
+    }
+
+    void comment( const std::string& text)      { m_out << "c " << text << '\n'; }
+    void addNode( unsigned int id)              { m_out << "an " << id << '\n'; }
+    void eraseNode( unsigned int id)            { m_out << "dn " << id << '\n'; }
+    void eraseEdge( unsigned int source, unsigned int target) { m_out << "de " << source << ' ' << target << '\n'; }
+
+    void addEdge( unsigned int source, unsigned int target, unsigned int weight)
+    {
+        m_out << "ae " << source << ' ' << target << ' ' << weight << '\n';
+    }
+
+    void setWeight( unsigned int source, unsigned int target, unsigned int weight)
+    {
+        m_out << "sw " << source << ' ' << target << ' ' << weight << '\n';
+    }
+
+    /**
+     * @brief Hands the buffered changes to the file, so that a reader on a pipe sees them
+     */
+    void flush()
+    {
+        m_out.flush();
+    }
+
+    void close()
+    {
+        m_out.close();
+    }
+
+private:
+    OutputBuffer m_out;
+};
+
+
+/**
+ * @brief Applies change logs to a graph
+ *
+ * Edge changes are collected in batches. A batch is reduced to the net change of every edge, in
+ * the order of the log, and handed to the graph in one call, so that the implementation can
+ * reorder it by region and apply it with few rebalances (see DynamicGraph::applyEdgeBatch).
+ * Node changes are applied immediately; an erased node first flushes the batch, so that the
+ * result is the same as applying the log line by line.
+ *
+ * Edges need the field weight. Changes with unknown node ids and malformed lines are ignored
+ * and counted.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename GraphType>
+class ChangeLogApplier
+{
+public:
+    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
+    typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+    typedef typename GraphType::EdgeData        EdgeData;
+    typedef typename GraphType::SizeType        SizeType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param G The graph
+     * @param ids The descriptors of the nodes by id. Added and erased nodes are recorded in it
+     * @param batchSize The number of edge changes that are collected before they are applied
+     */
+    ChangeLogApplier( GraphType& G, std::vector<NodeDescriptor>& ids, SizeType batchSize = 1 << 16):G(G),m_ids(ids),m_batchSize(batchSize),
+        m_numChanges(0),m_numIgnored(0),m_numBatches(0)
+    {
+        m_batch.reserve( m_batchSize);
+    }
+
+    /**
+     * @brief Applies a change log and reports the throughput
+     *
+     * A pipe, or the standard input with the filename "-", is applied while it is written: the
+     * changes that have arrived are applied whenever the writer pauses.
+     *
+     * @param filename The name of the file
+     * @param verbose Whether the progress and the throughput are printed
+     */
+    void apply( const std::string& filename, bool verbose = true)
+    {
+        if( verbose) std::cout << "Applying changes from " << filename << std::endl;
+        TextBlockReader file;
+        openTextFile( file, filename);
+
+        SizeType numChanges = m_numChanges, numIgnored = m_numIgnored, numBatches = m_numBatches;
+        Timer timer;
+        timer.start();
+        const char* first;
+        const char* last;
+        while( file.next( first, last))
+        {
+            parse( first, last);
+            if( file.isStream()) flush();
+        }
+        flush();
+        timer.stop();
+        if( !verbose) return;
+
+        numChanges = m_numChanges - numChanges;
+        double seconds = timer.getElapsedTimeInSec();
+        std::cout << "\tApplied " << numChanges << " changes in " << m_numBatches - numBatches << " batches in " << seconds << "s";
+        if( seconds > 0) std::cout << " (" << SizeType( numChanges / seconds) << " changes/s)";
+        std::cout << "\n\tIgnored " << m_numIgnored - numIgnored << " changes\n";
+        std::cout << "\tGraph has " << G.getNumNodes() << " nodes and " << G.getNumEdges() << " edges\n";
+    }
+
+    void addNode( SizeType id)
+    {
+        if( id >= m_ids.size()) m_ids.resize( id + 1, 0);
+        if( m_ids[id])
+        {
+            ++m_numIgnored;
+            return;
+        }
+        m_ids[id] = G.insertNode();
+        ++m_numChanges;
+    }
+
+    void eraseNode( SizeType id)
+    {
+        if( !isNode( id))
+        {
+            ++m_numIgnored;
+            return;
+        }
+        flush();
+        G.eraseNode( m_ids[id]);
+        m_ids[id] = 0;
+        ++m_numChanges;
+    }
+
+    void addEdge( SizeType source, SizeType target, unsigned int weight)
+    {
+        queue( ADD_EDGE, source, target, weight);
+    }
+
+    void eraseEdge( SizeType source, SizeType target)
+    {
+        queue( ERASE_EDGE, source, target, 0);
+    }
+
+    void setWeight( SizeType source, SizeType target, unsigned int weight)
+    {
+        queue( SET_WEIGHT, source, target, weight);
+    }
+
+    /**
+     * @brief Applies the collected edge changes
+     */
+    void flush()
+    {
+        if( m_batch.empty()) return;
+
+        // The changes of every edge in the order of the log
+        std::stable_sort( m_batch.begin(), m_batch.end());
+
+        std::vector<EdgeDescriptor> erasures, insertions, weightChanges;
+        std::vector<EdgeData> insertionData;
+        std::vector<unsigned int> weights;
+        for( SizeType i = 0; i < m_batch.size(); )
+        {
+            SizeType source = m_batch[i].source, target = m_batch[i].target;
+            ChangeType type = m_batch[i].type;
+            unsigned int weight = m_batch[i].weight;
+            bool erased = ( type == ERASE_EDGE);
+            for( ++i; i < m_batch.size() && m_batch[i].source == source && m_batch[i].target == target; ++i)
+            {
+                // A new weight keeps an added or erased edge added or erased
+                if( m_batch[i].type != SET_WEIGHT) type = m_batch[i].type;
+                if( m_batch[i].type != ERASE_EDGE) weight = m_batch[i].weight;
+                if( m_batch[i].type == ERASE_EDGE) erased = true;
+            }
+
+            EdgeDescriptor eD( m_ids[source], m_ids[target]);
+            if( type == ERASE_EDGE)
+            {
+                erasures.push_back( eD);
+            }
+            // Adding an edge that exists only sets its weight, unless the batch erased it before
+            else if( type == ADD_EDGE && ( erased || !G.hasEdge( eD)))
+            {
+                EdgeData data;
+                data.weight = weight;
+                insertions.push_back( eD);
+                insertionData.push_back( data);
+            }
+            else
+            {
+                weightChanges.push_back( eD);
+                weights.push_back( weight);
+            }
+        }
+        m_batch.clear();
+
+        for( SizeType i = 0; i < weightChanges.size(); ++i)
+        {
+            if( !G.hasEdge( weightChanges[i])) continue;
+            EdgeIterator e = G.getEdgeIterator( weightChanges[i]);
+            e->weight = weights[i];
+            G.getInEdgeIterator(e)->weight = weights[i];
+        }
+        if( !weightChanges.empty()) G.markModified();
+        G.applyEdgeBatch( erasures, insertions, insertionData);
+        ++m_numBatches;
+    }
+
+    SizeType getNumChanges() const
+    {
+        return m_numChanges;
+    }
+
+    SizeType getNumIgnored() const
+    {
+        return m_numIgnored;
+    }
+
+private:
+    enum ChangeType { ADD_EDGE, ERASE_EDGE, SET_WEIGHT };
+
+    struct EdgeChange
+    {
+        SizeType source;
+        SizeType target;
+        ChangeType type;
+        unsigned int weight;
+
+        bool operator < ( const EdgeChange& other) const
+        {
+            if( source != other.source) return source < other.source;
+            return target < other.target;
+        }
+    };
+
+    GraphType& G;
+    std::vector<NodeDescriptor>& m_ids;
+    SizeType m_batchSize;
+    std::vector<EdgeChange> m_batch;
+    SizeType m_numChanges;
+    SizeType m_numIgnored;
+    SizeType m_numBatches;
+
+    bool isNode( SizeType id) const
+    {
+        return id < m_ids.size() && m_ids[id];
+    }
+
+    void queue( ChangeType type, SizeType source, SizeType target, unsigned int weight)
+    {
+        if( !isNode( source) || !isNode( target) || source == target)
+        {
+            ++m_numIgnored;
+            return;
+        }
+        EdgeChange change = { source, target, type, weight };
+        m_batch.push_back( change);
+        ++m_numChanges;
+        if( m_batch.size() >= m_batchSize) flush();
+    }
+
+    static bool parseNumber( const char*& p, const char* end, SizeType& number)
+    {
+        p = skipBlanks( p, end);
+        if( p == end || !isDigit( *p)) return false;
+        number = parseUnsigned( p, end);
+        return true;
+    }
+
+    /**
+     * @brief Applies the lines of a block
+     */
+    void parse( const char* p, const char* end)
+    {
+        while( p != end)
+        {
+            const char* line = p;
+            p = skipLine( p, end);
+            if( p - line < 2 || *line == 'c' || *line == '\n') continue;
+
+            char operation = line[0], item = line[1];
+            const char* q = line + 2;
+            SizeType source, target, weight;
+            if( operation == 'a' && item == 'n' && parseNumber( q, p, source))
+            {
+                addNode( source);
+            }
+            else if( operation == 'd' && item == 'n' && parseNumber( q, p, source))
+            {
+                eraseNode( source);
+            }
+            else if( operation == 'a' && item == 'e' && parseNumber( q, p, source) && parseNumber( q, p, target) && parseNumber( q, p, weight))
+            {
+                addEdge( source, target, weight);
+            }
+            else if( operation == 'd' && item == 'e' && parseNumber( q, p, source) && parseNumber( q, p, target))
+            {
+                eraseEdge( source, target);
+            }
+            else if( operation == 's' && item == 'w' && parseNumber( q, p, source) && parseNumber( q, p, target) && parseNumber( q, p, weight))
+            {
+                setWeight( source, target, weight);
+            }
+            else
+            {
+                ++m_numIgnored;
+            }
+        }
+    }
+};
+
+#endif //CHANGELOG_H
@@ -0,0 +1,438 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+//gzip support through zlib (can be set by compilerflag -DZLIBSUPPORT, link with -lz)
+#ifdef ZLIBSUPPORT
+#include <zlib.h>
+#endif
+
+//zstd support through libzstd (can be set by compilerflag -DZSTDSUPPORT, link with -lzstd)
+#ifdef ZSTDSUPPORT
+#include <zstd.h>
+#endif
+
+/**
+ * Streaming compression and decompression of files for the graph readers and writers.
+ *
+ * The format of a file is given by its extension: ".gz" for gzip and ".zst" for zstd. Every
+ * format needs its library to be enabled at compile time; opening a file of a format that is not
+ * enabled throws std::ifstream::failure or std::ofstream::failure.
+ */
+
+enum CompressionType { NO_COMPRESSION, GZIP_COMPRESSION, ZSTD_COMPRESSION };
+
+inline bool hasExtension( const std::string& filename, const std::string& extension)
+{
+    return filename.size() > extension.size() &&
+           filename.compare( filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/**
+ * @brief Returns the compression of a file, judging from its extension
+ */
+inline CompressionType getCompressionType( const std::string& filename)
+{
+    if( hasExtension( filename, ".gz")) return GZIP_COMPRESSION;
+    if( hasExtension( filename, ".zst")) return ZSTD_COMPRESSION;
+    return NO_COMPRESSION;
+}
+
+/**
+ * @brief Returns true if the library of a compression format is compiled in
+ */
+inline bool isCompressionSupported( CompressionType type)
+{
+    switch( type)
+    {
+        case NO_COMPRESSION:
+            return true;
+        case GZIP_COMPRESSION:
+#ifdef ZLIBSUPPORT
+            return true;
+#else
+            return false;
+#endif
+        case ZSTD_COMPRESSION:
+#ifdef ZSTDSUPPORT
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+inline const char* getCompressionFlag( CompressionType type)
+{
+    return type == GZIP_COMPRESSION ? "-DZLIBSUPPORT" : "-DZSTDSUPPORT";
+}
+
+
+/**
+ * @brief Decompresses a file descriptor into consecutive ranges of memory
+ *
+ * @author Panos Michail
+ *
+ */
+class StreamDecompressor
+{
+public:
+    StreamDecompressor():m_type(NO_COMPRESSION),m_fd(-1),m_isInputFinished(false),m_isInFrame(false),m_isFinished(false),m_hasFailed(false)
+    {
+#ifdef ZSTDSUPPORT
+        m_zstdStream = 0;
+#endif
+    }
+
+    ~StreamDecompressor()
+    {
+        close();
+    }
+
+    /**
+     * @brief Starts decompressing a file
+     *
+     * @param type The compression of the file. It must be supported
+     * @param fd The file descriptor, open for reading. It is not closed by the decompressor
+     */
+    void open( CompressionType type, int fd)
+    {
+        close();
+        m_type = type;
+        m_fd = fd;
+        m_isInputFinished = false;
+        m_isInFrame = false;
+        m_isFinished = false;
+        m_hasFailed = false;
+        m_input.resize( 1 << 20);
+        m_inputBegin = m_inputEnd = 0;
+
+#ifdef ZLIBSUPPORT
+        if( m_type == GZIP_COMPRESSION)
+        {
+            memset( &m_zlibStream, 0, sizeof( m_zlibStream));
+            // 32 lets zlib detect gzip and zlib headers
+            if( inflateInit2( &m_zlibStream, 15 + 32) != Z_OK) m_hasFailed = true;
+        }
+#endif
+#ifdef ZSTDSUPPORT
+        if( m_type == ZSTD_COMPRESSION)
+        {
+            m_zstdStream = ZSTD_createDStream();
+            if( !m_zstdStream || ZSTD_isError( ZSTD_initDStream( m_zstdStream))) m_hasFailed = true;
+            m_input.resize( ZSTD_DStreamInSize());
+        }
+#endif
+    }
+
+    void close()
+    {
+        if( m_fd < 0) return;
+#ifdef ZLIBSUPPORT
+        if( m_type == GZIP_COMPRESSION) inflateEnd( &m_zlibStream);
+#endif
+#ifdef ZSTDSUPPORT
+        if( m_type == ZSTD_COMPRESSION && m_zstdStream) ZSTD_freeDStream( m_zstdStream);
+        m_zstdStream = 0;
+#endif
+        m_fd = -1;
+    }
+
+    /**
+     * @brief Decompresses up to capacity bytes
+     *
+     * @return The number of bytes written to output. It is less than capacity only at the end of the file
+     */
+    size_t read( char* output, size_t capacity)
+    {
+        size_t size = 0;
+        while( size < capacity && !m_isFinished && !m_hasFailed)
+        {
+            if( m_inputBegin == m_inputEnd && !m_isInputFinished) fillInput();
+            size += decompress( output + size, capacity - size);
+        }
+        return size;
+    }
+
+    /**
+     * @brief Decompresses the input that is available, reading from the file only if there is none
+     *
+     * Suits pipes, where waiting for capacity bytes could stall the reader indefinitely.
+     *
+     * @return The number of bytes written to output. It is zero only at the end of the file
+     */
+    size_t readSome( char* output, size_t capacity)
+    {
+        size_t size = 0;
+        while( size == 0 && !m_isFinished && !m_hasFailed)
+        {
+            if( m_inputBegin == m_inputEnd && !m_isInputFinished) fillInput();
+            size += decompress( output, capacity);
+        }
+        return size;
+    }
+
+    bool isFinished() const
+    {
+        return m_isFinished;
+    }
+
+    bool hasFailed() const
+    {
+        return m_hasFailed;
+    }
+
+private:
+    CompressionType m_type;
+    int m_fd;
+    std::vector<char> m_input;
+    size_t m_inputBegin, m_inputEnd;
+    bool m_isInputFinished;
+    bool m_isInFrame;
+    bool m_isFinished;
+    bool m_hasFailed;
+
+#ifdef ZLIBSUPPORT
+    z_stream m_zlibStream;
+#endif
+#ifdef ZSTDSUPPORT
+    ZSTD_DStream* m_zstdStream;
+#endif
+
+    StreamDecompressor( const StreamDecompressor&);
+    StreamDecompressor& operator = ( const StreamDecompressor&);
+
+    void fillInput()
+    {
+        ssize_t size;
+        do
+        {
+            size = ::read( m_fd, &m_input[0], m_input.size());
+        }
+        while( size < 0 && errno == EINTR);
+
+        if( size < 0)
+        {
+            m_hasFailed = true;
+            return;
+        }
+        m_inputBegin = 0;
+        m_inputEnd = size;
+        if( size == 0) m_isInputFinished = true;
+    }
+
+    /**
+     * @brief Decompresses the buffered input, and returns the number of bytes written to output
+     */
+    size_t decompress( char* output, size_t capacity)
+    {
+        size_t size = 0;
+        size_t inputBegin = m_inputBegin;
+        bool isFrameFinished = false;
+
+        if( m_type == NO_COMPRESSION)
+        {
+            size = std::min( capacity, m_inputEnd - m_inputBegin);
+            memcpy( output, &m_input[0] + m_inputBegin, size);
+            m_inputBegin += size;
+            isFrameFinished = true;
+        }
+#ifdef ZLIBSUPPORT
+        if( m_type == GZIP_COMPRESSION)
+        {
+            m_zlibStream.next_in = reinterpret_cast<Bytef*>( &m_input[0] + m_inputBegin);
+            m_zlibStream.avail_in = m_inputEnd - m_inputBegin;
+            m_zlibStream.next_out = reinterpret_cast<Bytef*>( output);
+            m_zlibStream.avail_out = capacity;
+            int result = inflate( &m_zlibStream, Z_NO_FLUSH);
+            m_inputBegin = m_inputEnd - m_zlibStream.avail_in;
+            size = capacity - m_zlibStream.avail_out;
+            if( result == Z_STREAM_END)
+            {
+                // A gzip file may consist of several members
+                isFrameFinished = true;
+                inflateReset( &m_zlibStream);
+            }
+            else if( result != Z_OK && !( result == Z_BUF_ERROR && m_inputBegin == m_inputEnd))
+            {
+                m_hasFailed = true;
+            }
+        }
+#endif
+#ifdef ZSTDSUPPORT
+        if( m_type == ZSTD_COMPRESSION)
+        {
+            ZSTD_inBuffer in = { &m_input[0], m_inputEnd, m_inputBegin };
+            ZSTD_outBuffer out = { output, capacity, 0 };
+            size_t result = ZSTD_decompressStream( m_zstdStream, &out, &in);
+            m_inputBegin = in.pos;
+            size = out.pos;
+            if( ZSTD_isError( result)) m_hasFailed = true;
+            else if( result == 0) isFrameFinished = true;
+        }
+#endif
+
+        if( m_inputBegin != inputBegin || size) m_isInFrame = true;
+        if( isFrameFinished) m_isInFrame = false;
+
+        // Without input, output is left behind only if the output range was filled
+        if( m_isInputFinished && m_inputBegin == m_inputEnd && size < capacity)
+        {
+            // A file that ends in the middle of a frame is truncated
+            if( m_isInFrame) m_hasFailed = true;
+            m_isFinished = true;
+        }
+        return size;
+    }
+};
+
+
+/**
+ * @brief Compresses consecutive ranges of memory into a buffer
+ *
+ * @author Panos Michail
+ *
+ */
+class StreamCompressor
+{
+public:
+    StreamCompressor():m_type(NO_COMPRESSION),m_isOpen(false)
+    {
+#ifdef ZSTDSUPPORT
+        m_zstdStream = 0;
+#endif
+    }
+
+    ~StreamCompressor()
+    {
+        close();
+    }
+
+    /**
+     * @brief Starts a compressed stream
+     *
+     * @param type The compression. It must be supported
+     * @return False if the compressor could not be initialized
+     */
+    bool open( CompressionType type)
+    {
+        close();
+        m_type = type;
+        m_isOpen = true;
+#ifdef ZLIBSUPPORT
+        if( m_type == GZIP_COMPRESSION)
+        {
+            memset( &m_zlibStream, 0, sizeof( m_zlibStream));
+            // 16 writes a gzip header instead of a zlib one
+            if( deflateInit2( &m_zlibStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+        }
+#endif
+#ifdef ZSTDSUPPORT
+        if( m_type == ZSTD_COMPRESSION)
+        {
+            m_zstdStream = ZSTD_createCStream();
+            if( !m_zstdStream || ZSTD_isError( ZSTD_initCStream( m_zstdStream, 3))) return false;
+        }
+#endif
+        return true;
+    }
+
+    void close()
+    {
+        if( !m_isOpen) return;
+#ifdef ZLIBSUPPORT
+        if( m_type == GZIP_COMPRESSION) deflateEnd( &m_zlibStream);
+#endif
+#ifdef ZSTDSUPPORT
+        if( m_type == ZSTD_COMPRESSION && m_zstdStream) ZSTD_freeCStream( m_zstdStream);
+        m_zstdStream = 0;
+#endif
+        m_isOpen = false;
+    }
+
+    /**
+     * @brief Compresses a range of memory
+     *
+     * @param data The data
+     * @param size The size of the data
+     * @param output Replaced with the compressed bytes that are ready to be written
+     * @param isLast If true, the stream is finished after the data
+     * @return False if compression failed
+     */
+    bool compress( const char* data, size_t size, std::vector<char>& output, bool isLast = false)
+    {
+        output.clear();
+        size_t outputSize = 0;
+        bool isDone = false;
+
+        while( !isDone)
+        {
+            if( output.size() < outputSize + ( 1 << 16)) output.resize( outputSize + ( 1 << 18));
+
+#ifdef ZLIBSUPPORT
+            if( m_type == GZIP_COMPRESSION)
+            {
+                m_zlibStream.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data));
+                m_zlibStream.avail_in = size;
+                m_zlibStream.next_out = reinterpret_cast<Bytef*>( &output[outputSize]);
+                m_zlibStream.avail_out = output.size() - outputSize;
+                int result = deflate( &m_zlibStream, isLast ? Z_FINISH : Z_NO_FLUSH);
+                if( result == Z_STREAM_ERROR) return false;
+                data += size - m_zlibStream.avail_in;
+                size = m_zlibStream.avail_in;
+                outputSize = output.size() - m_zlibStream.avail_out;
+                isDone = isLast ? ( result == Z_STREAM_END) : ( size == 0 && m_zlibStream.avail_out != 0);
+            }
+#endif
+#ifdef ZSTDSUPPORT
+            if( m_type == ZSTD_COMPRESSION)
+            {
+                ZSTD_inBuffer in = { data, size, 0 };
+                ZSTD_outBuffer out = { &output[0], output.size(), outputSize };
+                size_t result = ZSTD_compressStream( m_zstdStream, &out, &in);
+                if( ZSTD_isError( result)) return false;
+                data += in.pos;
+                size -= in.pos;
+                if( isLast && size == 0)
+                {
+                    result = ZSTD_endStream( m_zstdStream, &out);
+                    if( ZSTD_isError( result)) return false;
+                    isDone = ( result == 0);
+                }
+                else
+                {
+                    isDone = !isLast && size == 0;
+                }
+                outputSize = out.pos;
+            }
+#endif
+            if( m_type == NO_COMPRESSION) return false;
+        }
+        output.resize( outputSize);
+        return true;
+    }
+
+private:
+    CompressionType m_type;
+    bool m_isOpen;
+
+#ifdef ZLIBSUPPORT
+    z_stream m_zlibStream;
+#endif
+#ifdef ZSTDSUPPORT
+    ZSTD_CStream* m_zstdStream;
+#endif
+
+    StreamCompressor( const StreamCompressor&);
+    StreamCompressor& operator = ( const StreamCompressor&);
+};
+
+#endif //COMPRESSION_H
@@ -24,7 +24,8 @@ double haversineDistanceInMeters(double lat1, double lon1, double lat2, double l
   double theta, dist;
   theta = lon1 - lon2;
   dist = sin(deg2rad(lat1)) * sin(deg2rad(lat2)) + cos(deg2rad(lat1)) * cos(deg2rad(lat2)) * cos(deg2rad(theta));
-  dist = acos(dist);
+  // Rounding may take the cosine of nearby points slightly above 1
+  dist = acos(dist > 1 ? 1 : dist);
   dist = rad2deg(dist);
   dist = dist * 60 * 1.1515;
   dist = dist * 1609.344;
@@ -1,8 +1,16 @@
 #ifndef GRAPHGENERATORS_H
 #define GRAPHGENERATORS_H
 
-#include <Utilities/mersenneTwister.h>
-
+#include <Utilities/binaryMath.h>
+#include <Utilities/parallel.h>
+#include <Utilities/radixSort.h>
+#include <Utilities/outputBuffer.h>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <cassert>
 
 
 template<typename GraphType>
@@ -12,7 +20,11 @@ public:
     GraphGenerator()
     {
     }
-    
+
+    virtual ~GraphGenerator()
+    {
+    }
+
     virtual void generate( GraphType& G)
     {
     }
@@ -20,118 +32,687 @@ protected:
 };
 
 
+/**
+ * @class RandomStream
+ *
+ * @brief A small and fast random number generator (splitmix64). Streams with the same seed and different stream numbers are independent
+ */
+class RandomStream
+{
+public:
+    RandomStream( uint64_t seed, uint64_t stream = 0):m_state( mixBits64( seed ^ mixBits64( stream + 1)))
+    {
+    }
+
+    uint64_t next()
+    {
+        m_state += 0x9E3779B97F4A7C15ULL;
+        return mixBits64( m_state);
+    }
+
+    /**
+     * @brief Returns a number in [0,1)
+     */
+    double nextDouble()
+    {
+        return ( next() >> 11) * ( 1.0 / 9007199254740992.0);
+    }
+
+    /**
+     * @brief Returns a number in [0,bound)
+     */
+    unsigned int nextBelow( unsigned int bound)
+    {
+        return ( ( next() >> 32) * bound) >> 32;
+    }
+
+private:
+    uint64_t m_state;
+};
+
+
+/**
+ * @class EdgeListGenerator
+ *
+ * @brief A generator that emits the edges of a graph as an array, in parallel, and then builds the graph in one batch or writes it to disk
+ *
+ * The output is split in blocks of fixed size, and every block has its own RandomStream, so the
+ * same seed gives the same graph for any number of threads. The edges of all blocks are sorted,
+ * and loops and duplicates are removed. Generators with node coordinates weigh every edge by its
+ * length, and the others with a random weight in [1, maxWeight]. The edges need the field
+ * weight, and the nodes the fields x and y for setCoordinates().
+ *
+ * Derived generators implement emit(), which sets the number of nodes and the coordinates, and
+ * emits the edges with emitInBlocks().
+ *
+ * @author Panos Michail
+ *
+ */
 template<typename GraphType>
-class RandomGenerator : public GraphGenerator<GraphType>
+class EdgeListGenerator : public GraphGenerator<GraphType>
 {
 public:
     typedef typename GraphType::SizeType        SizeType;
     typedef typename GraphType::NodeIterator    NodeIterator;
     typedef typename GraphType::NodeDescriptor  NodeDescriptor;
-    typedef typename GraphType::EdgeIterator    EdgeIterator;
-    typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
+    typedef typename GraphType::EdgeData        EdgeData;
+    typedef std::pair<SizeType,SizeType>        Edge;
 
-    RandomGenerator( const SizeType& numNodes, const SizeType& numEdges):m_numNodes(numNodes),m_numEdges(numEdges)
+    static const SizeType blockSize = 1 << 16;
+
+    EdgeListGenerator( uint64_t seed, unsigned int maxWeight):m_seed(seed),m_maxWeight(maxWeight),m_numNodes(0),m_isEmitted(false)
     {
     }
 
+    /**
+     * @brief Replaces the contents of a graph with the generated nodes and edges
+     */
     void generate( GraphType& G)
     {
-        NodeIterator u,v;
-        NodeDescriptor uD;
-        EdgeIterator e;
-        EdgeDescriptor eD;
-    
-        std::stringstream nodestream;
-        nodestream << "Generating " << m_numNodes << " random nodes";
-        ProgressBar node_progress( m_numNodes,nodestream.str());
+        emitOnce();
+        std::vector<EdgeData> edgeData( m_edges.size());
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)m_edges.size(); ++i)
+        {
+            edgeData[i].weight = m_weights[i];
+        }
+        G.buildFromEdgeList( m_numNodes, m_edges, edgeData, m_ids);
+    }
+
+    /**
+     * @brief Copies the coordinates of the generated nodes into the nodes of a generated graph. The nodes need the fields x and y
+     */
+    void setCoordinates( GraphType& G)
+    {
+        if( !hasCoordinates()) return;
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)m_ids.size(); ++i)
+        {
+            NodeIterator u = G.getNodeIterator( m_ids[i]);
+            u->x = m_x[i];
+            u->y = m_y[i];
+        }
+    }
+
+    /**
+     * @brief Writes the generated graph to a DIMACS9 graph file, and its coordinates to a DIMACS9 coordinates file
+     *
+     * @param filename The name of the graph file. It is compressed if its extension is .gz or .zst
+     * @param coordinatesFilename The name of the coordinates file. Nothing is written if it is empty or there are no coordinates
+     */
+    void write( const std::string& filename, const std::string& coordinatesFilename = "")
+    {
+        emitOnce();
+        OutputBuffer out;
+        std::cout << "Writing DIMACS9 to " << filename << std::endl;
+        out.open( filename);
+        out << "p sp " << m_numNodes << ' ' << (unsigned long)m_edges.size() << '\n';
+        for( SizeType i = 0; i < m_edges.size(); ++i)
+        {
+            out << "a " << m_edges[i].first + 1 << ' ' << m_edges[i].second + 1 << ' ' << m_weights[i] << '\n';
+        }
+        out.close();
+
+        if( coordinatesFilename.empty() || !hasCoordinates()) return;
+        std::cout << "Writing coordinates to " << coordinatesFilename << std::endl;
+        out.open( coordinatesFilename);
+        out << "p aux sp co " << m_numNodes << '\n';
         for( SizeType i = 0; i < m_numNodes; ++i)
         {
-            uD = G.insertNode();
-            u = G.getNodeIterator(uD);
-            ++node_progress;
+            out << "v " << i + 1 << ' ' << m_x[i] << ' ' << m_y[i] << '\n';
+        }
+        out.close();
+    }
+
+    SizeType getNumNodes()
+    {
+        emitOnce();
+        return m_numNodes;
+    }
+
+    /**
+     * @brief Returns the generated edges, sorted by source and target
+     */
+    const std::vector<Edge>& getEdges()
+    {
+        emitOnce();
+        return m_edges;
+    }
+
+    const std::vector<unsigned int>& getWeights()
+    {
+        emitOnce();
+        return m_weights;
+    }
+
+    /**
+     * @brief Returns the descriptors of the nodes of the last generated graph, indexed by node id
+     */
+    const std::vector<NodeDescriptor>& getIds() const
+    {
+        return m_ids;
+    }
+
+    bool hasCoordinates() const
+    {
+        return !m_x.empty();
+    }
+
+protected:
+    uint64_t                    m_seed;
+    unsigned int                m_maxWeight;
+    SizeType                    m_numNodes;
+    std::vector<int>            m_x;
+    std::vector<int>            m_y;
+
+    /**
+     * @brief Sets the number of nodes and the coordinates, and emits the edges
+     */
+    virtual void emit() = 0;
+
+    /**
+     * @brief Emits the edges of a block. An edge (u,v) is emitted as the key (u << 32) | v
+     *
+     * @param block The number of the block
+     * @param random The stream of the block
+     * @param keys The keys of the block
+     */
+    virtual void emitBlock( SizeType block, RandomStream& random, std::vector<uint64_t>& keys) = 0;
+
+    /**
+     * @brief Calls emitBlock for every block, in parallel, and collects the keys of the blocks in block order
+     */
+    void emitInBlocks( SizeType numBlocks)
+    {
+        std::vector< std::vector<uint64_t> > blockKeys( numBlocks);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( long b = 0; b < (long)numBlocks; ++b)
+        {
+            RandomStream random( m_seed, numBlocks + b);
+            emitBlock( b, random, blockKeys[b]);
         }
-    
-        std::stringstream edgestream;
-        edgestream << "Generating " << m_numEdges << " random edges";
-        ProgressBar edge_progress( m_numEdges,edgestream.str());
-        for( SizeType i = 0; i < m_numEdges; ++i)
+
+        std::vector<size_t> offsets( numBlocks + 1, m_keys.size());
+        for( SizeType b = 0; b < numBlocks; ++b)
         {
-            u = G.chooseNode();
-            v = G.chooseNode();
-            while( G.hasEdge( u->getDescriptor(),v->getDescriptor()) || u == v)
-            {
-                u = G.chooseNode();
-                v = G.chooseNode();
-            }
-            eD = G.insertEdge( u->getDescriptor(),v->getDescriptor());
-            e = G.getEdgeIterator(eD);
-            ++edge_progress;
+            offsets[b+1] = offsets[b] + blockKeys[b].size();
+        }
+        m_keys.resize( offsets[numBlocks]);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( long b = 0; b < (long)numBlocks; ++b)
+        {
+            std::copy( blockKeys[b].begin(), blockKeys[b].end(), m_keys.begin() + offsets[b]);
+            std::vector<uint64_t>().swap( blockKeys[b]);
         }
     }
-    
+
+    static uint64_t key( uint64_t source, uint64_t target)
+    {
+        return ( source << 32) | target;
+    }
+
 private:
-    const typename GraphType::SizeType& m_numNodes;
-    const typename GraphType::SizeType& m_numEdges;
+    bool                        m_isEmitted;
+    std::vector<uint64_t>       m_keys;
+    std::vector<Edge>           m_edges;
+    std::vector<unsigned int>   m_weights;
+    std::vector<NodeDescriptor> m_ids;
+
+    void emitOnce()
+    {
+        if( m_isEmitted) return;
+        m_isEmitted = true;
+        m_keys.clear();
+        emit();
+
+        radixSort( m_keys);
+        m_keys.erase( std::unique( m_keys.begin(), m_keys.end()), m_keys.end());
+
+        m_edges.clear();
+        m_edges.reserve( m_keys.size());
+        for( SizeType i = 0; i < m_keys.size(); ++i)
+        {
+            SizeType source = m_keys[i] >> 32, target = m_keys[i] & 0xFFFFFFFFULL;
+            if( source != target) m_edges.push_back( Edge( source, target));
+        }
+        std::vector<uint64_t>().swap( m_keys);
+
+        m_weights.resize( m_edges.size());
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)m_edges.size(); ++i)
+        {
+            m_weights[i] = weigh( m_edges[i].first, m_edges[i].second);
+        }
+    }
+
+    /**
+     * @brief The length of an edge, rounded and at least 1, or a random weight that depends only on the seed and the endpoints
+     */
+    unsigned int weigh( SizeType source, SizeType target) const
+    {
+        if( hasCoordinates())
+        {
+            double dx = double( m_x[source]) - m_x[target];
+            double dy = double( m_y[source]) - m_y[target];
+            return std::max( 1.0, std::floor( std::sqrt( dx * dx + dy * dy) + 0.5));
+        }
+        return 1 + mixBits64( m_seed ^ mixBits64( key( source, target))) % m_maxWeight;
+    }
 };
 
 
 template<typename GraphType>
-class RandomWeightedGenerator : public GraphGenerator<GraphType>
+const typename EdgeListGenerator<GraphType>::SizeType EdgeListGenerator<GraphType>::blockSize;
+
+
+/**
+ * @class RandomGenerator
+ *
+ * @brief Generates a graph with random edges between distinct nodes and without duplicates, in one batch
+ *
+ * Random pairs of nodes are drawn in parallel blocks and sorted, and the missing edges after
+ * removing loops and duplicates are drawn again.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename GraphType>
+class RandomGenerator : public GraphGenerator<GraphType>
 {
 public:
     typedef typename GraphType::SizeType        SizeType;
-    typedef typename GraphType::NodeIterator    NodeIterator;
     typedef typename GraphType::NodeDescriptor  NodeDescriptor;
-    typedef typename GraphType::EdgeIterator    EdgeIterator;
-    typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
+    typedef std::pair<SizeType,SizeType>        Edge;
 
-    RandomWeightedGenerator( const SizeType& numNodes, const SizeType& numEdges, unsigned int maxWeight):m_numNodes(numNodes),m_numEdges(numEdges),m_maxWeight(maxWeight)
+    RandomGenerator( const SizeType& numNodes, const SizeType& numEdges, uint64_t seed = 1):m_numNodes(numNodes),m_numEdges(numEdges),m_seed(seed)
     {
+        assert( uint64_t( m_numEdges) <= uint64_t( m_numNodes) * ( m_numNodes - 1));
     }
 
     void generate( GraphType& G)
     {
-        NodeIterator u,v;
-        NodeDescriptor uD;
-        EdgeIterator e;
-        EdgeDescriptor eD;
-    
-        std::stringstream nodestream;
-        nodestream << "Generating " << m_numNodes << " random nodes";
-        ProgressBar node_progress( m_numNodes,nodestream.str());
-        for( SizeType i = 0; i < m_numNodes; ++i)
+        std::vector<Edge> edges;
+        generateEdges( edges);
+        std::vector<typename GraphType::EdgeData> edgeData;
+        std::vector<NodeDescriptor> ids;
+        G.buildFromEdgeList( m_numNodes, edges, edgeData, ids);
+    }
+
+    /**
+     * @brief Fills a vector with the random edges, sorted by source and target
+     */
+    void generateEdges( std::vector<Edge>& edges)
+    {
+        const uint64_t blockSize = 1 << 16;
+        std::vector<uint64_t> keys;
+        for( unsigned int round = 0; keys.size() < m_numEdges; ++round)
+        {
+            uint64_t numMissing = m_numEdges - keys.size();
+            uint64_t numBlocks = ( numMissing + blockSize - 1) / blockSize;
+            size_t numKeys = keys.size();
+            keys.resize( numKeys + numMissing);
+
+            #pragma omp parallel for schedule(dynamic, 1)
+            for( long b = 0; b < (long)numBlocks; ++b)
+            {
+                RandomStream random( m_seed, ( uint64_t( round) << 32) + b);
+                uint64_t last = std::min( ( b + 1) * blockSize, numMissing);
+                for( uint64_t i = b * blockSize; i < last; ++i)
+                {
+                    uint64_t source = random.nextBelow( m_numNodes);
+                    keys[ numKeys + i] = ( source << 32) | random.nextBelow( m_numNodes);
+                }
+            }
+
+            radixSort( keys);
+            keys.erase( std::unique( keys.begin(), keys.end()), keys.end());
+            size_t numDistinct = 0;
+            for( size_t i = 0; i < keys.size(); ++i)
+            {
+                if( ( keys[i] >> 32) != ( keys[i] & 0xFFFFFFFFULL)) keys[numDistinct++] = keys[i];
+            }
+            keys.resize( numDistinct);
+        }
+
+        // Every round draws only the missing edges, so the keys are exactly the sorted edges
+        edges.resize( keys.size());
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)keys.size(); ++i)
+        {
+            edges[i] = Edge( keys[i] >> 32, keys[i] & 0xFFFFFFFFULL);
+        }
+    }
+
+private:
+    SizeType m_numNodes;
+    SizeType m_numEdges;
+    uint64_t m_seed;
+};
+
+
+/**
+ * @class RandomWeightedGenerator
+ *
+ * @brief Generates a graph like RandomGenerator, with random weights in [1, maxWeight]
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename GraphType>
+class RandomWeightedGenerator : public EdgeListGenerator<GraphType>
+{
+public:
+    typedef EdgeListGenerator<GraphType>        Base;
+    typedef typename GraphType::SizeType        SizeType;
+
+    RandomWeightedGenerator( const SizeType& numNodes, const SizeType& numEdges, unsigned int maxWeight, uint64_t seed = 1):Base(seed,maxWeight),m_random(numNodes,numEdges,seed)
+    {
+        Base::m_numNodes = numNodes;
+    }
+
+protected:
+    void emit()
+    {
+        std::vector<typename Base::Edge> edges;
+        m_random.generateEdges( edges);
+        m_edges.swap( edges);
+        Base::emitInBlocks( ( m_edges.size() + Base::blockSize - 1) / Base::blockSize);
+    }
+
+    void emitBlock( SizeType block, RandomStream& random, std::vector<uint64_t>& keys)
+    {
+        SizeType first = block * Base::blockSize;
+        SizeType last = std::min<SizeType>( first + Base::blockSize, m_edges.size());
+        for( SizeType i = first; i < last; ++i)
+        {
+            keys.push_back( Base::key( m_edges[i].first, m_edges[i].second));
+        }
+    }
+
+private:
+    RandomGenerator<GraphType>          m_random;
+    std::vector<typename Base::Edge>    m_edges;
+};
+
+
+/**
+ * @class RMatGenerator
+ *
+ * @brief Generates a graph with the skewed degrees of social and web graphs, with the recursive matrix model (R-MAT, a Kronecker graph)
+ *
+ * Every edge picks one quadrant of the adjacency matrix with probabilities a, b, c and
+ * 1 - a - b - c, and then one quadrant of that, scale times. The defaults are those of the
+ * Graph500 benchmark. The node ids are then scrambled, so that the nodes of high degree are not
+ * the ones with small ids.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename GraphType>
+class RMatGenerator : public EdgeListGenerator<GraphType>
+{
+public:
+    typedef EdgeListGenerator<GraphType>        Base;
+    typedef typename GraphType::SizeType        SizeType;
+
+    /**
+     * @brief Constructor
+     *
+     * @param scale The graph has 2^scale nodes
+     * @param edgeFactor The number of edges drawn per node, before removing loops and duplicates
+     * @param seed The seed of the random streams
+     * @param maxWeight The largest edge weight
+     */
+    RMatGenerator( unsigned int scale, unsigned int edgeFactor, uint64_t seed = 1, unsigned int maxWeight = 1000, double a = 0.57, double b = 0.19, double c = 0.19):Base(seed,maxWeight),m_scale(scale),m_edgeFactor(edgeFactor),m_a(a),m_b(b),m_c(c)
+    {
+        assert( scale < 32);
+    }
+
+protected:
+    void emit()
+    {
+        Base::m_numNodes = SizeType(1) << m_scale;
+        m_numDrawn = uint64_t( m_edgeFactor) << m_scale;
+        Base::emitInBlocks( ( m_numDrawn + Base::blockSize - 1) / Base::blockSize);
+    }
+
+    void emitBlock( SizeType block, RandomStream& random, std::vector<uint64_t>& keys)
+    {
+        // The quadrants are chosen by comparing 32 bit random numbers to thresholds, two levels per random word
+        const double range = 4294967296.0;
+        uint64_t ab = std::min( range - 1, ( m_a + m_b) * range);
+        uint64_t a = std::min( range - 1, m_a * range);
+        uint64_t abc = std::min( range - 1, ( m_a + m_b + m_c) * range);
+
+        uint64_t first = uint64_t( block) * Base::blockSize;
+        uint64_t last = std::min<uint64_t>( first + Base::blockSize, m_numDrawn);
+        keys.reserve( last - first);
+        for( uint64_t i = first; i < last; ++i)
+        {
+            uint64_t source = 0, target = 0, bits = 0;
+            for( unsigned int level = 0; level < m_scale; ++level)
+            {
+                if( !( level & 1)) bits = random.next();
+                uint64_t r = bits & 0xFFFFFFFFULL;
+                bits >>= 32;
+                source |= uint64_t( r >= ab) << level;
+                target |= uint64_t( ( r >= a && r < ab) || r >= abc) << level;
+            }
+            keys.push_back( Base::key( scramble( source), scramble( target)));
+        }
+    }
+
+private:
+    unsigned int    m_scale;
+    unsigned int    m_edgeFactor;
+    double          m_a;
+    double          m_b;
+    double          m_c;
+    uint64_t        m_numDrawn;
+
+    /**
+     * @brief A permutation of the node ids, by multiplications with odd numbers and xor shifts modulo 2^scale
+     */
+    uint64_t scramble( uint64_t id) const
+    {
+        uint64_t mask = ( uint64_t(1) << m_scale) - 1;
+        unsigned int shift = ( m_scale + 1) / 2;
+        id = ( id * 0x9E3779B97F4A7C15ULL + Base::m_seed) & mask;
+        id ^= id >> shift;
+        id = ( id * 0xBF58476D1CE4E5B9ULL) & mask;
+        id ^= id >> shift;
+        return id;
+    }
+};
+
+
+/**
+ * @class GridGenerator
+ *
+ * @brief Generates a road-like network, a grid with perturbed node positions and some roads removed
+ *
+ * The node in row r and column c has id r * width + c. It lies in the middle of a square cell
+ * of width spacing, moved by up to perturbation * spacing / 2 in each direction. Every road between
+ * neighbours in a row or a column is kept with probability keepProbability, as a pair of edges.
+ * The weights are the lengths of the edges.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename GraphType>
+class GridGenerator : public EdgeListGenerator<GraphType>
+{
+public:
+    typedef EdgeListGenerator<GraphType>        Base;
+    typedef typename GraphType::SizeType        SizeType;
+
+    GridGenerator( unsigned int width, unsigned int height, uint64_t seed = 1, double perturbation = 0.5, double keepProbability = 0.9, unsigned int spacing = 1000):
+        Base(seed,1),m_width(width),m_height(height),m_perturbation(perturbation),m_keepProbability(keepProbability),m_spacing(spacing)
+    {
+        assert( uint64_t( width) * height < ( uint64_t(1) << 32));
+    }
+
+protected:
+    void emit()
+    {
+        Base::m_numNodes = m_width * m_height;
+        m_rowsPerBlock = std::max<SizeType>( 1, Base::blockSize / std::max<SizeType>( 1, m_width));
+        SizeType numBlocks = ( m_height + m_rowsPerBlock - 1) / m_rowsPerBlock;
+        Base::m_x.resize( Base::m_numNodes);
+        Base::m_y.resize( Base::m_numNodes);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( long b = 0; b < (long)numBlocks; ++b)
         {
-            uD = G.insertNode();
-            u = G.getNodeIterator(uD);
-            ++node_progress;
+            RandomStream random( Base::m_seed, b);
+            SizeType lastRow = std::min<SizeType>( ( b + 1) * m_rowsPerBlock, m_height);
+            for( SizeType r = b * m_rowsPerBlock; r < lastRow; ++r)
+            {
+                for( SizeType c = 0; c < m_width; ++c)
+                {
+                    SizeType u = r * m_width + c;
+                    Base::m_x[u] = c * m_spacing + m_spacing / 2 + int( ( random.nextDouble() - 0.5) * m_perturbation * m_spacing);
+                    Base::m_y[u] = r * m_spacing + m_spacing / 2 + int( ( random.nextDouble() - 0.5) * m_perturbation * m_spacing);
+                }
+            }
         }
-    
-        std::stringstream edgestream;
-        edgestream << "Generating " << m_numEdges << " random edges";
-        ProgressBar edge_progress( m_numEdges,edgestream.str());
-        for( SizeType i = 0; i < m_numEdges; ++i)
+
+        Base::emitInBlocks( numBlocks);
+    }
+
+    void emitBlock( SizeType block, RandomStream& random, std::vector<uint64_t>& keys)
+    {
+        SizeType lastRow = std::min<SizeType>( ( block + 1) * m_rowsPerBlock, m_height);
+        for( SizeType r = block * m_rowsPerBlock; r < lastRow; ++r)
         {
-            u = G.chooseNode();
-            v = G.chooseNode();
-            while( G.hasEdge( u->getDescriptor(),v->getDescriptor()) || u == v)
+            for( SizeType c = 0; c < m_width; ++c)
             {
-                u = G.chooseNode();
-                v = G.chooseNode();
+                SizeType u = r * m_width + c;
+                if( ( c + 1 < m_width) && ( random.nextDouble() < m_keepProbability))
+                {
+                    keys.push_back( Base::key( u, u + 1));
+                    keys.push_back( Base::key( u + 1, u));
+                }
+                if( ( r + 1 < m_height) && ( random.nextDouble() < m_keepProbability))
+                {
+                    keys.push_back( Base::key( u, u + m_width));
+                    keys.push_back( Base::key( u + m_width, u));
+                }
             }
-            eD = G.insertEdge( u->getDescriptor(),v->getDescriptor());
-            e = G.getEdgeIterator(eD);
+        }
+    }
 
-            double random = m_random.getRandomNormalizedDouble();
-            e->weight = m_maxWeight * random + 1;
-            ++edge_progress;
+private:
+    unsigned int    m_width;
+    unsigned int    m_height;
+    double          m_perturbation;
+    double          m_keepProbability;
+    unsigned int    m_spacing;
+    SizeType        m_rowsPerBlock;
+};
+
+
+/**
+ * @class RandomGeometricGenerator
+ *
+ * @brief Generates a random geometric graph, with nodes at random points of a square and edges between the nodes that are closer than a radius
+ *
+ * The points have integer coordinates in [0, side). The nodes are bucketed in square cells at
+ * least as wide as the radius, so the neighbours of a node are found in its own and the eight
+ * surrounding cells. With n nodes, a radius of side * sqrt( d / ( pi * n)) gives an average
+ * degree of about d. Every edge is emitted in both directions, and weighed by its length.
+ *
+ * @author Panos Michail
+ *
+ */
+template<typename GraphType>
+class RandomGeometricGenerator : public EdgeListGenerator<GraphType>
+{
+public:
+    typedef EdgeListGenerator<GraphType>        Base;
+    typedef typename GraphType::SizeType        SizeType;
+
+    RandomGeometricGenerator( SizeType numNodes, unsigned int radius, uint64_t seed = 1, unsigned int side = 1 << 20):Base(seed,1),m_radius(std::max( 1u, radius)),m_side(side)
+    {
+        Base::m_numNodes = numNodes;
+    }
+
+protected:
+    void emit()
+    {
+        SizeType numNodes = Base::m_numNodes;
+        SizeType numBlocks = ( numNodes + Base::blockSize - 1) / Base::blockSize;
+        Base::m_x.resize( numNodes);
+        Base::m_y.resize( numNodes);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( long b = 0; b < (long)numBlocks; ++b)
+        {
+            RandomStream random( Base::m_seed, b);
+            SizeType last = std::min<SizeType>( ( b + 1) * Base::blockSize, numNodes);
+            for( SizeType u = b * Base::blockSize; u < last; ++u)
+            {
+                Base::m_x[u] = random.nextBelow( m_side);
+                Base::m_y[u] = random.nextBelow( m_side);
+            }
+        }
+
+        // At most about one cell per node, and no cell narrower than the radius
+        m_cellsPerSide = std::max<SizeType>( 1, std::min<SizeType>( m_side / m_radius, std::sqrt( double( numNodes)) + 1));
+        m_cellWidth = ( m_side + m_cellsPerSide - 1) / m_cellsPerSide;
+        SizeType numCells = m_cellsPerSide * m_cellsPerSide;
+
+        // The nodes are sorted by cell with a counting sort
+        m_cellStart.assign( numCells + 1, 0);
+        for( SizeType u = 0; u < numNodes; ++u) ++m_cellStart[ getCell( u) + 1];
+        for( SizeType i = 0; i < numCells; ++i) m_cellStart[i+1] += m_cellStart[i];
+        m_cellNodes.resize( numNodes);
+        std::vector<SizeType> next( m_cellStart.begin(), m_cellStart.end() - 1);
+        for( SizeType u = 0; u < numNodes; ++u) m_cellNodes[ next[ getCell( u)]++] = u;
+
+        Base::emitInBlocks( numBlocks);
+        std::vector<SizeType>().swap( m_cellStart);
+        std::vector<SizeType>().swap( m_cellNodes);
+    }
+
+    void emitBlock( SizeType block, RandomStream& random, std::vector<uint64_t>& keys)
+    {
+        const std::vector<int>& x = Base::m_x;
+        const std::vector<int>& y = Base::m_y;
+        uint64_t squaredRadius = uint64_t( m_radius) * m_radius;
+        SizeType last = std::min<SizeType>( ( block + 1) * Base::blockSize, Base::m_numNodes);
+
+        for( SizeType u = block * Base::blockSize; u < last; ++u)
+        {
+            SizeType column = x[u] / m_cellWidth, row = y[u] / m_cellWidth;
+            for( SizeType r = ( row ? row - 1 : 0); r <= std::min( row + 1, m_cellsPerSide - 1); ++r)
+            {
+                for( SizeType c = ( column ? column - 1 : 0); c <= std::min( column + 1, m_cellsPerSide - 1); ++c)
+                {
+                    SizeType cell = r * m_cellsPerSide + c;
+                    for( SizeType i = m_cellStart[cell]; i < m_cellStart[cell+1]; ++i)
+                    {
+                        SizeType v = m_cellNodes[i];
+                        int64_t dx = int64_t( x[u]) - x[v], dy = int64_t( y[u]) - y[v];
+                        if( ( v != u) && ( uint64_t( dx * dx + dy * dy) <= squaredRadius)) keys.push_back( Base::key( u, v));
+                    }
+                }
+            }
         }
     }
-    
+
 private:
-    const typename GraphType::SizeType& m_numNodes;
-    const typename GraphType::SizeType& m_numEdges;
-    unsigned int m_maxWeight;
-    MersenneTwister                     m_random;
+    unsigned int            m_radius;
+    unsigned int            m_side;
+    SizeType                m_cellsPerSide;
+    SizeType                m_cellWidth;
+    std::vector<SizeType>   m_cellStart;
+    std::vector<SizeType>   m_cellNodes;
+
+    SizeType getCell( SizeType u) const
+    {
+        return ( Base::m_y[u] / m_cellWidth) * m_cellsPerSide + Base::m_x[u] / m_cellWidth;
+    }
 };
 
 #endif //GRAPHGENERATORS_H
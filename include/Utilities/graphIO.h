@@ -2,7 +2,15 @@
 #define GRAPHIO_H
 
 #include <vector>
+#include <algorithm>
 #include <Utilities/progressBar.h>
+#include <Utilities/mappedFile.h>
+#include <Utilities/textBlockReader.h>
+#include <Utilities/numberParsing.h>
+#include <Utilities/parallel.h>
+#include <Utilities/outputBuffer.h>
+#include <Utilities/region.h>
+#include <Utilities/binaryMath.h>
 #include <Structs/Arrays/nodeArray.h>
 #include <assert.h>
 #include <sstream>
@@ -33,6 +41,18 @@ protected:
 
 
 
+/**
+ * @brief Opens a text file, compressed or not, throwing std::ifstream::failure if that is not possible
+ */
+inline void openTextFile( TextBlockReader& file, const std::string& filename)
+{
+    if( !file.open( filename))
+    {
+        throw std::ifstream::failure( "Exception opening/reading file '" + filename + "'");
+    }
+}
+
+
 template<typename GraphType>
 class TGFReader : public GraphReader<GraphType>
 {
@@ -142,35 +162,37 @@ public:
     {
     }
 
+    /**
+     * @brief Reads the graph. The file may be compressed, see compression.h
+     */
     void read( GraphType& G)
     {
-        std::ifstream in;
+        TextBlockReader file;
         std::string token;
         std::cout << "Reading GML from " << GraphReader<GraphType>::m_filename << std::endl;
         GraphReader<GraphType>::m_ids.clear();
-        in.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
         
         try {
-            in.open( GraphReader<GraphType>::m_filename.c_str());
-            
-            if (in.is_open())
+            openTextFile( file, GraphReader<GraphType>::m_filename);
+            TextBlockStreambuf buffer( file);
+            std::istream in( &buffer);
+            // Errors of the underlying file are rethrown
+            in.exceptions ( std::ios_base::badbit);
+
+            while ( in.good() && !in.eof() )
             {
-                in.exceptions ( std::ios_base::goodbit);
-                while ( in.good() && !in.eof() )
+                in >> token;
+                //std::cout << token << '\n';
+                if( !token.compare("node"))
                 {
-                    in >> token;
-                    //std::cout << token << '\n';
-                    if( !token.compare("node"))
-                    {
-                        readNode( G, in);
-                    }
-                    if( !token.compare("edge"))
-                    {
-                        readEdge( G, in);
-                    }
+                    readNode( G, in);
                 }
-                in.close();
-            }            
+                if( !token.compare("edge"))
+                {
+                    readEdge( G, in);
+                }
+            }
+            file.close();
         }
         catch (std::ifstream::failure e) {
             std::cerr << "Exception opening/reading file '" << GraphReader<GraphType>::m_filename << "'\n";
@@ -178,7 +200,7 @@ public:
         }
     }
 
-    void readNode(GraphType& G, std::ifstream& in)
+    void readNode(GraphType& G, std::istream& in)
     {
         std::string token,value;
         NodeIterator u;
@@ -199,7 +221,7 @@ public:
         }
     }
 
-    void readEdge(GraphType& G, std::ifstream& in)
+    void readEdge(GraphType& G, std::istream& in)
     {
         std::string token,value;
         unsigned int source,target;
@@ -236,201 +258,238 @@ public:
 };
 
 
-template<typename GraphType>
-class DIMACS9Reader : public GraphReader<GraphType>
+/**
+ * @brief An arc of a DIMACS9 file
+ */
+struct DIMACS9Arc
 {
-public:
-    typedef typename GraphType::NodeIterator    NodeIterator;
-    typedef typename GraphType::EdgeIterator    EdgeIterator;
-	typedef typename GraphType::InEdgeIterator  InEdgeIterator;
-    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
-    typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
-    typedef typename GraphType::SizeType        SizeType;
-    
-	class EdgeList
-    {
-    public:
-        EdgeList( unsigned int init = 0):source(0)
-        {
-        }
-        
-        EdgeList( const SizeType& s, const SizeType& t, const SizeType& w):source(s),target(t),weight(w)
-        {
-        }   
-        
-        bool operator == (const EdgeList& other)
-        {
-            return (source == other.source) && (target == other.target);
-        }
-        
-        bool operator != (const EdgeList& other)
-        {
-            return (source != other.source) || (target != other.target);
-        }
-           
-        SizeType source;
-		SizeType target;
-        SizeType weight;
-    };
-    
-    DIMACS9Reader( const std::string& filename, const std::string& coordinatesFilename = ""):GraphReader<GraphType>(filename),m_coordinatesFilename(coordinatesFilename)
+    DIMACS9Arc( unsigned int s = 0, unsigned int t = 0, unsigned int w = 0):source(s),target(t),weight(w)
     {
     }
-    
-    void read( GraphType& G)
+
+    bool hasSameEndpoints( const DIMACS9Arc& other) const
     {
-        GraphReader<GraphType>::m_ids.clear();
-        std::string token, dummy;
-        SizeType numNodes, numEdges;
-		SizeType uID, vID, weight;
-        NodeIterator u,end;
-        EdgeIterator e;
-		InEdgeIterator k;
-        std::ifstream in;
-        in.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-        std::cout << "Reading DIMACS9 from " << GraphReader<GraphType>::m_filename << std::endl;
-        try {
-            in.open( GraphReader<GraphType>::m_filename.c_str());
-            assert( in.good());
-            
-			unsigned int readEdges = 0;
+        return ( source == other.source) && ( target == other.target);
+    }
 
-			ProgressStream edge_progress( numEdges);
-			ProgressStream sort_progress( numEdges);           
+    unsigned int source;
+    unsigned int target;
+    unsigned int weight;
+};
 
-			PackedMemoryArray<EdgeList> edgeLists;
+/**
+ * @brief A node coordinate of a DIMACS9 coordinates file
+ */
+struct DIMACS9Coordinate
+{
+    unsigned int id;
+    int x;
+    int y;
+};
 
-            while ( ((readEdges < numEdges) || numEdges == 0) && getline(in,token)) 
+/**
+ * @brief Parses the lines "a u v w" of a chunk of a DIMACS9 graph file
+ */
+struct DIMACS9ArcParser
+{
+    void operator()( const char* p, const char* end, std::vector<DIMACS9Arc>& arcs) const
+    {
+        while( p != end)
+        {
+            if( *p == 'a')
             {
-				switch (token.c_str()[0])
-				{
-					case 'p':
-						initGraph( G, token, numNodes, numEdges);
-						sort_progress.reset(numEdges);
-						sort_progress.label() << "\tSorting " << numEdges << " edges";
-						edge_progress.reset(numEdges);
-						edge_progress.label() << "\tReading " << numEdges << " edges";
-						edgeLists.reserve( numEdges);
-						break;
-					case 'a':
-						++readEdges;
-						std::stringstream graphinfo;
-						graphinfo.str(token);   
-        				graphinfo >> dummy >> uID >> vID >> weight;
-						
-						//assert( G.getRelativePosition( G.getNodeIterator( GraphReader<GraphType>::m_ids[uID])) == uID -1);
-						edgeLists.optimalInsert( EdgeList( uID, vID, weight));
-						++sort_progress;
-						break;
-				}	
+                ++p;
+                DIMACS9Arc arc;
+                arc.source = parseUnsigned( p, end);
+                arc.target = parseUnsigned( p, end);
+                arc.weight = parseUnsigned( p, end);
+                arcs.push_back( arc);
             }
-            in.close();
+            p = skipLine( p, end);
+        }
+    }
+};
 
-			typename PackedMemoryArray<EdgeList>::Iterator it;
-            while( !edgeLists.empty())
+/**
+ * @brief Parses the lines "v id x y" of a chunk of a DIMACS9 coordinates file
+ */
+struct DIMACS9CoordinateParser
+{
+    void operator()( const char* p, const char* end, std::vector<DIMACS9Coordinate>& coordinates) const
+    {
+        while( p != end)
+        {
+            if( *p == 'v')
             {
-                it = edgeLists.chooseCell();
-
-				G.insertEdge( id2Desc(it->source), id2Desc(it->target));
-
-                e = G.getEdgeIterator( id2Desc(it->source), id2Desc(it->target));
-				k = G.getInEdgeIterator( e);	
-				e->weight = it->weight;
-				k->weight = it->weight;
-
-                ++edge_progress;
-                edgeLists.erase(it);
+                ++p;
+                DIMACS9Coordinate coordinate;
+                coordinate.id = parseUnsigned( p, end);
+                coordinate.x = parseInteger( p, end);
+                coordinate.y = parseInteger( p, end);
+                coordinates.push_back( coordinate);
             }
-
-        }
-        catch (std::ifstream::failure e) {
-            std::cerr << "Exception opening/reading file '" << GraphReader<GraphType>::m_filename << "'\n";
-            throw e;
+            p = skipLine( p, end);
         }
+    }
+};
 
-		readCoordinates(G);
-    } 
+/**
+ * @brief Parses a range of lines in parallel
+ *
+ * The range is split in chunks that start at the beginning of a line. Every chunk is parsed by
+ * a ParserType functor, which appends the records of the chunk to a vector. The records of all
+ * chunks are appended to records in the order of the file.
+ */
+template<typename RecordType, typename ParserType>
+void parseInChunks( const char* first, const char* last, const ParserType& parser, std::vector<RecordType>& records)
+{
+    unsigned int numChunks = 4 * getNumThreads();
+    std::vector<const char*> bounds;
+    MappedFile::split( first, last, numChunks, bounds);
 
-	void readCoordinates( GraphType& G)
-	{
-		std::ifstream in;
-		SizeType numNodes, source;
-		int x,y;
-		std::string token,dummy1;
-		NodeIterator u;
-		try {
-            in.open( m_coordinatesFilename.c_str());
-            assert( in.good());
+    std::vector< std::vector<RecordType> > chunkRecords( numChunks);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for( int i = 0; i < (int)numChunks; ++i)
+    {
+        parser( bounds[i], bounds[i+1], chunkRecords[i]);
+    }
+
+    std::vector<size_t> offsets( numChunks + 1, records.size());
+    for( unsigned int i = 0; i < numChunks; ++i)
+    {
+        offsets[i+1] = offsets[i] + chunkRecords[i].size();
+    }
+    records.resize( offsets[numChunks]);
 
-            std::stringstream coordinatestream;
-            numNodes = G.getNumNodes();
-            coordinatestream << "\tReading " << numNodes << " coordinates";
-            ProgressBar coordinate_progress(numNodes,coordinatestream.str());
-			
-			SizeType readCoords = 0;
-			while ( (readCoords < numNodes) && getline(in,token)) 
+    #pragma omp parallel for schedule(dynamic, 1)
+    for( int i = 0; i < (int)numChunks; ++i)
+    {
+        std::copy( chunkRecords[i].begin(), chunkRecords[i].end(), records.begin() + offsets[i]);
+        std::vector<RecordType>().swap( chunkRecords[i]);
+    }
+}
+
+/**
+ * @brief Parses the arcs of a DIMACS9 graph file, throwing std::ifstream::failure if its problem line is malformed
+ *
+ * @param filename The name of the file
+ * @param numNodes Set to the number of nodes of the problem line "p sp n m"
+ * @param arcs Filled with the arcs, in the order of the file
+ */
+inline void readDIMACS9Arcs( const std::string& filename, unsigned int& numNodes, std::vector<DIMACS9Arc>& arcs)
+{
+    TextBlockReader file;
+    openTextFile( file, filename);
+
+    const char* p;
+    const char* end;
+    numNodes = 0;
+    while( file.next( p, end))
+    {
+        while( p != end && *p != 'a')
+        {
+            if( *p == 'p')
             {
-				switch (token.c_str()[0])
-				{
-					case 'v':
-						std::stringstream coordinfo;
-						coordinfo.str(token);   
-       					coordinfo >> dummy1 >> source >> x >> y;
-						//std::cout << token << "\n";
-						//std::cout << "s: " << source << " x: " << x << " y: " << y << std::endl;
-
-						u = G.getNodeIterator( id2Desc(source));
-                		x > 0? u->x = x: u->x = -x;
-                		y > 0? u->y = y: u->y = -y;	
-                		++coordinate_progress;
-						++readCoords;
-						break;
-				}	
+                // The numbers follow the "sp" of the problem line
+                const char* lineEnd = skipLine( p, end);
+                const char* s = std::find( p + 1, lineEnd, 's');
+                if( lineEnd - s < 2)
+                {
+                    throw std::ifstream::failure( "Malformed problem line in file '" + filename + "'");
+                }
+                p = s + 2;
+                numNodes = parseUnsigned( p, lineEnd);
+                arcs.reserve( parseUnsigned( p, lineEnd));
             }
-            in.close();
+            p = skipLine( p, end);
         }
-        catch (std::ifstream::failure e) {
-            std::cerr << "Exception opening/reading file '" << m_coordinatesFilename << "'\n";
-            throw e;
-        }
-	}
+        parseInChunks( p, end, DIMACS9ArcParser(), arcs);
+    }
+    std::cout << "\tRead " << numNodes << " nodes and " << arcs.size() << " arcs\n";
+}
+
+/**
+ * @brief Reads the coordinates of a DIMACS9 coordinates file into the nodes of a graph
+ *
+ * Nodes need the fields x and y. Negative coordinates are stored as their absolute values.
+ *
+ * @param G The graph
+ * @param filename The name of the file. Nothing is read if it is empty
+ * @param ids The descriptors of the nodes, indexed by their DIMACS9 ids
+ */
+template<typename GraphType>
+void readDIMACS9Coordinates( GraphType& G, const std::string& filename, const std::vector< typename GraphType::NodeDescriptor>& ids)
+{
+    if( filename.empty()) return;
+    std::cout << "Reading coordinates from " << filename << std::endl;
+
+    TextBlockReader file;
+    openTextFile( file, filename);
+    std::vector<DIMACS9Coordinate> coordinates;
+    const char* first;
+    const char* last;
+    while( file.next( first, last))
+    {
+        parseInChunks( first, last, DIMACS9CoordinateParser(), coordinates);
+    }
 
-	void initGraph( GraphType& G, const std::string& line, SizeType& numNodes, SizeType& numEdges)
-	{
-		std::string dummy1,dummy2;
-		NodeDescriptor uD;
-		NodeIterator u,end;
+    #pragma omp parallel for schedule(static)
+    for( long i = 0; i < (long)coordinates.size(); ++i)
+    {
+        const DIMACS9Coordinate& coordinate = coordinates[i];
+        if( coordinate.id == 0 || coordinate.id >= ids.size()) continue;
+        typename GraphType::NodeIterator u = G.getNodeIterator( ids[coordinate.id]);
+        u->x = coordinate.x > 0 ? coordinate.x : -coordinate.x;
+        u->y = coordinate.y > 0 ? coordinate.y : -coordinate.y;
+    }
+    std::cout << "\tRead " << coordinates.size() << " coordinates\n";
+}
 
-		std::stringstream graphinfo;
-        graphinfo.str(line);   
-        graphinfo >> dummy1 >> dummy2 >> numNodes >> numEdges;
-		//std::cout << line << "\n";
-		//std::cout << "n: " << numNodes << " m: " << numEdges << std::endl;
 
-        G.reserve( numNodes, numEdges);
+template<typename GraphType>
+class DIMACS9Reader : public GraphReader<GraphType>
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::EdgeIterator    EdgeIterator;
+	typedef typename GraphType::InEdgeIterator  InEdgeIterator;
+    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
+    typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef typename GraphType::EdgeData        EdgeData;
 
-        ProgressStream node_progress( numNodes);
-        node_progress.label() << "\tReading " << numNodes << " nodes";
+    DIMACS9Reader( const std::string& filename, const std::string& coordinatesFilename = ""):GraphReader<GraphType>(filename),m_coordinatesFilename(coordinatesFilename)
+    {
+    }
 
-        for( SizeType i = 0; i < numNodes; ++i)
-        {
-            uD = G.insertNode();
-            ++node_progress;
-        }
-            
-        std::cout << "\tReserving " << G.getNumNodes() << " IDs\n";
-        GraphReader<GraphType>::m_ids.reserve( G.getNumNodes() + 1);
-        //GraphReader<GraphType>::m_ids.push_back(NodeDescriptor());
+    /**
+     * @brief Reads the graph. The file is mapped to memory and parsed in parallel, and the graph is built in one batch
+     */
+    void read( GraphType& G)
+    {
+        std::vector<DIMACS9Arc> arcs;
+        unsigned int numNodes;
 
-		GraphReader<GraphType>::m_ids.push_back( 0);
+        std::cout << "Reading DIMACS9 from " << GraphReader<GraphType>::m_filename << std::endl;
+        readDIMACS9Arcs( GraphReader<GraphType>::m_filename, numNodes, arcs);
 
-        ProgressStream id_progress( numNodes);
-        id_progress.label() << "\tMapping IDs to " << numNodes << " nodes";
-        for( u = G.beginNodes(), end = G.endNodes(); u != end; ++u)
+        std::vector< std::pair<SizeType,SizeType> > edges( arcs.size());
+        std::vector<EdgeData> edgeData( arcs.size());
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)arcs.size(); ++i)
         {
-            GraphReader<GraphType>::m_ids.push_back( G.getNodeDescriptor(u));
-            ++id_progress;
+            edges[i] = std::make_pair( arcs[i].source - 1, arcs[i].target - 1);
+            edgeData[i].weight = arcs[i].weight;
         }
+        std::vector<DIMACS9Arc>().swap( arcs);
+
+        buildGraph( G, numNodes, edges, edgeData);
+		readCoordinates(G);
+    }
+
+	void readCoordinates( GraphType& G)
+	{
+        readDIMACS9Coordinates( G, m_coordinatesFilename, GraphReader<GraphType>::m_ids);
 	}
 
 	NodeDescriptor id2Desc( SizeType id)
@@ -440,6 +499,18 @@ public:
 
 private:
     std::string m_coordinatesFilename;
+
+    void buildGraph( GraphType& G, SizeType numNodes, const std::vector< std::pair<SizeType,SizeType> >& edges, const std::vector<EdgeData>& edgeData)
+    {
+        std::vector<NodeDescriptor> ids;
+        G.buildFromEdgeList( numNodes, edges, edgeData, ids);
+
+        // DIMACS9 ids start from 1
+        GraphReader<GraphType>::m_ids.clear();
+        GraphReader<GraphType>::m_ids.reserve( numNodes + 1);
+        GraphReader<GraphType>::m_ids.push_back( 0);
+        GraphReader<GraphType>::m_ids.insert( GraphReader<GraphType>::m_ids.end(), ids.begin(), ids.end());
+    }
 };
 
 
@@ -454,243 +525,79 @@ public:
     typedef typename GraphType::NodeDescriptor  NodeDescriptor;
     typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
     typedef typename GraphType::SizeType        SizeType;
-    
-	class EdgeList
-    {
-    public:
-        EdgeList( unsigned int init = 0):source(0)
-        {
-        }
-        
-        EdgeList( const SizeType& s, const SizeType& t, const SizeType& w):source(s),target(t),weight(w)
-        {
-        }   
-        
-        bool operator == (const EdgeList& other)
-        {
-            return (source == other.source) && (target == other.target);
-        }
-        
-        bool operator != (const EdgeList& other)
-        {
-            return (source != other.source) || (target != other.target);
-        }
-           
-        SizeType source;
-		SizeType target;
-        SizeType weight;
-    };
-    
+    typedef typename GraphType::EdgeData        EdgeData;
+
     DIMACS9DoubleReader( const std::string& distanceFilename, const std::string& traveltimeFilename, const std::string& coordinatesFilename = ""):m_distanceFilename(distanceFilename),m_traveltimeFilename(traveltimeFilename),m_coordinatesFilename(coordinatesFilename)
     {
     }
-    
+
+    /**
+     * @brief Reads the graph with the distances as the first criterion and the travel times as the second
+     *
+     * When both files list the arcs in the same order, which is the case for the DIMACS9 road
+     * networks, the travel times are stored while the graph is built. Otherwise every travel time
+     * is looked up after the graph is built.
+     */
     void read( GraphType& G)
     {
-        GraphReader<GraphType>::m_ids.clear();
-        std::string token, dummy;
-        SizeType numNodes, numEdges;
-		SizeType uID, vID, weight;
-        NodeIterator u,end;
-        EdgeIterator e;
-		InEdgeIterator k;
-        std::ifstream in;
-        in.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-        std::cout << "Reading DIMACS9 distances from " << m_distanceFilename << std::endl;
-        try {
-            in.open( m_distanceFilename.c_str());
-            assert( in.good());
-            
-			unsigned int readEdges = 0;
-
-			ProgressStream edge_progress( numEdges);
-			ProgressStream sort_progress( numEdges);           
+        std::vector<DIMACS9Arc> distances, traveltimes;
+        unsigned int numNodes, numTraveltimeNodes;
 
-			PackedMemoryArray<EdgeList> edgeLists;
-
-            while ( ((readEdges < numEdges) || numEdges == 0) && getline(in,token)) 
-            {
-				switch (token.c_str()[0])
-				{
-					case 'p':
-						initGraph( G, token, numNodes, numEdges);
-						sort_progress.reset(numEdges);
-						sort_progress.label() << "\tSorting " << numEdges << " edges";
-						edge_progress.reset(numEdges);
-						edge_progress.label() << "\tReading " << numEdges << " edges";
-						edgeLists.reserve( numEdges);
-						break;
-					case 'a':
-						++readEdges;
-						std::stringstream graphinfo;
-						graphinfo.str(token);   
-        				graphinfo >> dummy >> uID >> vID >> weight;
-						edgeLists.optimalInsert( EdgeList( uID, vID, weight));
-						++sort_progress;
-						break;
-				}	
-            }
-            in.close();
+        std::cout << "Reading DIMACS9 distances from " << m_distanceFilename << std::endl;
+        readDIMACS9Arcs( m_distanceFilename, numNodes, distances);
+        std::cout << "Reading DIMACS9 travel times from " << m_traveltimeFilename << std::endl;
+        readDIMACS9Arcs( m_traveltimeFilename, numTraveltimeNodes, traveltimes);
 
-			typename PackedMemoryArray<EdgeList>::Iterator it;
-            while( !edgeLists.empty())
+        bool isAligned = ( distances.size() == traveltimes.size());
+        long mismatches = 0;
+        if( isAligned)
+        {
+            #pragma omp parallel for schedule(static) reduction(+:mismatches)
+            for( long i = 0; i < (long)distances.size(); ++i)
             {
-                it = edgeLists.chooseCell();
-
-				G.insertEdge( id2Desc(it->source), id2Desc(it->target));
-
-                e = G.getEdgeIterator( id2Desc(it->source), id2Desc(it->target));
-				k = G.getInEdgeIterator( e);	
-				e->criteriaList[0] = it->weight;
-				k->criteriaList[0] = it->weight;
-
-                ++edge_progress;
-                edgeLists.erase(it);
+                if( !distances[i].hasSameEndpoints( traveltimes[i])) ++mismatches;
             }
-
+            isAligned = ( mismatches == 0);
         }
-        catch (std::ifstream::failure e) {
-            std::cerr << "Exception opening/reading file '" << m_distanceFilename << "'\n";
-            throw e;
+
+        std::vector< std::pair<SizeType,SizeType> > edges( distances.size());
+        std::vector<EdgeData> edgeData( distances.size());
+        #pragma omp parallel for schedule(static)
+        for( long i = 0; i < (long)distances.size(); ++i)
+        {
+            edges[i] = std::make_pair( distances[i].source - 1, distances[i].target - 1);
+            edgeData[i].criteriaList[0] = distances[i].weight;
+            if( isAligned) edgeData[i].criteriaList[1] = traveltimes[i].weight;
         }
+        std::vector<DIMACS9Arc>().swap( distances);
+
+        std::vector<NodeDescriptor> ids;
+        G.buildFromEdgeList( numNodes, edges, edgeData, ids);
+        GraphReader<GraphType>::m_ids.clear();
+        GraphReader<GraphType>::m_ids.reserve( numNodes + 1);
+        GraphReader<GraphType>::m_ids.push_back( 0);
+        GraphReader<GraphType>::m_ids.insert( GraphReader<GraphType>::m_ids.end(), ids.begin(), ids.end());
 
-        readTraveltimes(G);
+        if( !isAligned) setTraveltimes( G, traveltimes);
 
 		readCoordinates(G);
     } 
 
+    /**
+     * @brief Reads the travel times into the second criterion of the edges of a graph that is already read
+     */
     void readTraveltimes( GraphType& G)
     {
-        std::string token, dummy, dummy1, dummy2;
-        SizeType numNodes, numEdges;
-		SizeType uID, vID, weight;
-        NodeIterator u,end;
-        EdgeIterator e;
-		InEdgeIterator k;
-        std::ifstream in;
-        in.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
+        std::vector<DIMACS9Arc> traveltimes;
+        unsigned int numNodes;
         std::cout << "Reading DIMACS9 travel times from " << m_traveltimeFilename << std::endl;
-        try {
-            in.open( m_traveltimeFilename.c_str());
-            assert( in.good());
-            
-			unsigned int readEdges = 0;
-
-			ProgressStream edge_progress( numEdges);         
-
-
-            while ( ((readEdges < numEdges) || numEdges == 0) && getline(in,token)) 
-            {
-				std::stringstream graphinfo;
-				switch (token.c_str()[0])
-				{
-                    
-					case 'p':                      
-						graphinfo.str(token);   
-        				graphinfo >> dummy1 >> dummy2 >> numNodes >> numEdges;
-
-						edge_progress.reset(numEdges);
-						edge_progress.label() << "\tReading " << numEdges << " edges";
-						break;
-					case 'a':
-						++readEdges;
-						graphinfo.str(token);   
-        				graphinfo >> dummy >> uID >> vID >> weight;
-
-                        e = G.getEdgeIterator( id2Desc(uID), id2Desc(vID));
-                        k = G.getInEdgeIterator( e);
-                        e->criteriaList[1] = weight;
-				        k->criteriaList[1] = weight;
-
-						++edge_progress;
-						break;
-				}	
-            }
-            in.close();
-        }
-        catch (std::ifstream::failure e) {
-            std::cerr << "Exception opening/reading file '" << m_distanceFilename << "'\n";
-            throw e;
-        }
+        readDIMACS9Arcs( m_traveltimeFilename, numNodes, traveltimes);
+        setTraveltimes( G, traveltimes);
     } 
 
 	void readCoordinates( GraphType& G)
 	{
-		std::ifstream in;
-		SizeType numNodes, source;
-		int x,y;
-		std::string token,dummy1;
-		NodeIterator u;
-		try {
-            in.open( m_coordinatesFilename.c_str());
-            assert( in.good());
-
-            std::stringstream coordinatestream;
-            numNodes = G.getNumNodes();
-            coordinatestream << "\tReading " << numNodes << " coordinates";
-            ProgressBar coordinate_progress(numNodes,coordinatestream.str());
-			
-			SizeType readCoords = 0;
-			while ( (readCoords < numNodes) && getline(in,token)) 
-            {
-				switch (token.c_str()[0])
-				{
-					case 'v':
-						std::stringstream coordinfo;
-						coordinfo.str(token);   
-       					coordinfo >> dummy1 >> source >> x >> y;
-						//std::cout << token << "\n";
-						//std::cout << "s: " << source << " x: " << x << " y: " << y << std::endl;
-
-						u = G.getNodeIterator( id2Desc(source));
-                		x > 0? u->x = x: u->x = -x;
-                		y > 0? u->y = y: u->y = -y;	
-                		++coordinate_progress;
-						++readCoords;
-						break;
-				}	
-            }
-            in.close();
-        }
-        catch (std::ifstream::failure e) {
-            std::cerr << "Exception opening/reading file '" << m_coordinatesFilename << "'\n";
-            throw e;
-        }
-	}
-
-	void initGraph( GraphType& G, const std::string& line, SizeType& numNodes, SizeType& numEdges)
-	{
-		std::string dummy1,dummy2;
-		NodeDescriptor uD;
-		NodeIterator u,end;
-
-		std::stringstream graphinfo;
-        graphinfo.str(line);   
-        graphinfo >> dummy1 >> dummy2 >> numNodes >> numEdges;
-
-        G.reserve( numNodes, numEdges);
-
-        ProgressStream node_progress( numNodes);
-        node_progress.label() << "\tReading " << numNodes << " nodes";
-
-        for( SizeType i = 0; i < numNodes; ++i)
-        {
-            uD = G.insertNode();
-            ++node_progress;
-        }
-            
-        std::cout << "\tReserving " << G.getNumNodes() << " IDs\n";
-        GraphReader<GraphType>::m_ids.reserve( G.getNumNodes() + 1);
-
-		GraphReader<GraphType>::m_ids.push_back( 0);
-
-        ProgressStream id_progress( numNodes);
-        id_progress.label() << "\tMapping IDs to " << numNodes << " nodes";
-        for( u = G.beginNodes(), end = G.endNodes(); u != end; ++u)
-        {
-            GraphReader<GraphType>::m_ids.push_back( G.getNodeDescriptor(u));
-            ++id_progress;
-        }
+        readDIMACS9Coordinates( G, m_coordinatesFilename, GraphReader<GraphType>::m_ids);
 	}
 
 	NodeDescriptor id2Desc( SizeType id)
@@ -702,6 +609,20 @@ private:
     std::string m_distanceFilename;
     std::string m_traveltimeFilename;
     std::string m_coordinatesFilename;
+
+    void setTraveltimes( GraphType& G, const std::vector<DIMACS9Arc>& traveltimes)
+    {
+        EdgeIterator e;
+        InEdgeIterator k;
+        for( unsigned int i = 0; i < traveltimes.size(); ++i)
+        {
+            if( !G.hasEdge( id2Desc( traveltimes[i].source), id2Desc( traveltimes[i].target))) continue;
+            e = G.getEdgeIterator( id2Desc( traveltimes[i].source), id2Desc( traveltimes[i].target));
+            k = G.getInEdgeIterator( e);
+            e->criteriaList[1] = traveltimes[i].weight;
+            k->criteriaList[1] = traveltimes[i].weight;
+        }
+    }
 };
 
 
@@ -715,166 +636,374 @@ public:
     typedef typename GraphType::NodeDescriptor  NodeDescriptor;
     typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
     typedef typename GraphType::SizeType        SizeType;
-    
-    class NodeList
+    typedef typename GraphType::EdgeData        EdgeData;
+
+    DIMACS10Reader( const std::string& filename, const std::string& coordinatesFilename):GraphReader<GraphType>(filename),m_coordinatesFilename(coordinatesFilename),
+        m_hasRegion(false),m_margin(0)
     {
-    public:
-        NodeList( unsigned int init = 0):source(0)
-        {
-        }
-        
-        NodeList( const NodeDescriptor& s):source(s)
-        {
-        }   
-        
-        bool operator == (const NodeList& other)
-        {
-            return source == other.source;
-        }
-        
-        bool operator != (const NodeList& other)
-        {
-            return source != other.source;
-        }
-           
-        NodeDescriptor source;
-        std::vector<NodeDescriptor> targets;
-    };
-    
-    DIMACS10Reader( const std::string& filename, const std::string& coordinatesFilename):GraphReader<GraphType>(filename),m_coordinatesFilename(coordinatesFilename)
+    }
+
+    /**
+     * @brief Restricts reading to the subgraph induced by the nodes in a region
+     *
+     * The coordinates file is then streamed first to select the nodes, and the adjacency lists
+     * of the other nodes are skipped, so that memory depends on the size of the region instead
+     * of the size of the graph. The selected nodes get consecutive ids from 1, in the order of
+     * the file; getOriginalId() returns their ids in the file.
+     *
+     * @param region The region, in the units of the coordinates file
+     * @param margin The nodes that are this far from the region are selected too
+     */
+    void setRegion( const Region& region, double margin = 0)
     {
+        m_region = region;
+        m_hasRegion = true;
+        m_margin = margin;
     }
-    
+
+    /**
+     * @brief Returns the id in the file of a node, which differs from its id when a region is read
+     */
+    SizeType getOriginalId( SizeType id) const
+    {
+        return m_hasRegion ? m_originalIds[id] : id;
+    }
+
+    /**
+     * @brief Reads the graph
+     *
+     * The adjacency lists of every block of the file are parsed in parallel in two passes over
+     * the chunks of the block. The first counts the lines of every chunk, which gives the id of
+     * the first node of every chunk, and the second parses the neighbours.
+     */
     void read( GraphType& G)
     {
-        GraphReader<GraphType>::m_ids.clear();
-        std::string token;
-        SizeType numNodes, numEdges, source, target, x, y;
-        NodeIterator u,end;
-        EdgeIterator e;
-        std::ifstream in;
-        in.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
+        if( m_hasRegion)
+        {
+            readRegion( G);
+            return;
+        }
+
+        SizeType numNodes = 0, numEdges = 0;
         std::cout << "Reading DIMACS10 from " << GraphReader<GraphType>::m_filename << std::endl;
-        try {
-            in.open( GraphReader<GraphType>::m_filename.c_str());
-            assert( in.good());
-            
-            while (getline(in,token)) 
+
+        TextBlockReader file;
+        openTextFile( file, GraphReader<GraphType>::m_filename);
+        const char* p;
+        const char* end;
+        bool isHeaderRead = false;
+        SizeType source = 0;
+        std::vector< std::pair<SizeType,SizeType> > edges;
+
+        while( file.next( p, end))
+        {
+            while( !isHeaderRead && p != end)
             {
-                
-                if( token.c_str()[0] == '%') continue;
-                //std::cout << "Token: " << token << std::endl;
-                std::stringstream graphinfo;
-                graphinfo.str(token);   
-                graphinfo >> numNodes >> numEdges;             
-                break;
+                if( *p != '%')
+                {
+                    numNodes = parseUnsigned( p, end);
+                    numEdges = parseUnsigned( p, end);
+                    edges.reserve( numEdges << 1);
+                    isHeaderRead = true;
+                }
+                p = skipLine( p, end);
             }
-    
-            G.reserve( numNodes, numEdges<<1);
+            source = readAdjacencyLists( p, end, source, numNodes, edges);
+        }
+        std::cout << "\tRead " << numNodes << " nodes and " << edges.size() << " edges\n";
 
-            ProgressStream node_progress( numNodes);
-            node_progress.label() << "\tReading " << numNodes << " nodes";
+        std::vector<NodeDescriptor> ids;
+        G.buildFromEdgeList( numNodes, edges, std::vector<EdgeData>(), ids);
 
-            for( SizeType i = 0; i < numNodes; ++i)
+        // DIMACS10 ids start from 1
+        GraphReader<GraphType>::m_ids.clear();
+        GraphReader<GraphType>::m_ids.reserve( numNodes + 1);
+        GraphReader<GraphType>::m_ids.push_back( NodeDescriptor());
+        GraphReader<GraphType>::m_ids.insert( GraphReader<GraphType>::m_ids.end(), ids.begin(), ids.end());
+
+        readCoordinates( G, numNodes);
+    } 
+
+private:
+    /**
+     * @brief A node of the region, with its id in the file counting from 0
+     */
+    struct RegionNode
+    {
+        SizeType id;
+        int x;
+        int y;
+    };
+
+    /**
+     * @brief A set of node ids as a bitmap, with the number of selected ids before every word
+     *
+     * The rank of an id, its position among the selected ids, costs one population count.
+     */
+    struct IdSelection
+    {
+        std::vector<uint64_t> bits;
+        std::vector<SizeType> wordRank;
+
+        void build( const std::vector<RegionNode>& nodes, SizeType numIds)
+        {
+            bits.assign( ( numIds >> 6) + 1, 0);
+            wordRank.assign( bits.size(), 0);
+            for( SizeType i = 0; i < nodes.size(); ++i)
             {
-                G.insertNode();
-                ++node_progress;
+                bits[ nodes[i].id >> 6] |= uint64_t(1) << ( nodes[i].id & 63);
             }
-            
-            std::cout << "\tReserving " << G.getNumNodes() << " IDs\n";
-            GraphReader<GraphType>::m_ids.reserve( G.getNumNodes() + 1);
-            GraphReader<GraphType>::m_ids.push_back(NodeDescriptor());
-
-            ProgressStream id_progress( numNodes);
-            id_progress.label() << "\tMapping IDs to " << numNodes << " nodes";
-			//GraphReader<GraphType>::m_ids.push_back( 0);
-            for( u = G.beginNodes(), end = G.endNodes(); u != end; ++u)
+            for( SizeType w = 1; w < bits.size(); ++w)
             {
-                GraphReader<GraphType>::m_ids.push_back( G.getNodeDescriptor(u));
-                ++id_progress;
+                wordRank[w] = wordRank[w-1] + popCount64( bits[w-1]);
             }
+        }
 
+        bool contains( SizeType id) const
+        {
+            return ( id >> 6) < bits.size() && ( ( bits[ id >> 6] >> ( id & 63)) & 1);
+        }
 
-            PackedMemoryArray<NodeList> nodeLists;
-            std::cout << "\tReserving " << G.getNumNodes() << " node lists\t";
-            nodeLists.reserve(numNodes);
-            NodeList newList;
-            
-            ProgressStream sort_progress(numNodes);
-            sort_progress.label() << "\tSorting " << numEdges << " edges";
+        SizeType rank( SizeType id) const
+        {
+            return wordRank[ id >> 6] + popCount64( bits[ id >> 6] & ( ( uint64_t(1) << ( id & 63)) - 1));
+        }
+    };
 
-            for( source = 1; source <= numNodes; ++source)
+    std::string m_coordinatesFilename;
+    bool m_hasRegion;
+    Region m_region;
+    double m_margin;
+    std::vector<SizeType> m_originalIds;
+
+    /**
+     * @brief Reads the subgraph induced by the nodes in the region
+     */
+    void readRegion( GraphType& G)
+    {
+        std::cout << "Reading DIMACS10 region from " << GraphReader<GraphType>::m_filename << std::endl;
+
+        std::vector<RegionNode> nodes;
+        SizeType numCoordinates = selectRegionNodes( nodes);
+        IdSelection selection;
+        selection.build( nodes, numCoordinates);
+
+        TextBlockReader file;
+        openTextFile( file, GraphReader<GraphType>::m_filename);
+        const char* p;
+        const char* end;
+        bool isHeaderRead = false;
+        SizeType numNodes = 0, source = 0;
+        std::vector< std::pair<SizeType,SizeType> > edges;
+        while( file.next( p, end))
+        {
+            while( !isHeaderRead && p != end)
             {
-                getline(in,token);
-                while( token.c_str()[0] == '%') getline(in,token);
-                std::stringstream edgeinfo;
-                edgeinfo.str(token);   
-                 
-                newList.targets.clear();
-                newList.source = GraphReader<GraphType>::m_ids[source];
-                while( edgeinfo.good())
-                {               
-                    edgeinfo >> target;
-                    newList.targets.push_back(GraphReader<GraphType>::m_ids[target]);     
+                if( *p != '%')
+                {
+                    numNodes = parseUnsigned( p, end);
+                    isHeaderRead = true;
                 }
-                nodeLists.optimalInsert( newList);
-                ++sort_progress;  
-            }      
-            assert( nodeLists.size() == numNodes);
-            
+                p = skipLine( p, end);
+            }
+            source = readAdjacencyLists( p, end, source, numNodes, edges, &selection);
+        }
+        if( numCoordinates != numNodes)
+        {
+            std::cerr << "Warning: " << m_coordinatesFilename << " has " << numCoordinates << " coordinates for " << numNodes << " nodes\n";
+        }
+        std::cout << "\tKept " << nodes.size() << " of " << numNodes << " nodes and " << edges.size() << " edges\n";
 
-            ProgressStream edge_progress(numNodes);
-            edge_progress.label() << "\tReading " << numEdges << " edges";
+        std::vector<NodeDescriptor> ids;
+        G.buildFromEdgeList( nodes.size(), edges, std::vector<EdgeData>(), ids);
+        std::vector< std::pair<SizeType,SizeType> >().swap( edges);
 
-            typename PackedMemoryArray<NodeList>::Iterator it;
-            while( !nodeLists.empty())
+        // DIMACS10 ids start from 1
+        GraphReader<GraphType>::m_ids.assign( 1, NodeDescriptor());
+        GraphReader<GraphType>::m_ids.insert( GraphReader<GraphType>::m_ids.end(), ids.begin(), ids.end());
+        m_originalIds.assign( 1, 0);
+        for( SizeType i = 0; i < nodes.size(); ++i)
+        {
+            NodeIterator u = G.getNodeIterator( ids[i]);
+            u->x = nodes[i].x;
+            u->y = nodes[i].y;
+            m_originalIds.push_back( nodes[i].id + 1);
+        }
+    }
+
+    /**
+     * @brief Streams the coordinates file and keeps the nodes in the region, in parallel over the chunks of every block
+     *
+     * @param nodes Filled with the nodes in the region, in the order of the file
+     * @return The number of nodes in the file
+     */
+    SizeType selectRegionNodes( std::vector<RegionNode>& nodes)
+    {
+        std::cout << "Selecting nodes from " << m_coordinatesFilename << std::endl;
+
+        TextBlockReader file;
+        openTextFile( file, m_coordinatesFilename);
+        const char* first;
+        const char* last;
+        SizeType source = 0;
+        nodes.clear();
+        while( file.next( first, last))
+        {
+            unsigned int numChunks = 4 * getNumThreads();
+            std::vector<const char*> bounds;
+            MappedFile::split( first, last, numChunks, bounds);
+
+            std::vector<SizeType> firstNode( numChunks + 1, source);
+            #pragma omp parallel for schedule(dynamic, 1)
+            for( int i = 0; i < (int)numChunks; ++i)
+            {
+                firstNode[i+1] = countLines( bounds[i], bounds[i+1]);
+            }
+            for( unsigned int i = 0; i < numChunks; ++i)
+            {
+                firstNode[i+1] += firstNode[i];
+            }
+
+            std::vector< std::vector<RegionNode> > chunkNodes( numChunks);
+            #pragma omp parallel for schedule(dynamic, 1)
+            for( int i = 0; i < (int)numChunks; ++i)
             {
-                it = nodeLists.chooseCell();
-                for( typename std::vector<NodeDescriptor>::iterator t = it->targets.begin(); t != it->targets.end(); ++t)
+                const char* p = bounds[i];
+                const char* end = bounds[i+1];
+                for( SizeType id = firstNode[i]; p != end; p = skipLine( p, end))
                 {
-                    G.insertEdge( it->source, *t);
+                    if( *p == '%') continue;
+                    RegionNode node;
+                    node.id = id++;
+                    node.x = parseInteger( p, end);
+                    node.y = parseInteger( p, end);
+                    if( m_region.contains( node.x, node.y, m_margin)) chunkNodes[i].push_back( node);
                 }
-                ++edge_progress;
-                nodeLists.erase(it);
             }
 
+            for( unsigned int i = 0; i < numChunks; ++i)
+            {
+                nodes.insert( nodes.end(), chunkNodes[i].begin(), chunkNodes[i].end());
+            }
+            source = firstNode[numChunks];
+        }
+        return source;
+    }
+
+    /**
+     * @brief Parses the adjacency lists of a block in parallel
+     *
+     * @param first The beginning of the block
+     * @param last The end of the block
+     * @param source The id of the node of the first adjacency list in the block
+     * @param numNodes The number of nodes
+     * @param edges The edges of the block are appended to it
+     * @param selection If not 0, only the edges between selected nodes are kept, with the ranks of the nodes as ids
+     * @return The id of the node after the last adjacency list in the block
+     */
+    static SizeType readAdjacencyLists( const char* first, const char* last, SizeType source, SizeType numNodes, std::vector< std::pair<SizeType,SizeType> >& edges, const IdSelection* selection = 0)
+    {
+        unsigned int numChunks = 4 * getNumThreads();
+        std::vector<const char*> bounds;
+        MappedFile::split( first, last, numChunks, bounds);
 
-            in.close();
+        std::vector<SizeType> firstNode( numChunks + 1, source);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( int i = 0; i < (int)numChunks; ++i)
+        {
+            firstNode[i+1] = countLines( bounds[i], bounds[i+1]);
         }
-        catch (std::ifstream::failure e) {
-            std::cerr << "Exception opening/reading file '" << GraphReader<GraphType>::m_filename << "'\n";
-            throw e;
+        for( unsigned int i = 0; i < numChunks; ++i)
+        {
+            firstNode[i+1] += firstNode[i];
         }
-        
-        std::cout << "Reading coordinates from " << m_coordinatesFilename << std::endl;
-        
-        try {
-            in.open( m_coordinatesFilename.c_str());
-            assert( in.good());
 
-            std::stringstream coordinatestream;
-            numNodes = G.getNumNodes();
-            coordinatestream << "\tReading " << numNodes << " coordinates";
-            ProgressBar coordinate_progress(numNodes,coordinatestream.str());
-            for( source = 1; source <= numNodes; ++source)
-            {
-                in >> x >> y >> token;
-                u = G.getNodeIterator( GraphReader<GraphType>::m_ids[source]);
-                u->x = x;
-                u->y = y;
-                ++coordinate_progress;
-            }
+        std::vector< std::vector< std::pair<SizeType,SizeType> > > chunkEdges( numChunks);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for( int i = 0; i < (int)numChunks; ++i)
+        {
+            parseAdjacencyLists( bounds[i], bounds[i+1], firstNode[i], numNodes, chunkEdges[i], selection);
+        }
 
-            in.close();
+        for( unsigned int i = 0; i < numChunks; ++i)
+        {
+            edges.insert( edges.end(), chunkEdges[i].begin(), chunkEdges[i].end());
+            std::vector< std::pair<SizeType,SizeType> >().swap( chunkEdges[i]);
         }
-        catch (std::ifstream::failure e) {
-            std::cerr << "Exception opening/reading file '" << m_coordinatesFilename << "'\n";
-            throw e;
+        return firstNode[numChunks];
+    }
+
+    /**
+     * @brief Counts the adjacency lists in a chunk, one per line that is not a comment
+     */
+    static SizeType countLines( const char* p, const char* end)
+    {
+        SizeType numLines = 0;
+        while( p != end)
+        {
+            if( *p != '%') ++numLines;
+            p = skipLine( p, end);
         }
+        return numLines;
+    }
 
-    } 
-private:
-    std::string m_coordinatesFilename;
+    static void parseAdjacencyLists( const char* p, const char* end, SizeType source, SizeType numNodes, std::vector< std::pair<SizeType,SizeType> >& edges, const IdSelection* selection)
+    {
+        while( p != end && source < numNodes)
+        {
+            if( *p == '%')
+            {
+                p = skipLine( p, end);
+                continue;
+            }
+            if( selection)
+            {
+                if( selection->contains( source))
+                {
+                    SizeType sourceRank = selection->rank( source);
+                    p = skipBlanks( p, end);
+                    while( p != end && isDigit(*p))
+                    {
+                        SizeType target = parseUnsigned( p, end) - 1;
+                        if( selection->contains( target)) edges.push_back( std::make_pair( sourceRank, selection->rank( target)));
+                        p = skipBlanks( p, end);
+                    }
+                }
+                p = skipLine( p, end);
+                ++source;
+                continue;
+            }
+            p = skipBlanks( p, end);
+            while( p != end && isDigit(*p))
+            {
+                edges.push_back( std::make_pair( source, SizeType( parseUnsigned( p, end) - 1)));
+                p = skipBlanks( p, end);
+            }
+            p = skipLine( p, end);
+            ++source;
+        }
+    }
+
+    void readCoordinates( GraphType& G, SizeType numNodes)
+    {
+        std::cout << "Reading coordinates from " << m_coordinatesFilename << std::endl;
+
+        TextBlockReader file;
+        openTextFile( file, m_coordinatesFilename);
+        const char* p;
+        const char* end;
+        SizeType source = 1;
+        while( file.next( p, end))
+        {
+            for( ; source <= numNodes && p != end; ++source)
+            {
+                NodeIterator u = G.getNodeIterator( GraphReader<GraphType>::m_ids[source]);
+                u->x = parseInteger( p, end);
+                u->y = parseInteger( p, end);
+                p = skipLine( p, end);
+            }
+        }
+    }
 };
 
 
@@ -946,11 +1075,73 @@ public:
 
 //--------------------------------------- WRITERS --------------------------------------//
 
+/**
+ * @brief The position of every node of a graph in the node order
+ *
+ * The positions are computed once and kept in an open addressing hash table on the addresses
+ * of the nodes, so that the position of a node costs about one cache miss instead of a call to
+ * getRelativePosition, which is linear for some implementations. The graph must not be
+ * modified while the map is in use.
+ */
+template<typename GraphType>
+class NodeIndexMap
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::SizeType        SizeType;
+
+    void init( GraphType& G)
+    {
+        size_t capacity = 16;
+        while( capacity < 2 * size_t(G.getNumNodes())) capacity <<= 1;
+        m_mask = capacity - 1;
+        m_slots.assign( capacity, std::make_pair( (const void*)0, SizeType(0)));
+
+        SizeType i = 0;
+        for( NodeIterator u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++i)
+        {
+            const void* address = &(*u);
+            size_t slot = hash( address);
+            while( m_slots[slot].first) slot = ( slot + 1) & m_mask;
+            m_slots[slot] = std::make_pair( address, i);
+        }
+    }
+
+    SizeType operator[] ( const NodeIterator& u) const
+    {
+        const void* address = &(*u);
+        size_t slot = hash( address);
+        while( m_slots[slot].first != address)
+        {
+            assert( m_slots[slot].first);
+            slot = ( slot + 1) & m_mask;
+        }
+        return m_slots[slot].second;
+    }
+
+private:
+    std::vector< std::pair<const void*,SizeType> > m_slots;
+    size_t m_mask;
+
+    size_t hash( const void* address) const
+    {
+        uint64_t key = reinterpret_cast<uintptr_t>( address) >> 3;
+        return size_t( ( key * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+    }
+};
+
+
 template<typename GraphType>
 class GraphWriter
 {
 public:
-    GraphWriter( const std::string& filename):m_filename(filename)
+    /**
+     * @brief Constructor
+     *
+     * @param filename The name of the file
+     * @param backgroundWriter If true, the output is written to the file by a background thread while it is formatted
+     */
+    GraphWriter( const std::string& filename, bool backgroundWriter = false):m_filename(filename),m_backgroundWriter(backgroundWriter)
     {
     }
     
@@ -959,6 +1150,7 @@ public:
     } 
 protected:
     std::string m_filename;
+    bool m_backgroundWriter;
 };
 
 template<typename GraphType>
@@ -970,24 +1162,22 @@ public:
     typedef typename GraphType::EdgeIterator EdgeIterator;
     typedef typename GraphType::SizeType SizeType;
     
-    GraphVizWriter( const std::string& filename):GraphWriter<GraphType>(filename)
+    GraphVizWriter( const std::string& filename, bool backgroundWriter = false):GraphWriter<GraphType>(filename,backgroundWriter)
     {
     }
     
     virtual void write( GraphType& G)
     {
-        std::ofstream out;
-        out.exceptions ( std::ofstream::failbit | std::ofstream::badbit );
+        OutputBuffer out( 1 << 22, GraphWriter<GraphType>::m_backgroundWriter);
         try { 
-            out.open( GraphWriter<GraphType>::m_filename.c_str());
+            out.open( GraphWriter<GraphType>::m_filename);
             out << "digraph BFS {\n\tedge [len=3]\n\tnode  [fontname=\"Arial\"]\n";
 
             NodeIterator u,v,lastnode;
             EdgeIterator e,lastedge;
             
-            //G.addNodeProperty( "dotId", false); 
-
-            NodeArray<SizeType, GraphType> dotId( &G,std::numeric_limits<SizeType>::max());
+            NodeIndexMap<GraphType> dotId;
+            dotId.init(G);
 
             SizeType i = 0;
             
@@ -998,13 +1188,8 @@ public:
             for( u = G.beginNodes(), lastnode = G.endNodes(); u != lastnode; ++u, ++i)	
 	        {
                 out << i;
-                //G.setProperty( u, "dotId", i);
-                dotId[u] = i;
-
-                //assert(G.getProperty( u, "dotId") == dotId[u]);
-
-		        out << "[label=\"" << G.getRelativePosition(u) << " ";
-                u->print(out);    
+		        out << "[label=\"" << i << " ";
+                u->print(out.stream());    
                 out << "\"]\n"; 
                 ++node_progress;
             }
@@ -1013,22 +1198,20 @@ public:
             edgestream << "Writing out " << G.getNumEdges() << " edges";
             ProgressBar edge_progress( G.getNumEdges(),edgestream.str());
 
-            for( u = G.beginNodes(), lastnode = G.endNodes(); u != lastnode; ++u)
+            i = 0;
+            for( u = G.beginNodes(), lastnode = G.endNodes(); u != lastnode; ++u, ++i)
             {
 	            for( e = G.beginEdges(u), lastedge = G.endEdges(u); e != lastedge; ++e)
 	            {
                     v = G.target(e);
-                    //out << G.getProperty( u, "dotId") << "->" << G.getProperty( v, "dotId");
-                    out << dotId[u] << "->" << dotId[v];
+                    out << i << "->" << dotId[v];
 		            out << "[label=\"" ;
-                    e->print(out);
+                    e->print(out.stream());
 	                out << "\"]\n";
                     ++edge_progress;
 	            }
             }
 
-            //G.removeNodeProperty( "dotId");
-
             out << "}";
             out.close(); 
         }
@@ -1049,82 +1232,80 @@ public:
     typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
     typedef typename GraphType::SizeType        SizeType;
 
-    GMLWriter( const std::string& filename):GraphWriter<GraphType>(filename)
+    GMLWriter( const std::string& filename, bool backgroundWriter = false):GraphWriter<GraphType>(filename,backgroundWriter)
     {
     }
 
     void write( GraphType& G)
     {
-        std::ofstream out;
+        OutputBuffer out( 1 << 22, GraphWriter<GraphType>::m_backgroundWriter);
         std::cout << "Writing GML to " << GraphWriter<GraphType>::m_filename << std::endl;
-        V.clear();
-        out.exceptions ( std::ofstream::failbit | std::ofstream::badbit );
         
         try {
-            out.open( GraphWriter<GraphType>::m_filename.c_str());
-            
-            if (out.is_open())
-            {
-                out.exceptions ( std::ios_base::goodbit);
+            out.open( GraphWriter<GraphType>::m_filename);
+            m_nodeIds.init(G);
 
-                std::stringstream node_stream, edge_stream;
-                node_stream << "Writing " << G.getNumNodes() << " nodes";
-                edge_stream << "Writing " << G.getNumEdges() << " edges";
-                ProgressBar node_progress( G.getNumNodes(),node_stream.str());  
-                ProgressBar edge_progress( G.getNumEdges(),edge_stream.str());                  
+            std::stringstream node_stream, edge_stream;
+            node_stream << "Writing " << G.getNumNodes() << " nodes";
+            edge_stream << "Writing " << G.getNumEdges() << " edges";
+            ProgressBar node_progress( G.getNumNodes(),node_stream.str());  
+            ProgressBar edge_progress( G.getNumEdges(),edge_stream.str());                  
 
-                out << "graph [\n";
-                
-                NodeIterator u, lastNode;
-                EdgeIterator e, lastEdge;
+            out << "graph [\n";
+            
+            NodeIterator u, lastNode;
+            EdgeIterator e, lastEdge;
 
-                nodeId = 0;
-                for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-                {
-                    writeNode( G, u, out);
-                    ++node_progress;
-                }
-                
-                for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-                {
-                    for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e) 
-                    { 
-                        writeEdge( G, u, e, out);
-                        ++edge_progress;
-                    }
+            nodeId = 0;
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+            {
+                writeNode( G, u, out);
+                ++node_progress;
+            }
+            
+            nodeId = 0;
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++nodeId)
+            {
+                for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e) 
+                { 
+                    writeEdge( G, u, e, out);
+                    ++edge_progress;
                 }
-                           
-                out << "]\n";
+            }
+                       
+            out << "]\n";
 
-                out.close();
-            }            
+            out.close();
         }
-        catch (std::ifstream::failure e) {
+        catch (std::ofstream::failure e) {
             std::cerr << "Exception opening/writing file '" << GraphWriter<GraphType>::m_filename << "'\n";
             throw e;
         }
     }
 
-    void writeNode(GraphType& G, NodeIterator& u, std::ofstream& out)
+    void writeNode(GraphType& G, NodeIterator& u, OutputBuffer& out)
     {
-        out << "node [" << std::endl;
+        out << "node [\n";
         out << "id " << nodeId++ << "\n";
-        u->writeProperties(out);
-        out << "]" << std::endl;
+        u->writeProperties(out.stream());
+        out << "]\n";
     }
 
-    void writeEdge(GraphType& G, NodeIterator& u, EdgeIterator& e, std::ofstream& out)
+    /**
+     * @brief Writes an edge. The source is the node with position nodeId
+     */
+    void writeEdge(GraphType& G, NodeIterator& u, EdgeIterator& e, OutputBuffer& out)
     {
-        out << "edge [" << std::endl;
-        out << "source " << G.getRelativePosition(u) << std::endl; 
+        out << "edge [\n";
+        out << "source " << nodeId << "\n"; 
         NodeIterator v = G.target(e);
-        out << "target " << G.getRelativePosition(v) << std::endl; 
-        e->writeProperties(out);
-        out << "]" << std::endl;
+        out << "target " << m_nodeIds[v] << "\n"; 
+        e->writeProperties(out.stream());
+        out << "]\n";
     }
 
 private:
-    std::vector<NodeDescriptor> V;
+    NodeIndexMap<GraphType> m_nodeIds;
     unsigned int nodeId;
 };
 
@@ -1139,100 +1320,88 @@ public:
     typedef typename GraphType::EdgeDescriptor  EdgeDescriptor;
     typedef typename GraphType::SizeType        SizeType;
 
-    JSONWriter( const std::string& filename):GraphWriter<GraphType>(filename)
+    JSONWriter( const std::string& filename, bool backgroundWriter = false):GraphWriter<GraphType>(filename,backgroundWriter)
     {
     }
 
     void write( GraphType& G)
     {
-        std::ofstream out;
+        OutputBuffer out( 1 << 22, GraphWriter<GraphType>::m_backgroundWriter);
         std::cout << "Writing JSON to " << GraphWriter<GraphType>::m_filename << std::endl;
-        V.clear();
-        out.exceptions ( std::ofstream::failbit | std::ofstream::badbit );
         
         try {
-            out.open( GraphWriter<GraphType>::m_filename.c_str());
+            out.open( GraphWriter<GraphType>::m_filename);
+            m_nodeIds.init(G);
+
+            std::stringstream node_stream, edge_stream;
+            node_stream << "Writing " << G.getNumNodes() << " nodes";
+            edge_stream << "Writing " << G.getNumEdges() << " edges";
+            ProgressBar node_progress( G.getNumNodes(),node_stream.str());  
+            ProgressBar edge_progress( G.getNumEdges(),edge_stream.str());                
+
+            out << "{\n\"graph\": {\n";
             
-            if (out.is_open())
+            NodeIterator u, lastNode;
+            EdgeIterator e, lastEdge;
+
+            out << "\"nodes\": [\n";
+            
+            nodeId = 0;
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
             {
-                out.exceptions ( std::ios_base::goodbit);
-                std::stringstream node_stream, edge_stream;
-                node_stream << "Writing " << G.getNumNodes() << " nodes";
-                edge_stream << "Writing " << G.getNumEdges() << " edges";
-                ProgressBar node_progress( G.getNumNodes(),node_stream.str());  
-                ProgressBar edge_progress( G.getNumEdges(),edge_stream.str());                
-
-
-                out << "{\n\"graph\": [\n";
-                
-                NodeIterator u, w, lastNode;
-                EdgeIterator e, k, lastEdge;
-
-                out << "\"nodes\": [\n";
-                
-                nodeId = 0;
-                w = G.beginNodes();
-                ++w;
-                for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++w)
-                {
-                    writeNode( G, u, out);
-                    ++node_progress;
-                    if( w != lastNode) out << ",";
-                    out << "\n";
-                }
-                
-                out << "],\n\"edges\": [\n";
-                
-                w = G.beginNodes();
-                ++w;
-                for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
-                {
-                    k = G.beginEdges(u);
-                    ++k;
-                    for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e) 
-                    { 
-                        writeEdge( G, u, e, out);
-                        ++edge_progress;
-                        if( w != lastNode) out << ",";
-                        else
-                        {
-                            if( k != lastEdge) out << ",";
-                        }
-                        out << "\n";
-                    }
+                if( nodeId) out << ",\n";
+                writeNode( G, u, out);
+                ++node_progress;
+            }
+            
+            out << "\n],\n\"edges\": [\n";
+            
+            bool isFirstEdge = true;
+            nodeId = 0;
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++nodeId)
+            {
+                for( e = G.beginEdges(u), lastEdge = G.endEdges(u); e != lastEdge; ++e) 
+                { 
+                    if( !isFirstEdge) out << ",\n";
+                    isFirstEdge = false;
+                    writeEdge( G, u, e, out);
+                    ++edge_progress;
                 }
-                           
-                out << "}\n";
+            }
+                       
+            out << "\n]\n}\n}\n";
 
-                out.close();
-            }            
+            out.close();
         }
-        catch (std::ifstream::failure e) {
+        catch (std::ofstream::failure e) {
             std::cerr << "Exception opening/writing file '" << GraphWriter<GraphType>::m_filename << "'\n";
             throw e;
         }
     }
 
-    void writeNode(GraphType& G, NodeIterator& u, std::ofstream& out)
+    void writeNode(GraphType& G, NodeIterator& u, OutputBuffer& out)
     {
         out << "{" ;
-        out << "\"id\":" << nodeId++ << "";
-        u->writeJSON(out);
+        out << "\"id\":" << nodeId++;
+        u->writeJSON(out.stream());
         out << "}";
     }
 
-    void writeEdge(GraphType& G, NodeIterator& u, EdgeIterator& e, std::ofstream& out)
+    /**
+     * @brief Writes an edge. The source is the node with position nodeId
+     */
+    void writeEdge(GraphType& G, NodeIterator& u, EdgeIterator& e, OutputBuffer& out)
     {
         out << "{" ;
-        out << "\"s\":" << G.getRelativePosition(u) << ","; 
+        out << "\"s\":" << nodeId << ","; 
         NodeIterator v = G.target(e);
-        out << "\"t\":" << G.getRelativePosition(v) << ","; 
-        e->writeJSON(out);
+        out << "\"t\":" << m_nodeIds[v] << ","; 
+        e->writeJSON(out.stream());
         out << "}";
     }
 
 private:
-    std::vector<NodeDescriptor> V;
+    NodeIndexMap<GraphType> m_nodeIds;
     unsigned int nodeId;
 };
 
@@ -1248,27 +1417,27 @@ public:
     typedef typename GraphType::SizeType        SizeType;
     typedef typename std::vector<NodeDescriptor>::iterator iterator;
     
-    DIMACS10Writer( const std::string& filename, const std::string& coordinatesFilename):GraphWriter<GraphType>(filename),m_coordinatesFilename(coordinatesFilename)
+    DIMACS10Writer( const std::string& filename, const std::string& coordinatesFilename, bool backgroundWriter = false):GraphWriter<GraphType>(filename,backgroundWriter),m_coordinatesFilename(coordinatesFilename)
     {
     }
     
     void write( GraphType& G)
     {
-        std::ofstream out;
-        std::cout << "Writing shuffled DIMACS10 to " << GraphWriter<GraphType>::m_filename << std::endl;
-        NodeIterator u,v;
+        OutputBuffer out( 1 << 22, GraphWriter<GraphType>::m_backgroundWriter);
+        std::cout << "Writing DIMACS10 to " << GraphWriter<GraphType>::m_filename << std::endl;
+        NodeIterator u,v,lastNode;
         EdgeIterator e,beginEdges,endEdges;
-        std::ifstream in;
-        out.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
         
         try {
-            out.open( GraphWriter<GraphType>::m_filename.c_str());
-            out << G.getNumNodes() << " " << G.getNumEdges()/2 << std::endl;
+            out.open( GraphWriter<GraphType>::m_filename);
+            out << G.getNumNodes() << " " << G.getNumEdges()/2 << "\n";
+
+            NodeIndexMap<GraphType> nodeIds;
+            nodeIds.init(G);
                         
             std::stringstream nodestream;
             nodestream << "Writing " << G.getNumNodes() << " nodes";
             ProgressBar node_progress( G.getNumNodes(),nodestream.str());
-            NodeIterator u, lastNode;
             for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
             {
                 beginEdges = G.beginEdges(u);
@@ -1276,36 +1445,35 @@ public:
                 for( e = beginEdges ; e != endEdges; ++e)
                 {
                     v = G.target(e);
-                    if( e != beginEdges) out << " ";
-                    out << G.getRelativePosition(v) + 1;
+                    if( e != beginEdges) out << ' ';
+                    out << nodeIds[v] + 1;
                 }
-                out << "\n";
+                out << '\n';
                 ++node_progress;
             }
             
             out.close();
         }
-        catch (std::ifstream::failure e) {
+        catch (std::ofstream::failure e) {
             std::cerr << "Exception opening/reading file '" << GraphWriter<GraphType>::m_filename  << "'\n";
             throw e;
         }
         
         try {
-            std::cout << "Writing shuffled coordinates to " << m_coordinatesFilename << std::endl;
-            out.open( m_coordinatesFilename.c_str());
+            std::cout << "Writing coordinates to " << m_coordinatesFilename << std::endl;
+            out.open( m_coordinatesFilename);
             std::stringstream nodestream;
             nodestream << "\tWriting " << G.getNumNodes() << " coordinates";
             ProgressBar node_progress( G.getNumNodes(),nodestream.str());
-            NodeIterator u, lastNode;
             for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
             {
-                out << u->x << " " << u->y << " 0\n";
+                out << u->x << ' ' << u->y << " 0\n";
                 ++node_progress;
             }
 
             out.close();
         }
-        catch (std::ifstream::failure e) {
+        catch (std::ofstream::failure e) {
             std::cerr << "Exception opening/reading file '" << m_coordinatesFilename << "'\n";
             throw e;
         }
@@ -1327,23 +1495,21 @@ public:
     typedef typename GraphType::SizeType        SizeType;
     typedef typename std::vector<NodeDescriptor>::iterator iterator;
     
-    DIMACS10Shuffler( const std::string& filename, const std::string& coordinatesFilename, const std::vector<NodeDescriptor>& ids):GraphWriter<GraphType>(filename),m_coordinatesFilename(coordinatesFilename),m_ids(ids)
+    DIMACS10Shuffler( const std::string& filename, const std::string& coordinatesFilename, const std::vector<NodeDescriptor>& ids, bool backgroundWriter = false):GraphWriter<GraphType>(filename,backgroundWriter),m_coordinatesFilename(coordinatesFilename),m_ids(ids)
     {
     }
     
     void write( GraphType& G)
     {
-        std::ofstream out;
+        OutputBuffer out( 1 << 22, GraphWriter<GraphType>::m_backgroundWriter);
         std::cout << "Writing shuffled DIMACS10 to " << GraphWriter<GraphType>::m_filename << std::endl;
         NodeIterator u,v;
         EdgeIterator e,beginEdges,endEdges;
         iterator it ,end;
-        std::ifstream in;
-        out.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
         
         try {
-            out.open( GraphWriter<GraphType>::m_filename.c_str());
-            out << G.getNumNodes() << " " << G.getNumEdges()/2 << std::endl;
+            out.open( GraphWriter<GraphType>::m_filename);
+            out << G.getNumNodes() << " " << G.getNumEdges()/2 << "\n";
                         
             std::stringstream nodestream;
             nodestream << "Writing " << G.getNumNodes() << " nodes";
@@ -1356,36 +1522,36 @@ public:
                 for( e = beginEdges ; e != endEdges; ++e)
                 {
                     v = G.target(e);
-                    if( e != beginEdges) out << " ";
+                    if( e != beginEdges) out << ' ';
                     out << v->rank + 1;
                 }
-                out << "\n";
+                out << '\n';
                 ++node_progress;
             }
             
             out.close();
         }
-        catch (std::ifstream::failure e) {
+        catch (std::ofstream::failure e) {
             std::cerr << "Exception opening/reading file '" << GraphWriter<GraphType>::m_filename  << "'\n";
             throw e;
         }
         
         try {
             std::cout << "Writing shuffled coordinates to " << m_coordinatesFilename << std::endl;
-            out.open( m_coordinatesFilename.c_str());
+            out.open( m_coordinatesFilename);
             std::stringstream nodestream;
             nodestream << "\tWriting " << G.getNumNodes() << " coordinates";
             ProgressBar node_progress( G.getNumNodes(),nodestream.str());
             for( it = m_ids.begin(), end = m_ids.end(); it != end; ++it)
             {
                 u = G.getNodeIterator(*it);
-                out << u->x << " " << u->y << " 0\n";
+                out << u->x << ' ' << u->y << " 0\n";
                 ++node_progress;
             }
 
             out.close();
         }
-        catch (std::ifstream::failure e) {
+        catch (std::ofstream::failure e) {
             std::cerr << "Exception opening/reading file '" << m_coordinatesFilename << "'\n";
             throw e;
         }
@@ -1408,39 +1574,40 @@ public:
     typedef typename GraphType::SizeType        SizeType;
     typedef typename std::vector<NodeDescriptor>::iterator iterator;
     
-    DDSGWriter( const std::string& filename):GraphWriter<GraphType>(filename)
+    DDSGWriter( const std::string& filename, bool backgroundWriter = false):GraphWriter<GraphType>(filename,backgroundWriter)
     {
     }
     
     void write( GraphType& G)
     {
-        std::ofstream out;
+        OutputBuffer out( 1 << 22, GraphWriter<GraphType>::m_backgroundWriter);
         std::cout << "Writing DDSG to " << GraphWriter<GraphType>::m_filename << std::endl;
         NodeIterator u,v,lastNode;
         EdgeIterator e,beginEdges,endEdges;
-        out.exceptions ( std::ofstream::failbit | std::ofstream::badbit );
-
 
         //restrictions : 1) the loaded graph must be undirected
         //               2) max node Id != max(unisgned int)
 
         try {
-            out.open( GraphWriter<GraphType>::m_filename.c_str());
-            out << "d" << std::endl 
-                << G.getNumNodes() << " " << G.getNumEdges() << std::endl;
+            out.open( GraphWriter<GraphType>::m_filename);
+            out << "d\n" << G.getNumNodes() << " " << G.getNumEdges() << "\n";
+
+            NodeIndexMap<GraphType> nodeIds;
+            nodeIds.init(G);
                         
             std::stringstream edgestream;
             edgestream << "Writing " << G.getNumEdges() << " edges";
             ProgressBar edge_progress( G.getNumEdges(),edgestream.str());
             
-            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u)
+            SizeType i = 0;
+            for( u = G.beginNodes(), lastNode = G.endNodes(); u != lastNode; ++u, ++i)
             {
                 beginEdges = G.beginEdges(u);
                 endEdges = G.endEdges(u);
                 for( e = beginEdges ; e != endEdges; ++e)
                 {
                     v = G.target(e);
-                    out << G.getRelativePosition(u) << " " << G.getRelativePosition(v) << " " << e->weight << " " << 1 << std::endl;
+                    out << i << ' ' << nodeIds[v] << ' ' << e->weight << " 1\n";
                     ++edge_progress;
                 }
             }
@@ -0,0 +1,141 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+/**
+ * @brief A read only file mapped to memory
+ *
+ * The contents of the file are accessible as a range of characters [begin(), end()), which
+ * can be split in chunks that start at the beginning of a line, so that every chunk can be
+ * parsed by a different thread.
+ *
+ * @author Panos Michail
+ *
+ */
+class MappedFile
+{
+public:
+    MappedFile():m_data(0),m_size(0)
+    {
+    }
+
+    MappedFile( const std::string& filename):m_data(0),m_size(0)
+    {
+        open( filename);
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    /**
+     * @brief Maps a file to memory
+     *
+     * @param filename The name of the file
+     * @return True if the file was mapped, false otherwise
+     */
+    bool open( const std::string& filename)
+    {
+        close();
+        int fd = ::open( filename.c_str(), O_RDONLY);
+        if( fd < 0)
+        {
+            std::cerr << "Exception opening/reading file '" << filename << "'\n";
+            return false;
+        }
+
+        struct stat info;
+        if( fstat( fd, &info) < 0)
+        {
+            ::close( fd);
+            std::cerr << "Exception opening/reading file '" << filename << "'\n";
+            return false;
+        }
+
+        m_size = info.st_size;
+        if( m_size > 0)
+        {
+            void* address = mmap( 0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if( address == MAP_FAILED)
+            {
+                ::close( fd);
+                m_size = 0;
+                std::cerr << "Exception opening/reading file '" << filename << "'\n";
+                return false;
+            }
+            m_data = static_cast<const char*>( address);
+            madvise( address, m_size, MADV_SEQUENTIAL);
+        }
+        ::close( fd);
+        return true;
+    }
+
+    void close()
+    {
+        if( m_data)
+        {
+            munmap( const_cast<char*>( m_data), m_size);
+        }
+        m_data = 0;
+        m_size = 0;
+    }
+
+    bool isOpen() const
+    {
+        return m_data != 0;
+    }
+
+    const char* begin() const
+    {
+        return m_data;
+    }
+
+    const char* end() const
+    {
+        return m_data + m_size;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Splits a range of the file in chunks of about equal size that start at the beginning of a line
+     *
+     * @param first The beginning of the range, at the beginning of a line
+     * @param last The end of the range
+     * @param numChunks The number of chunks
+     * @param bounds Filled with numChunks + 1 positions. Chunk i is the range [bounds[i], bounds[i+1])
+     */
+    static void split( const char* first, const char* last, unsigned int numChunks, std::vector<const char*>& bounds)
+    {
+        bounds.assign( numChunks + 1, last);
+        bounds[0] = first;
+        size_t chunkSize = ( last - first) / numChunks;
+        for( unsigned int i = 1; i < numChunks; ++i)
+        {
+            const char* p = std::max( bounds[i-1], first + i * chunkSize);
+            while( p != last && p != first && *(p-1) != '\n') ++p;
+            bounds[i] = p;
+        }
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+
+    MappedFile( const MappedFile&);
+    MappedFile& operator = ( const MappedFile&);
+};
+
+#endif //MAPPEDFILE_H
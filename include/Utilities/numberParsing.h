@@ -0,0 +1,121 @@
+#ifndef NUMBERPARSING_H
+#define NUMBERPARSING_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Parsing of numbers from character ranges, for readers of large text files.
+ *
+ * On little endian machines the digits are parsed eight at a time inside a 64-bit word (SWAR):
+ * one mask finds how many of the next eight characters are digits and three multiplications
+ * combine them into a number. Near the end of the range, where eight characters can not be
+ * loaded, the digits are parsed one by one.
+ */
+
+inline bool isDigit( char c)
+{
+    return (unsigned char)( c - '0') < 10;
+}
+
+inline const char* skipBlanks( const char* p, const char* end)
+{
+    while( p != end && ( *p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+/**
+ * @brief Returns the position after the end of the line that contains p
+ */
+inline const char* skipLine( const char* p, const char* end)
+{
+    const char* newline = static_cast<const char*>( memchr( p, '\n', end - p));
+    return newline ? newline + 1 : end;
+}
+
+/**
+ * @brief Returns the number of leading digits in a word of eight characters, and their value
+ */
+inline unsigned int parseEightDigits( const char* p, uint64_t& value)
+{
+    uint64_t chunk;
+    memcpy( &chunk, p, 8);
+
+    // A byte is not a digit if its high nibble is not 3 or its low nibble is larger than 9
+    uint64_t nonDigits = ( ( chunk & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL) |
+                         ( ( ( chunk & 0x0F0F0F0F0F0F0F0FULL) + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL);
+    unsigned int numDigits = 8;
+    if( nonDigits)
+    {
+#ifdef __GNUC__
+        numDigits = __builtin_ctzll( nonDigits) >> 3;
+#else
+        numDigits = 0;
+        while( !( nonDigits & 0xFFULL)) { nonDigits >>= 8; ++numDigits; }
+#endif
+    }
+    if( numDigits == 0)
+    {
+        value = 0;
+        return 0;
+    }
+
+    // Drop the characters after the digits and put the digits in the high bytes
+    chunk = ( chunk & 0x0F0F0F0F0F0F0F0FULL) << ( 8 * ( 8 - numDigits));
+    chunk = ( chunk * 10 + ( chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+    chunk = ( chunk * 100 + ( chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+    chunk = ( chunk * 10000 + ( chunk >> 32)) & 0x00000000FFFFFFFFULL;
+    value = chunk;
+    return numDigits;
+}
+
+/**
+ * @brief Parses an unsigned number, skipping the blanks before it
+ *
+ * @param p The position to start from. It is moved past the number
+ * @param end The end of the range
+ * @return The number, zero if there is no number at p
+ */
+inline uint64_t parseUnsigned( const char*& p, const char* end)
+{
+    static const uint64_t powersOf10[9] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL };
+
+    p = skipBlanks( p, end);
+    uint64_t result = 0;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    while( end - p >= 8)
+    {
+        uint64_t value;
+        unsigned int numDigits = parseEightDigits( p, value);
+        result = result * powersOf10[numDigits] + value;
+        p += numDigits;
+        if( numDigits < 8) return result;
+    }
+#endif
+
+    while( p != end && isDigit( *p))
+    {
+        result = result * 10 + ( *p - '0');
+        ++p;
+    }
+    return result;
+}
+
+/**
+ * @brief Parses a signed number, skipping the blanks before it
+ */
+inline int64_t parseInteger( const char*& p, const char* end)
+{
+    p = skipBlanks( p, end);
+    bool negative = false;
+    if( p != end && ( *p == '-' || *p == '+'))
+    {
+        negative = ( *p == '-');
+        ++p;
+    }
+    int64_t value = parseUnsigned( p, end);
+    return negative ? -value : value;
+}
+
+#endif //NUMBERPARSING_H
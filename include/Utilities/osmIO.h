@@ -0,0 +1,306 @@
+#ifndef OSMIO_H
+#define OSMIO_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <Utilities/graphIO.h>
+#include <Utilities/xmlTokenizer.h>
+#include <Utilities/geographic.h>
+
+/**
+ * @brief Reads the road network of an OpenStreetMap XML file (.osm, or compressed .osm.gz and .osm.zst)
+ *
+ * The file is streamed twice with a SAX style tokenizer. The first pass keeps the ways with an
+ * accepted highway tag, and the second the coordinates of the nodes of those ways. The nodes get
+ * consecutive ids in the order of their OpenStreetMap ids, and the graph is built in one batch.
+ *
+ * Nodes need the fields x and y, which are set to ( lon + 180) * OSM_COORDINATE_SCALE and
+ * ( lat + 90) * OSM_COORDINATE_SCALE, so that they are not negative. Edges need the field weight,
+ * which is set to the length of the edge in meters, rounded, and at least 1.
+ *
+ * A way is one way for oneway=yes/true/1 (oneway=-1 reverses it), for junction=roundabout and
+ * for motorways. Nodes and ways are expected before relations, as in the files of the
+ * OpenStreetMap servers; reading stops at the first relation.
+ */
+template<typename GraphType>
+class OSMXMLReader : public GraphReader<GraphType>
+{
+public:
+    typedef typename GraphType::NodeIterator    NodeIterator;
+    typedef typename GraphType::NodeDescriptor  NodeDescriptor;
+    typedef typename GraphType::SizeType        SizeType;
+    typedef typename GraphType::EdgeData        EdgeData;
+
+    static const unsigned int OSM_COORDINATE_SCALE = 1000000;
+
+    /**
+     * @brief Constructor
+     *
+     * @param filename The name of the file
+     * @param highways The accepted values of the highway tag. If empty, the roads that cars may use are accepted
+     */
+    OSMXMLReader( const std::string& filename, const std::vector<std::string>& highways = std::vector<std::string>()):GraphReader<GraphType>(filename),m_highways(highways)
+    {
+        if( m_highways.empty())
+        {
+            const char* roads[] = { "motorway", "motorway_link", "trunk", "trunk_link", "primary", "primary_link",
+                                    "secondary", "secondary_link", "tertiary", "tertiary_link", "unclassified",
+                                    "residential", "living_street", "service", "road" };
+            m_highways.assign( roads, roads + sizeof( roads) / sizeof( roads[0]));
+        }
+    }
+
+    void read( GraphType& G)
+    {
+        std::cout << "Reading OSM from " << GraphReader<GraphType>::m_filename << std::endl;
+        readWays();
+        readNodes();
+        buildGraph( G);
+    }
+
+    /**
+     * @brief Returns the OpenStreetMap id of the node with an id of the graph
+     *
+     * @param id The position of the node in the descriptors returned by getIds()
+     */
+    uint64_t getOSMId( SizeType id) const
+    {
+        return m_osmIds[id];
+    }
+
+    NodeDescriptor id2Desc( SizeType id)
+    {
+        return GraphReader<GraphType>::m_ids[id];
+    }
+
+private:
+    enum Direction { BOTH_DIRECTIONS, FORWARD, BACKWARD };
+
+    struct Way
+    {
+        size_t firstRef;
+        size_t lastRef;
+        Direction direction;
+    };
+
+    std::vector<std::string> m_highways;
+    std::vector<uint64_t> m_refs;
+    std::vector<Way> m_ways;
+    std::vector<uint64_t> m_osmIds;
+    std::vector<double> m_lat, m_lon;
+    std::vector<bool> m_hasCoordinates;
+
+    bool isAcceptedHighway( const XMLAttribute& value) const
+    {
+        for( unsigned int i = 0; i < m_highways.size(); ++i)
+        {
+            if( value.hasValue( m_highways[i].c_str())) return true;
+        }
+        return false;
+    }
+
+    static uint64_t parseId( const XMLAttribute* attribute)
+    {
+        if( !attribute) return 0;
+        const char* p = attribute->value;
+        return parseUnsigned( p, attribute->value + attribute->valueLength);
+    }
+
+    static double parseDegrees( const XMLAttribute* attribute)
+    {
+        if( !attribute) return 0;
+        char buffer[32];
+        size_t length = std::min( attribute->valueLength, sizeof( buffer) - 1);
+        memcpy( buffer, attribute->value, length);
+        buffer[length] = 0;
+        return strtod( buffer, 0);
+    }
+
+    /**
+     * @brief First pass: keeps the node references of the accepted ways
+     */
+    void readWays()
+    {
+        TextBlockReader file;
+        openTextFile( file, GraphReader<GraphType>::m_filename);
+        XMLTokenizer tokenizer( file);
+        XMLTag tag;
+
+        m_refs.clear();
+        m_ways.clear();
+        bool isInWay = false, isAccepted = false, isRoundabout = false, isMotorway = false;
+        Way way;
+        way.direction = BOTH_DIRECTIONS;
+        SizeType numWays = 0;
+
+        while( tokenizer.next( tag))
+        {
+            if( tag.is( "way"))
+            {
+                if( tag.isClosing)
+                {
+                    if( isInWay && isAccepted && m_refs.size() - way.firstRef >= 2)
+                    {
+                        if( way.direction == BOTH_DIRECTIONS && ( isRoundabout || isMotorway)) way.direction = FORWARD;
+                        way.lastRef = m_refs.size();
+                        m_ways.push_back( way);
+                    }
+                    else
+                    {
+                        m_refs.resize( way.firstRef);
+                    }
+                    isInWay = false;
+                }
+                else if( !tag.isSelfClosing)
+                {
+                    isInWay = true;
+                    isAccepted = isRoundabout = isMotorway = false;
+                    way.firstRef = m_refs.size();
+                    way.direction = BOTH_DIRECTIONS;
+                    ++numWays;
+                }
+            }
+            else if( isInWay && tag.is( "nd"))
+            {
+                m_refs.push_back( parseId( tag.find( "ref")));
+            }
+            else if( isInWay && tag.is( "tag"))
+            {
+                const XMLAttribute* key = tag.find( "k");
+                const XMLAttribute* value = tag.find( "v");
+                if( !key || !value) continue;
+                if( key->hasValue( "highway"))
+                {
+                    isAccepted = isAcceptedHighway( *value);
+                    isMotorway = value->hasValue( "motorway");
+                }
+                else if( key->hasValue( "oneway"))
+                {
+                    if( value->hasValue( "yes") || value->hasValue( "true") || value->hasValue( "1")) way.direction = FORWARD;
+                    else if( value->hasValue( "-1")) way.direction = BACKWARD;
+                }
+                else if( key->hasValue( "junction") && value->hasValue( "roundabout"))
+                {
+                    isRoundabout = true;
+                }
+            }
+            else if( tag.is( "relation"))
+            {
+                break;
+            }
+        }
+        if( isInWay) m_refs.resize( way.firstRef);
+
+        std::cout << "\tKept " << m_ways.size() << " of " << numWays << " ways\n";
+
+        m_osmIds = m_refs;
+        std::sort( m_osmIds.begin(), m_osmIds.end());
+        m_osmIds.erase( std::unique( m_osmIds.begin(), m_osmIds.end()), m_osmIds.end());
+    }
+
+    /**
+     * @brief Second pass: reads the coordinates of the nodes of the accepted ways
+     */
+    void readNodes()
+    {
+        TextBlockReader file;
+        openTextFile( file, GraphReader<GraphType>::m_filename);
+        XMLTokenizer tokenizer( file);
+        XMLTag tag;
+
+        m_lat.assign( m_osmIds.size(), 0);
+        m_lon.assign( m_osmIds.size(), 0);
+        m_hasCoordinates.assign( m_osmIds.size(), false);
+
+        while( tokenizer.next( tag))
+        {
+            if( tag.isClosing) continue;
+            if( tag.is( "node"))
+            {
+                uint64_t id = parseId( tag.find( "id"));
+                std::vector<uint64_t>::const_iterator it = std::lower_bound( m_osmIds.begin(), m_osmIds.end(), id);
+                if( it == m_osmIds.end() || *it != id) continue;
+                size_t i = it - m_osmIds.begin();
+                m_lat[i] = parseDegrees( tag.find( "lat"));
+                m_lon[i] = parseDegrees( tag.find( "lon"));
+                m_hasCoordinates[i] = true;
+            }
+            else if( tag.is( "way") || tag.is( "relation"))
+            {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Builds the graph from the ways. Nodes without coordinates, which are outside of the extract, are dropped
+     */
+    void buildGraph( GraphType& G)
+    {
+        SizeType numNodes = 0;
+        for( size_t i = 0; i < m_osmIds.size(); ++i)
+        {
+            if( m_hasCoordinates[i])
+            {
+                m_osmIds[numNodes] = m_osmIds[i];
+                m_lat[numNodes] = m_lat[i];
+                m_lon[numNodes] = m_lon[i];
+                ++numNodes;
+            }
+        }
+
+        std::vector< std::pair<SizeType,SizeType> > edges;
+        std::vector<EdgeData> edgeData;
+        for( size_t w = 0; w < m_ways.size(); ++w)
+        {
+            const Way& way = m_ways[w];
+            for( size_t r = way.firstRef + 1; r < way.lastRef; ++r)
+            {
+                size_t i = std::lower_bound( m_osmIds.begin(), m_osmIds.begin() + numNodes, m_refs[r-1]) - m_osmIds.begin();
+                size_t j = std::lower_bound( m_osmIds.begin(), m_osmIds.begin() + numNodes, m_refs[r]) - m_osmIds.begin();
+                if( i == numNodes || j == numNodes || m_osmIds[i] != m_refs[r-1] || m_osmIds[j] != m_refs[r] || i == j) continue;
+
+                EdgeData data;
+                double length = haversineDistanceInMeters( m_lat[i], m_lon[i], m_lat[j], m_lon[j]);
+                data.weight = std::max( 1.0, floor( length + 0.5));
+                if( way.direction != BACKWARD)
+                {
+                    edges.push_back( std::make_pair( SizeType(i), SizeType(j)));
+                    edgeData.push_back( data);
+                }
+                if( way.direction != FORWARD)
+                {
+                    edges.push_back( std::make_pair( SizeType(j), SizeType(i)));
+                    edgeData.push_back( data);
+                }
+            }
+        }
+        std::vector<uint64_t>().swap( m_refs);
+        std::vector<Way>().swap( m_ways);
+        m_osmIds.resize( numNodes);
+
+        std::vector<NodeDescriptor> ids;
+        G.buildFromEdgeList( numNodes, edges, edgeData, ids);
+        GraphReader<GraphType>::m_ids.swap( ids);
+
+        for( SizeType i = 0; i < numNodes; ++i)
+        {
+            NodeIterator u = G.getNodeIterator( GraphReader<GraphType>::m_ids[i]);
+            u->x = floor( ( m_lon[i] + 180) * OSM_COORDINATE_SCALE + 0.5);
+            u->y = floor( ( m_lat[i] + 90) * OSM_COORDINATE_SCALE + 0.5);
+        }
+        std::vector<double>().swap( m_lat);
+        std::vector<double>().swap( m_lon);
+        std::vector<bool>().swap( m_hasCoordinates);
+
+        std::cout << "\tRead " << G.getNumNodes() << " nodes and " << G.getNumEdges() << " edges\n";
+    }
+};
+
+template<typename GraphType>
+const unsigned int OSMXMLReader<GraphType>::OSM_COORDINATE_SCALE;
+
+#endif //OSMIO_H
@@ -0,0 +1,393 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <Utilities/compression.h>
+
+/**
+ * @brief A file writer with a large user space buffer
+ *
+ * The output is collected in a buffer and handed to write() only when the buffer is full, and
+ * integers are formatted directly into the buffer, two digits at a time. With a background
+ * writer, two buffers are used: a thread writes out the full one while the other is filled.
+ * Files with the extension of a compression format (see compression.h) are compressed on the
+ * way out, by the background writer if there is one.
+ *
+ * The buffer is also a std::streambuf, so that items that print themselves to a std::ostream
+ * can write to it through stream().
+ *
+ * Errors throw std::ofstream::failure, as std::ofstream does with exceptions enabled.
+ *
+ * @author Panos Michail
+ *
+ */
+class OutputBuffer : public std::streambuf
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param capacity The size of the buffer in bytes
+     * @param background If true, a background thread writes the full buffers to the file
+     */
+    OutputBuffer( size_t capacity = 1 << 22, bool background = false):m_stream(this),m_fd(-1),m_compression(NO_COMPRESSION),m_capacity(capacity),m_active(0),m_pos(0),
+        m_background(background),m_hasThread(false),m_hasPending(false),m_stop(false),m_failed(false)
+    {
+        m_buffers[0].resize( m_capacity);
+        if( m_background) m_buffers[1].resize( m_capacity);
+        pthread_mutex_init( &m_mutex, 0);
+        pthread_cond_init( &m_condition, 0);
+    }
+
+    ~OutputBuffer()
+    {
+        try
+        {
+            close();
+        }
+        catch( std::ofstream::failure&)
+        {
+        }
+        pthread_cond_destroy( &m_condition);
+        pthread_mutex_destroy( &m_mutex);
+    }
+
+    /**
+     * @brief Opens a file for writing, truncating it
+     *
+     * @param filename The name of the file
+     */
+    void open( const std::string& filename)
+    {
+        close();
+        m_filename = filename;
+        m_compression = getCompressionType( filename);
+        if( !isCompressionSupported( m_compression))
+        {
+            throw std::ofstream::failure( "Exception opening/writing file '" + filename + "': compile with " + getCompressionFlag( m_compression));
+        }
+        m_fd = ::open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if( m_fd < 0)
+        {
+            throw std::ofstream::failure( "Exception opening/writing file '" + filename + "'");
+        }
+        if( m_compression != NO_COMPRESSION && !m_compressor.open( m_compression))
+        {
+            ::close( m_fd);
+            m_fd = -1;
+            throw std::ofstream::failure( "Exception opening/writing file '" + filename + "'");
+        }
+        m_failed = false;
+        m_pos = 0;
+        if( m_background)
+        {
+            m_stop = false;
+            m_hasPending = false;
+            m_hasThread = ( pthread_create( &m_thread, 0, &OutputBuffer::run, this) == 0);
+        }
+    }
+
+    /**
+     * @brief Writes out everything buffered and closes the file
+     */
+    void close()
+    {
+        if( m_fd < 0) return;
+        try
+        {
+            flush();
+        }
+        catch( std::ofstream::failure&)
+        {
+            m_failed = true;
+        }
+        if( m_hasThread)
+        {
+            pthread_mutex_lock( &m_mutex);
+            m_stop = true;
+            pthread_cond_broadcast( &m_condition);
+            pthread_mutex_unlock( &m_mutex);
+            pthread_join( m_thread, 0);
+            m_hasThread = false;
+        }
+        if( m_compression != NO_COMPRESSION)
+        {
+            if( !m_compressor.compress( 0, 0, m_compressed, true)) m_failed = true;
+            else if( !m_compressed.empty()) writeRaw( &m_compressed[0], m_compressed.size());
+            m_compressor.close();
+        }
+        ::close( m_fd);
+        m_fd = -1;
+        checkFailure();
+    }
+
+    bool isOpen() const
+    {
+        return m_fd >= 0;
+    }
+
+    /**
+     * @brief Writes out everything buffered
+     */
+    void flush()
+    {
+        if( m_fd < 0) return;
+        submit();
+        if( m_hasThread)
+        {
+            pthread_mutex_lock( &m_mutex);
+            while( m_hasPending) pthread_cond_wait( &m_condition, &m_mutex);
+            pthread_mutex_unlock( &m_mutex);
+        }
+        checkFailure();
+    }
+
+    /**
+     * @brief Returns a stream that writes to the buffer
+     */
+    std::ostream& stream()
+    {
+        return m_stream;
+    }
+
+    void write( const char* data, size_t size)
+    {
+        while( m_pos + size > m_capacity)
+        {
+            size_t part = m_capacity - m_pos;
+            memcpy( &m_buffers[m_active][m_pos], data, part);
+            m_pos += part;
+            data += part;
+            size -= part;
+            submit();
+        }
+        memcpy( &m_buffers[m_active][m_pos], data, size);
+        m_pos += size;
+    }
+
+    void put( char c)
+    {
+        if( m_pos == m_capacity) submit();
+        m_buffers[m_active][m_pos++] = c;
+    }
+
+    void writeUnsigned( uint64_t value)
+    {
+        char digits[20];
+        char* last = digits + 20;
+        char* first = formatUnsigned( value, last);
+        write( first, last - first);
+    }
+
+    void writeInteger( int64_t value)
+    {
+        if( value < 0)
+        {
+            put( '-');
+            writeUnsigned( uint64_t(0) - uint64_t(value));
+        }
+        else
+        {
+            writeUnsigned( value);
+        }
+    }
+
+    OutputBuffer& operator << ( char c)                  { put( c); return *this; }
+    OutputBuffer& operator << ( const char* text)        { write( text, strlen( text)); return *this; }
+    OutputBuffer& operator << ( const std::string& text) { write( text.data(), text.size()); return *this; }
+    OutputBuffer& operator << ( unsigned int value)      { writeUnsigned( value); return *this; }
+    OutputBuffer& operator << ( unsigned long value)     { writeUnsigned( value); return *this; }
+    OutputBuffer& operator << ( int value)               { writeInteger( value); return *this; }
+    OutputBuffer& operator << ( long value)              { writeInteger( value); return *this; }
+
+    OutputBuffer& operator << ( double value)
+    {
+        char digits[32];
+        int size = snprintf( digits, sizeof( digits), "%g", value);
+        write( digits, size);
+        return *this;
+    }
+
+    /**
+     * @brief Formats an unsigned number backwards, ending before last
+     *
+     * @return The position of the first digit
+     */
+    static char* formatUnsigned( uint64_t value, char* last)
+    {
+        static const char digitPairs[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        while( value >= 100)
+        {
+            unsigned int pair = ( value % 100) << 1;
+            value /= 100;
+            *--last = digitPairs[pair + 1];
+            *--last = digitPairs[pair];
+        }
+        if( value >= 10)
+        {
+            unsigned int pair = value << 1;
+            *--last = digitPairs[pair + 1];
+            *--last = digitPairs[pair];
+        }
+        else
+        {
+            *--last = char( '0' + value);
+        }
+        return last;
+    }
+
+protected:
+
+    int overflow( int c)
+    {
+        if( c != EOF) put( char(c));
+        return c == EOF ? 0 : c;
+    }
+
+    std::streamsize xsputn( const char* data, std::streamsize size)
+    {
+        write( data, size);
+        return size;
+    }
+
+    int sync()
+    {
+        return 0;
+    }
+
+private:
+    std::ostream m_stream;
+    std::string m_filename;
+    int m_fd;
+    CompressionType m_compression;
+    StreamCompressor m_compressor;
+    std::vector<char> m_compressed;
+    size_t m_capacity;
+    std::vector<char> m_buffers[2];
+    unsigned int m_active;
+    size_t m_pos;
+
+    bool m_background;
+    bool m_hasThread;
+    pthread_t m_thread;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_condition;
+    bool m_hasPending;
+    unsigned int m_pendingBuffer;
+    size_t m_pendingSize;
+    bool m_stop;
+    volatile bool m_failed;
+
+    OutputBuffer( const OutputBuffer&);
+    OutputBuffer& operator = ( const OutputBuffer&);
+
+    /**
+     * @brief Hands the active buffer to the file, directly or through the background writer
+     */
+    void submit()
+    {
+        if( m_pos == 0) return;
+        if( m_fd < 0)
+        {
+            m_pos = 0;
+            throw std::ofstream::failure( "Exception writing to a closed file");
+        }
+        if( !m_hasThread)
+        {
+            writeAll( &m_buffers[m_active][0], m_pos);
+            m_pos = 0;
+            checkFailure();
+            return;
+        }
+
+        pthread_mutex_lock( &m_mutex);
+        while( m_hasPending) pthread_cond_wait( &m_condition, &m_mutex);
+        m_pendingBuffer = m_active;
+        m_pendingSize = m_pos;
+        m_hasPending = true;
+        pthread_cond_broadcast( &m_condition);
+        pthread_mutex_unlock( &m_mutex);
+
+        m_active = 1 - m_active;
+        m_pos = 0;
+        checkFailure();
+    }
+
+    void writeAll( const char* data, size_t size)
+    {
+        if( m_compression == NO_COMPRESSION)
+        {
+            writeRaw( data, size);
+        }
+        else if( m_compressor.compress( data, size, m_compressed))
+        {
+            if( !m_compressed.empty()) writeRaw( &m_compressed[0], m_compressed.size());
+        }
+        else
+        {
+            m_failed = true;
+        }
+    }
+
+    void writeRaw( const char* data, size_t size)
+    {
+        while( size > 0 && !m_failed)
+        {
+            ssize_t written = ::write( m_fd, data, size);
+            if( written < 0)
+            {
+                if( errno == EINTR) continue;
+                m_failed = true;
+                break;
+            }
+            data += written;
+            size -= written;
+        }
+    }
+
+    void checkFailure()
+    {
+        if( m_failed)
+        {
+            throw std::ofstream::failure( "Exception opening/writing file '" + m_filename + "'");
+        }
+    }
+
+    static void* run( void* argument)
+    {
+        OutputBuffer* buffer = static_cast<OutputBuffer*>( argument);
+        pthread_mutex_lock( &buffer->m_mutex);
+        while( true)
+        {
+            while( !buffer->m_hasPending && !buffer->m_stop) pthread_cond_wait( &buffer->m_condition, &buffer->m_mutex);
+            if( !buffer->m_hasPending) break;
+
+            unsigned int index = buffer->m_pendingBuffer;
+            size_t size = buffer->m_pendingSize;
+            pthread_mutex_unlock( &buffer->m_mutex);
+            buffer->writeAll( &buffer->m_buffers[index][0], size);
+            pthread_mutex_lock( &buffer->m_mutex);
+
+            buffer->m_hasPending = false;
+            pthread_cond_broadcast( &buffer->m_condition);
+        }
+        pthread_mutex_unlock( &buffer->m_mutex);
+        return 0;
+    }
+};
+
+#endif //OUTPUTBUFFER_H
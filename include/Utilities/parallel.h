@@ -0,0 +1,67 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Returns the number of threads that parallel regions will use
+ *
+ * Parallel code in the library uses OpenMP and is enabled by compiling with -fopenmp.
+ * Without it every parallel region runs on a single thread.
+ */
+inline unsigned int getNumThreads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Returns the index of the calling thread inside a parallel region
+ */
+inline unsigned int getThreadIndex()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Replaces the value at an address with another, if it still has the expected value. The test and the replacement are one atomic step
+ *
+ * @return True if the value was replaced
+ */
+inline bool compareAndSwap( unsigned int* address, unsigned int expected, unsigned int desired)
+{
+#ifdef _OPENMP
+    return __sync_bool_compare_and_swap( address, expected, desired);
+#else
+    if( *address != expected) return false;
+    *address = desired;
+    return true;
+#endif
+}
+
+/**
+ * @brief Adds a value to the value at an address, in one atomic step
+ *
+ * @return The value before the addition
+ */
+inline unsigned int fetchAndAdd( unsigned int* address, unsigned int value)
+{
+#ifdef _OPENMP
+    return __sync_fetch_and_add( address, value);
+#else
+    unsigned int previous = *address;
+    *address += value;
+    return previous;
+#endif
+}
+
+#endif //PARALLEL_H
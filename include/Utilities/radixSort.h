@@ -0,0 +1,41 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+/**
+ * @brief Sorts keys with a least significant digit radix sort, in linear time
+ *
+ * @param keys The keys to sort
+ * @param numBits The number of low bits that the keys may use
+ */
+inline void radixSort( std::vector<uint64_t>& keys, unsigned int numBits = 64)
+{
+    const unsigned int digitBits = 16;
+    const uint64_t digitMask = ( 1 << digitBits) - 1;
+    std::vector<uint64_t> buffer( keys.size());
+    std::vector<size_t> counts( digitMask + 2);
+
+    for( unsigned int shift = 0; shift < numBits; shift += digitBits)
+    {
+        std::fill( counts.begin(), counts.end(), 0);
+        for( size_t i = 0; i < keys.size(); ++i)
+        {
+            ++counts[ ( ( keys[i] >> shift) & digitMask) + 1];
+        }
+
+        // Keys that all have the same digit are already sorted by it
+        if( keys.empty() || ( counts[ ( ( keys[0] >> shift) & digitMask) + 1] == keys.size())) continue;
+
+        for( size_t d = 1; d < counts.size(); ++d) counts[d] += counts[d-1];
+        for( size_t i = 0; i < keys.size(); ++i)
+        {
+            buffer[ counts[ ( keys[i] >> shift) & digitMask]++] = keys[i];
+        }
+        keys.swap( buffer);
+    }
+}
+
+#endif //RADIXSORT_H
@@ -0,0 +1,107 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <vector>
+#include <utility>
+#include <limits>
+#include <algorithm>
+
+/**
+ * @brief A region of the plane: a bounding box, or a polygon
+ *
+ * Points are tested against the bounding box first, so that the polygon is only consulted for
+ * the points near it. A point is in a polygon by the even-odd rule, so the polygon need not be
+ * convex or oriented.
+ *
+ * @author Panos Michail
+ *
+ */
+class Region
+{
+public:
+    typedef std::pair<double,double> Point;
+
+    Region():m_minX(0),m_minY(0),m_maxX(-1),m_maxY(-1)
+    {
+    }
+
+    /**
+     * @brief Constructs a bounding box
+     */
+    Region( double minX, double minY, double maxX, double maxY):m_minX(minX),m_minY(minY),m_maxX(maxX),m_maxY(maxY)
+    {
+    }
+
+    /**
+     * @brief Constructs a polygon
+     *
+     * @param vertices The vertices of the polygon, in order. The last one is connected to the first
+     */
+    Region( const std::vector<Point>& vertices):m_vertices(vertices)
+    {
+        m_minX = m_minY = std::numeric_limits<double>::max();
+        m_maxX = m_maxY = -std::numeric_limits<double>::max();
+        for( unsigned int i = 0; i < m_vertices.size(); ++i)
+        {
+            m_minX = std::min( m_minX, m_vertices[i].first);
+            m_minY = std::min( m_minY, m_vertices[i].second);
+            m_maxX = std::max( m_maxX, m_vertices[i].first);
+            m_maxY = std::max( m_maxY, m_vertices[i].second);
+        }
+    }
+
+    bool isPolygon() const
+    {
+        return !m_vertices.empty();
+    }
+
+    /**
+     * @brief Checks if a point is in the region, or near it
+     *
+     * @param margin The point may be this far from the region. A bounding box is extended by the margin on every side
+     */
+    bool contains( double x, double y, double margin = 0) const
+    {
+        if( x < m_minX - margin || x > m_maxX + margin || y < m_minY - margin || y > m_maxY + margin) return false;
+        if( m_vertices.empty()) return true;
+        if( isInPolygon( x, y)) return true;
+        if( margin <= 0) return false;
+
+        for( unsigned int i = 0, j = m_vertices.size() - 1; i < m_vertices.size(); j = i++)
+        {
+            if( squaredDistanceToSegment( x, y, m_vertices[j], m_vertices[i]) <= margin * margin) return true;
+        }
+        return false;
+    }
+
+private:
+    double m_minX, m_minY, m_maxX, m_maxY;
+    std::vector<Point> m_vertices;
+
+    bool isInPolygon( double x, double y) const
+    {
+        bool isIn = false;
+        for( unsigned int i = 0, j = m_vertices.size() - 1; i < m_vertices.size(); j = i++)
+        {
+            const Point& a = m_vertices[i];
+            const Point& b = m_vertices[j];
+            if( ( a.second > y) != ( b.second > y) && x < ( b.first - a.first) * ( y - a.second) / ( b.second - a.second) + a.first)
+            {
+                isIn = !isIn;
+            }
+        }
+        return isIn;
+    }
+
+    static double squaredDistanceToSegment( double x, double y, const Point& a, const Point& b)
+    {
+        double dx = b.first - a.first, dy = b.second - a.second;
+        double length = dx * dx + dy * dy;
+        double t = length > 0 ? ( ( x - a.first) * dx + ( y - a.second) * dy) / length : 0;
+        t = std::max( 0.0, std::min( 1.0, t));
+        double px = a.first + t * dx - x, py = a.second + t * dy - y;
+        return px * px + py * py;
+    }
+};
+
+#endif //REGION_H
@@ -0,0 +1,340 @@
+#ifndef TEXTBLOCKREADER_H
+#define TEXTBLOCKREADER_H
+
+#include <pthread.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <iostream>
+#include <fstream>
+#include <Utilities/mappedFile.h>
+#include <Utilities/compression.h>
+
+/**
+ * @brief Reads a text file as a sequence of blocks that end at the end of a line
+ *
+ * An uncompressed file is mapped to memory and returned as a single block. A compressed file
+ * (see compression.h) is decompressed by a pipeline thread, which fills the next blocks while
+ * the current one is parsed, so that parsing is not stalled by decompression.
+ *
+ * Pipes, and the standard input with the filename "-", are read by the pipeline thread too. A
+ * block is handed over as soon as a line is complete, so that a live stream is never held back
+ * waiting for a full block.
+ *
+ * @author Panos Michail
+ *
+ */
+class TextBlockReader
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param blockSize The size of the blocks of a compressed file. Longer lines make longer blocks
+     */
+    TextBlockReader( size_t blockSize = 1 << 24):m_blockSize(blockSize),m_isCompressed(false),m_isStream(false),m_isMapped(false),m_isMappedFileRead(false),m_fd(-1),m_hasThread(false),
+        m_stop(false),m_isProducerFinished(false),m_hasFailed(false),m_currentBuffer(0)
+    {
+        pthread_mutex_init( &m_mutex, 0);
+        pthread_cond_init( &m_condition, 0);
+    }
+
+    ~TextBlockReader()
+    {
+        close();
+        pthread_cond_destroy( &m_condition);
+        pthread_mutex_destroy( &m_mutex);
+    }
+
+    /**
+     * @brief Opens a file, compressed or not
+     *
+     * @param filename The name of the file, or "-" for the standard input
+     * @return True if the file was opened, false otherwise
+     */
+    bool open( const std::string& filename)
+    {
+        close();
+        m_filename = filename;
+        CompressionType type = getCompressionType( filename);
+        m_isCompressed = ( type != NO_COMPRESSION);
+        m_isMappedFileRead = false;
+
+        if( !isCompressionSupported( type))
+        {
+            std::cerr << "Exception opening/reading file '" << filename << "': compile with " << getCompressionFlag( type) << "\n";
+            return false;
+        }
+        m_fd = ( filename == "-") ? dup( 0) : ::open( filename.c_str(), O_RDONLY);
+        struct stat info;
+        if( m_fd < 0 || fstat( m_fd, &info) < 0)
+        {
+            std::cerr << "Exception opening/reading file '" << filename << "'\n";
+            close();
+            return false;
+        }
+        m_isStream = !S_ISREG( info.st_mode);
+        m_isMapped = !m_isCompressed && !m_isStream;
+        if( m_isMapped)
+        {
+            ::close( m_fd);
+            m_fd = -1;
+            return m_file.open( filename);
+        }
+        m_decompressor.open( type, m_fd);
+        m_stop = false;
+        m_isProducerFinished = false;
+        m_hasFailed = false;
+        m_hasThread = ( pthread_create( &m_thread, 0, &TextBlockReader::run, this) == 0);
+        if( !m_hasThread)
+        {
+            std::cerr << "Exception opening/reading file '" << filename << "'\n";
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if( m_hasThread)
+        {
+            pthread_mutex_lock( &m_mutex);
+            m_stop = true;
+            pthread_cond_broadcast( &m_condition);
+            pthread_mutex_unlock( &m_mutex);
+            pthread_join( m_thread, 0);
+            m_hasThread = false;
+        }
+        if( m_fd >= 0)
+        {
+            m_decompressor.close();
+            ::close( m_fd);
+            m_fd = -1;
+        }
+        m_file.close();
+
+        releaseCurrentBuffer();
+        for( std::deque<Block>::iterator it = m_readyBlocks.begin(); it != m_readyBlocks.end(); ++it)
+        {
+            delete it->buffer;
+        }
+        m_readyBlocks.clear();
+        for( unsigned int i = 0; i < m_freeBuffers.size(); ++i)
+        {
+            delete m_freeBuffers[i];
+        }
+        m_freeBuffers.clear();
+    }
+
+    bool isCompressed() const
+    {
+        return m_isCompressed;
+    }
+
+    /**
+     * @brief Returns true if the file is a pipe or the standard input
+     */
+    bool isStream() const
+    {
+        return m_isStream;
+    }
+
+    /**
+     * @brief Returns the next block of the file. The previous block is released
+     *
+     * @param first Set to the beginning of the block
+     * @param last Set to the end of the block
+     * @return False if there are no more blocks
+     */
+    bool next( const char*& first, const char*& last)
+    {
+        if( m_isMapped)
+        {
+            if( m_isMappedFileRead) return false;
+            m_isMappedFileRead = true;
+            first = m_file.begin();
+            last = m_file.end();
+            return true;
+        }
+
+        pthread_mutex_lock( &m_mutex);
+        releaseCurrentBuffer();
+        pthread_cond_broadcast( &m_condition);
+        while( m_readyBlocks.empty() && !m_isProducerFinished) pthread_cond_wait( &m_condition, &m_mutex);
+        if( m_readyBlocks.empty())
+        {
+            bool hasFailed = m_hasFailed;
+            pthread_mutex_unlock( &m_mutex);
+            if( hasFailed)
+            {
+                throw std::ifstream::failure( "Exception decompressing file '" + m_filename + "'");
+            }
+            return false;
+        }
+        Block block = m_readyBlocks.front();
+        m_readyBlocks.pop_front();
+        pthread_mutex_unlock( &m_mutex);
+
+        m_currentBuffer = block.buffer;
+        first = &(*block.buffer)[0];
+        last = first + block.size;
+        return true;
+    }
+
+private:
+    struct Block
+    {
+        std::vector<char>* buffer;
+        size_t size;
+    };
+
+    static const unsigned int MAX_READY_BLOCKS = 2;
+
+    std::string m_filename;
+    size_t m_blockSize;
+    bool m_isCompressed;
+    bool m_isStream;
+    bool m_isMapped;
+
+    MappedFile m_file;
+    bool m_isMappedFileRead;
+
+    int m_fd;
+    StreamDecompressor m_decompressor;
+    bool m_hasThread;
+    pthread_t m_thread;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_condition;
+    bool m_stop;
+    bool m_isProducerFinished;
+    bool m_hasFailed;
+    std::deque<Block> m_readyBlocks;
+    std::vector< std::vector<char>* > m_freeBuffers;
+    std::vector<char>* m_currentBuffer;
+
+    TextBlockReader( const TextBlockReader&);
+    TextBlockReader& operator = ( const TextBlockReader&);
+
+    void releaseCurrentBuffer()
+    {
+        if( m_currentBuffer) m_freeBuffers.push_back( m_currentBuffer);
+        m_currentBuffer = 0;
+    }
+
+    /**
+     * @brief Decompresses the file into blocks, keeping at most MAX_READY_BLOCKS blocks ahead of the reader
+     */
+    static void* run( void* argument)
+    {
+        TextBlockReader* reader = static_cast<TextBlockReader*>( argument);
+        std::vector<char> carry;
+        bool isFinished = false;
+
+        while( !isFinished)
+        {
+            pthread_mutex_lock( &reader->m_mutex);
+            while( reader->m_readyBlocks.size() >= MAX_READY_BLOCKS && !reader->m_stop) pthread_cond_wait( &reader->m_condition, &reader->m_mutex);
+            if( reader->m_stop)
+            {
+                pthread_mutex_unlock( &reader->m_mutex);
+                break;
+            }
+            std::vector<char>* buffer;
+            if( reader->m_freeBuffers.empty())
+            {
+                buffer = new std::vector<char>();
+            }
+            else
+            {
+                buffer = reader->m_freeBuffers.back();
+                reader->m_freeBuffers.pop_back();
+            }
+            pthread_mutex_unlock( &reader->m_mutex);
+
+            // The incomplete line of the previous block starts this one
+            buffer->resize( std::max( reader->m_blockSize, 2 * carry.size()));
+            if( !carry.empty()) memcpy( &(*buffer)[0], &carry[0], carry.size());
+            size_t size = carry.size();
+            size_t blockSize = 0;
+            carry.clear();
+
+            while( true)
+            {
+                char* output = &(*buffer)[0] + size;
+                if( reader->m_isStream) size += reader->m_decompressor.readSome( output, buffer->size() - size);
+                else                    size += reader->m_decompressor.read( output, buffer->size() - size);
+                if( reader->m_decompressor.hasFailed() || reader->m_decompressor.isFinished())
+                {
+                    blockSize = size;
+                    isFinished = true;
+                    break;
+                }
+                const char* newline = static_cast<const char*>( memrchr( &(*buffer)[0], '\n', size));
+                if( newline)
+                {
+                    blockSize = newline + 1 - &(*buffer)[0];
+                    carry.assign( &(*buffer)[0] + blockSize, &(*buffer)[0] + size);
+                    break;
+                }
+                if( size == buffer->size()) buffer->resize( 2 * buffer->size());
+            }
+
+            pthread_mutex_lock( &reader->m_mutex);
+            if( reader->m_decompressor.hasFailed())
+            {
+                reader->m_hasFailed = true;
+                reader->m_freeBuffers.push_back( buffer);
+            }
+            else
+            {
+                Block block = { buffer, blockSize };
+                reader->m_readyBlocks.push_back( block);
+            }
+            pthread_cond_broadcast( &reader->m_condition);
+            pthread_mutex_unlock( &reader->m_mutex);
+        }
+
+        pthread_mutex_lock( &reader->m_mutex);
+        reader->m_isProducerFinished = true;
+        pthread_cond_broadcast( &reader->m_condition);
+        pthread_mutex_unlock( &reader->m_mutex);
+        return 0;
+    }
+};
+
+
+/**
+ * @brief A std::streambuf over the blocks of a TextBlockReader, for readers that parse with std::istream
+ */
+class TextBlockStreambuf : public std::streambuf
+{
+public:
+    TextBlockStreambuf( TextBlockReader& reader):m_reader(reader)
+    {
+    }
+
+protected:
+    int underflow()
+    {
+        const char* first;
+        const char* last;
+        do
+        {
+            if( !m_reader.next( first, last)) return EOF;
+        }
+        while( first == last);
+        setg( const_cast<char*>( first), const_cast<char*>( first), const_cast<char*>( last));
+        return (unsigned char)( *first);
+    }
+
+private:
+    TextBlockReader& m_reader;
+};
+
+#endif //TEXTBLOCKREADER_H
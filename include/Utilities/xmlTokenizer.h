@@ -0,0 +1,211 @@
+#ifndef XMLTOKENIZER_H
+#define XMLTOKENIZER_H
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <Utilities/textBlockReader.h>
+
+/**
+ * @brief An attribute of an XML tag. The name and the value point into the tokenizer's buffers
+ */
+struct XMLAttribute
+{
+    const char* name;
+    size_t nameLength;
+    const char* value;
+    size_t valueLength;
+
+    bool is( const char* attributeName) const
+    {
+        return strlen( attributeName) == nameLength && memcmp( name, attributeName, nameLength) == 0;
+    }
+
+    bool hasValue( const char* attributeValue) const
+    {
+        return strlen( attributeValue) == valueLength && memcmp( value, attributeValue, valueLength) == 0;
+    }
+
+    std::string getValue() const
+    {
+        return std::string( value, valueLength);
+    }
+};
+
+/**
+ * @brief An XML tag, valid until the next tag is read
+ */
+struct XMLTag
+{
+    const char* name;
+    size_t nameLength;
+    bool isClosing;
+    bool isSelfClosing;
+    std::vector<XMLAttribute> attributes;
+
+    bool is( const char* tagName) const
+    {
+        return strlen( tagName) == nameLength && memcmp( name, tagName, nameLength) == 0;
+    }
+
+    /**
+     * @brief Returns the attribute with a name, or 0 if there is none
+     */
+    const XMLAttribute* find( const char* attributeName) const
+    {
+        for( unsigned int i = 0; i < attributes.size(); ++i)
+        {
+            if( attributes[i].is( attributeName)) return &attributes[i];
+        }
+        return 0;
+    }
+};
+
+/**
+ * @brief A SAX style tokenizer of XML files
+ *
+ * The tags are read one by one from the blocks of a TextBlockReader, so memory does not depend on
+ * the size of the file. Text between tags, comments, processing instructions and declarations
+ * are skipped. Entities are not decoded.
+ *
+ * @author Panos Michail
+ *
+ */
+class XMLTokenizer
+{
+public:
+    XMLTokenizer( TextBlockReader& reader):m_reader(reader),m_p(0),m_end(0)
+    {
+    }
+
+    /**
+     * @brief Reads the next element tag
+     *
+     * @param tag Set to the tag
+     * @return False at the end of the file
+     */
+    bool next( XMLTag& tag)
+    {
+        while( true)
+        {
+            if( m_p == m_end)
+            {
+                if( !m_reader.next( m_p, m_end)) return false;
+                continue;
+            }
+
+            const char* first = static_cast<const char*>( memchr( m_p, '<', m_end - m_p));
+            if( !first)
+            {
+                m_p = m_end;
+                continue;
+            }
+
+            const char* last = findTagEnd( first, m_end);
+            if( last)
+            {
+                m_p = last + 1;
+                if( parse( first, last, tag)) return true;
+                continue;
+            }
+
+            // The tag continues in the next blocks
+            m_carry.assign( first, m_end);
+            while( !last)
+            {
+                size_t blockOffset = m_carry.size();
+                if( !m_reader.next( m_p, m_end)) return false;
+                m_carry.append( m_p, m_end);
+                last = findTagEnd( m_carry.data(), m_carry.data() + m_carry.size());
+                if( last) m_p += ( last + 1 - m_carry.data()) - blockOffset;
+            }
+            if( parse( m_carry.data(), last, tag)) return true;
+        }
+    }
+
+private:
+    TextBlockReader& m_reader;
+    const char* m_p;
+    const char* m_end;
+    std::string m_carry;
+
+    static bool isSpace( char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    /**
+     * @brief Returns the position of the '>' that ends the tag that starts at first, or 0 if it is not in the range
+     */
+    static const char* findTagEnd( const char* first, const char* end)
+    {
+        if( end - first >= 4 && memcmp( first, "<!--", 4) == 0)
+        {
+            for( const char* p = first + 4; p + 2 < end; ++p)
+            {
+                if( p[0] == '-' && p[1] == '-' && p[2] == '>') return p + 2;
+            }
+            return 0;
+        }
+
+        char quote = 0;
+        for( const char* p = first + 1; p != end; ++p)
+        {
+            if( quote)
+            {
+                if( *p == quote) quote = 0;
+            }
+            else if( *p == '"' || *p == '\'')
+            {
+                quote = *p;
+            }
+            else if( *p == '>')
+            {
+                return p;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Parses the tag in the range [first, last], where first is '<' and last is '>'
+     *
+     * @return False if the tag is not an element
+     */
+    static bool parse( const char* first, const char* last, XMLTag& tag)
+    {
+        const char* p = first + 1;
+        if( p == last || *p == '?' || *p == '!') return false;
+
+        tag.isClosing = ( *p == '/');
+        if( tag.isClosing) ++p;
+        tag.isSelfClosing = ( *(last - 1) == '/');
+        tag.name = p;
+        while( p != last && !isSpace(*p) && *p != '/') ++p;
+        tag.nameLength = p - tag.name;
+
+        tag.attributes.clear();
+        while( true)
+        {
+            while( p != last && ( isSpace(*p) || *p == '/')) ++p;
+            if( p == last) break;
+
+            XMLAttribute attribute;
+            attribute.name = p;
+            while( p != last && *p != '=' && !isSpace(*p)) ++p;
+            attribute.nameLength = p - attribute.name;
+            while( p != last && ( isSpace(*p) || *p == '=')) ++p;
+            if( p == last || ( *p != '"' && *p != '\'')) break;
+
+            char quote = *p++;
+            attribute.value = p;
+            while( p != last && *p != quote) ++p;
+            attribute.valueLength = p - attribute.value;
+            if( p != last) ++p;
+            tag.attributes.push_back( attribute);
+        }
+        return true;
+    }
+};
+
+#endif //XMLTOKENIZER_H